@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+# Starts a null RHI server and N headless bot clients on this machine over loopback, and waits for the server to
+# write its report to Saved/Profiling/Monaty.
+#
+# Usage: Scripts/RunLoadTest.sh <EditorBinary> [Bots=16] [Seconds=120] [Map=/Game/FirstPerson/Maps/FirstPersonMap]
+# Set BOT_PLACEABLE=/Game/Path/DT_Placeables.DT_Placeables:Row to have the bots build as well.
+# Set PLACEMENTS=N to fill the server with N placed structures for the whole run, see Monaty.Bench.Replication.
+# Set REPLICATION_GRAPH=0 to run the same load on the plain net driver, for comparing against the replication graph.
+set -euo pipefail
+
+EDITOR="${1:?Path to UnrealEditor binary}"
+BOTS="${2:-16}"
+SECONDS_TO_RUN="${3:-120}"
+MAP="${4:-/Game/FirstPerson/Maps/FirstPersonMap}"
+PORT="${PORT:-7777}"
+PROJECT="$(cd "$(dirname "$0")/.." && pwd)/Monaty.uproject"
+LOG_DIR="$(dirname "$PROJECT")/Saved/Logs/LoadTest"
+mkdir -p "$LOG_DIR"
+
+SERVER_CMDS="Monaty.LoadTest.Server bots=$BOTS seconds=$SECONDS_TO_RUN exit"
+if [[ -n "${PLACEMENTS:-}" ]]; then
+	# Enough frames to outlast the load test, which ends the server. The net stats would add their own cost.
+	SERVER_CMDS="monaty.Net.Stats 0, Monaty.Bench.Replication $PLACEMENTS frames=$((SECONDS_TO_RUN * 1000)), $SERVER_CMDS"
+fi
+SERVER_ARGS=()
+if [[ "${REPLICATION_GRAPH:-1}" == "0" ]]; then
+	SERVER_ARGS+=("-ini:Engine:[/Script/OnlineSubsystemUtils.IpNetDriver]:ReplicationDriverClassName="
+		"-ini:Engine:[/Script/Monaty.MonatyNetDriver]:ReplicationDriverClassName=")
+fi
+
+"$EDITOR" "$PROJECT" "$MAP?listen" -server -nullrhi -nosound -unattended -port="$PORT" \
+	-log="$LOG_DIR/Server.log" -ExecCmds="$SERVER_CMDS" ${SERVER_ARGS[@]+"${SERVER_ARGS[@]}"} &
+SERVER_PID=$!
+
+# Give the server time to open its port before the bots connect.
+sleep 15
+
+BOT_PIDS=()
+for ((INDEX = 0; INDEX < BOTS; INDEX++)); do
+	"$EDITOR" "$PROJECT" "127.0.0.1:$PORT" -game -nullrhi -nosound -unattended -MonatyBot="$INDEX" \
+		${BOT_PLACEABLE:+-BotPlaceable="$BOT_PLACEABLE"} -log="$LOG_DIR/Bot$INDEX.log" &
+	BOT_PIDS+=($!)
+done
+
+wait "$SERVER_PID" || true
+kill "${BOT_PIDS[@]}" 2>/dev/null || true
+wait 2>/dev/null || true
+echo "Report written to $(dirname "$PROJECT")/Saved/Profiling/Monaty"
@@ -2,16 +2,149 @@
 
 #include "Character/MonatyCharacter.h"
 
+#include "Character/MonatyMovementModelAsset.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/MonatyCharacterMovementComponent.h"
+#include "Debug/MonatyDebug.h"
+#include "DrawDebugHelpers.h"
+#include "Engine/ActorChannel.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Misc/App.h"
+#include "Net/DataBunch.h"
+#include "Net/MonatyLagCompensation.h"
+#include "Net/MonatyNetStats.h"
+#include "Net/UnrealNetwork.h"
+#include "Serialization/BitWriter.h"
+#include "Profiling/MonatyBenchmark.h"
+#include "Profiling/MonatyStats.h"
+#include "Profiling/MonatyTelemetry.h"
+
+static TAutoConsoleVariable<bool> CVarLightweightProxies(
+	TEXT("monaty.Proxy.Lightweight"),
+	false,
+	TEXT("Simulated proxies only interpolate replicated snapshots and face their replicated aim. Skips the movement ")
+	TEXT("component, network smoothing and the locomotion derivation."));
+
+static TAutoConsoleVariable<float> CVarProxyInterpolationDelay(
+	TEXT("monaty.Proxy.InterpolationDelay"),
+	0.1f,
+	TEXT("Seconds lightweight proxies are shown in the past, at least one net update interval."));
+
+void FReplicatedLocomotionState::Pack(const FRotator& Aim, float InputAmount, EPlayerGaitState Gait,
+                                      EPlayerStanceState Stance, EPlayerMovementState MovementState,
+                                      const FVector& Acceleration)
+{
+	AimYaw = FRotator::CompressAxisToShort(Aim.Yaw);
+	AimPitch = FRotator::CompressAxisToShort(Aim.Pitch);
+	MovementInputAmount = static_cast<uint8>(FMath::RoundToInt(FMath::Clamp(InputAmount, 0.0f, 1.0f) * 255.0f));
+	StateBits = (static_cast<uint8>(Gait) & 0x3) | ((static_cast<uint8>(Stance) & 0x1) << 2) |
+		((static_cast<uint8>(MovementState) & 0x3) << 3);
+
+	const float AccelerationMagnitude = Acceleration.Size();
+	AccelerationSize = static_cast<uint16>(FMath::Min(FMath::RoundToInt(AccelerationMagnitude), MAX_uint16));
+	if (AccelerationSize > 0)
+	{
+		const FRotator AccelerationRotation = Acceleration.ToOrientationRotator();
+		AccelerationYaw = FRotator::CompressAxisToByte(AccelerationRotation.Yaw);
+		AccelerationPitch = FRotator::CompressAxisToByte(AccelerationRotation.Pitch);
+	}
+	else
+	{
+		AccelerationYaw = 0;
+		AccelerationPitch = 0;
+	}
+}
+
+FRotator FReplicatedLocomotionState::GetAimRotation() const
+{
+	return {
+		FRotator::NormalizeAxis(FRotator::DecompressAxisFromShort(AimPitch)),
+		FRotator::NormalizeAxis(FRotator::DecompressAxisFromShort(AimYaw)),
+		0.0f
+	};
+}
+
+FVector FReplicatedLocomotionState::GetAcceleration() const
+{
+	if (AccelerationSize == 0)
+	{
+		return FVector::ZeroVector;
+	}
+	const FRotator Direction(FRotator::DecompressAxisFromByte(AccelerationPitch),
+	                         FRotator::DecompressAxisFromByte(AccelerationYaw), 0.0f);
+	return Direction.Vector() * AccelerationSize;
+}
+
+bool FReplicatedLocomotionState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << AimYaw;
+	Ar << AimPitch;
+	Ar << MovementInputAmount;
+	Ar.SerializeBits(&StateBits, StateBitCount);
+
+	// Skip the acceleration payload entirely while the character is not accelerating.
+	uint8 bHasAcceleration = AccelerationSize > 0;
+	Ar.SerializeBits(&bHasAcceleration, 1);
+	if (bHasAcceleration)
+	{
+		Ar << AccelerationYaw;
+		Ar << AccelerationPitch;
+		Ar << AccelerationSize;
+	}
+	else if (Ar.IsLoading())
+	{
+		AccelerationYaw = 0;
+		AccelerationPitch = 0;
+		AccelerationSize = 0;
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+void FMonatyProxySnapshots::Add(double Time, const FVector& Location, const FVector& Velocity)
+{
+	Snapshots[Head] = {Time, Location, Velocity};
+	Head = (Head + 1) % Capacity;
+	Num = FMath::Min(Num + 1, Capacity);
+}
+
+bool FMonatyProxySnapshots::Sample(double Time, FVector& OutLocation, FVector& OutVelocity) const
+{
+	if (Num == 0)
+	{
+		return false;
+	}
+	// First snapshot after the sample time.
+	int32 Next = 0;
+	while (Next < Num && GetOrdered(Next).Time <= Time)
+	{
+		Next++;
+	}
+	if (Next == 0 || Next == Num)
+	{
+		const FSnapshot& Held = GetOrdered(Next == 0 ? 0 : Num - 1);
+		OutLocation = Held.Location;
+		OutVelocity = Held.Velocity;
+		return true;
+	}
+	const FSnapshot& From = GetOrdered(Next - 1);
+	const FSnapshot& To = GetOrdered(Next);
+	const double Alpha = (Time - From.Time) / FMath::Max(To.Time - From.Time, UE_SMALL_NUMBER);
+	OutLocation = FMath::Lerp(From.Location, To.Location, Alpha);
+	OutVelocity = FMath::Lerp(From.Velocity, To.Velocity, Alpha);
+	return true;
+}
 
 // Sets default values
 AMonatyCharacter::AMonatyCharacter(const FObjectInitializer& ObjectInitializer) : Super(
 	ObjectInitializer.SetDefaultSubobjectClass<UMonatyCharacterMovementComponent>(
 		CharacterMovementComponentName))
 {
+	static_assert(STRUCT_OFFSET(AMonatyCharacter, Locomotion) % PLATFORM_CACHE_LINE_SIZE == 0,
+	              "The locomotion block must start on a cache line");
+
 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 	bUseControllerRotationYaw = 0;
@@ -42,15 +175,106 @@ void AMonatyCharacter::BeginPlay()
 
 		StanceTimeline.AddInterpFloat(StanceCurve, TimelineProgress);
 	}
+	// Server checks from clients are made against where this character was.
+	if (UMonatyLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UMonatyLagCompensationSubsystem>())
+	{
+		LagCompensation->RegisterCharacter(this);
+	}
+}
+
+void AMonatyCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UMonatyLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UMonatyLagCompensationSubsystem>())
+	{
+		LagCompensation->UnregisterCharacter(this);
+	}
+	// A replay that did not finish still has the engine on its time step.
+	if (InputRecorder)
+	{
+		InputRecorder->RestoreTimeStep();
+		InputRecorder.Reset();
+	}
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
 void AMonatyCharacter::Tick(float DeltaTime)
 {
+	MONATY_SCOPED_STAT(STAT_MonatyCharacterTick);
+	MONATY_BENCHMARK_SCOPE(CharacterTick);
+
+	UpdateLightweightProxy();
+	if (ProxySnapshots)
+	{
+		Super::Tick(DeltaTime);
+		TickLightweightProxy(DeltaTime);
+		return;
+	}
+
+	// Input handlers already ran for this frame, so record or feed the recorded one before using it.
+	if (InputRecorder && InputRecorder->Mode == EMonatyInputRecorderMode::Recording)
+	{
+		RecordInputFrame(DeltaTime);
+	}
+	else if (InputRecorder && InputRecorder->Mode == EMonatyInputRecorderMode::Replaying)
+	{
+		ReplayInputFrame();
+	}
+
 	Super::Tick(DeltaTime);
 
+	if (bUseFixedStepLocomotion)
+	{
+		AdvanceFixedStepLocomotion(DeltaTime, GatherLocomotionStepInput());
+	}
+	else
+	{
+		TickLocomotion(GatherLocomotionStepInput(), DeltaTime);
+	}
+
+	if (CurrentMovementState == EPlayerMovementState::InAir && ShouldPredictLanding())
+	{
+		UpdateLandingPrediction();
+	}
+
+	if (MONATY_DEBUG_ENABLED(Locomotion))
+	{
+		DrawDebugString(GetWorld(), FVector(0.0f, 0.0f, 100.0f),
+		                FString::Printf(TEXT("Gait %s Stance %s State %s Speed %.0f"),
+		                                *UEnum::GetValueAsString(CurrentGaitState),
+		                                *UEnum::GetValueAsString(CurrentStanceState),
+		                                *UEnum::GetValueAsString(CurrentMovementState), Locomotion.Speed), this, FColor::White,
+		                0.0f);
+	}
+
+	// Publish the locomotion state for simulated proxies.
+	if (HasAuthority())
+	{
+		UpdateReplicatedLocomotion();
+		// The server's own state: gait and stance arrive through Server_SetGait and Server_SetStance, the input amount
+		// from the acceleration of the client's moves.
+		if (FMonatyTelemetry::IsEnabled())
+		{
+			FMonatyTelemetryRecord Record;
+			Record.Frame = static_cast<uint32>(GFrameCounter);
+			Record.Source = GetUniqueID();
+			Record.Time = GetWorld()->GetTimeSeconds();
+			Record.Type = EMonatyTelemetryType::Locomotion;
+			Record.State[0] = static_cast<uint8>(CurrentGaitState);
+			Record.State[1] = static_cast<uint8>(CurrentStanceState);
+			Record.State[2] = static_cast<uint8>(CurrentMovementState);
+			Record.Values[0] = Locomotion.Speed;
+			Record.Values[1] = Locomotion.MovementInputAmount;
+			Record.Values[2] = GetActorRotation().Yaw;
+			FMonatyTelemetry::Push(Record);
+		}
+	}
+}
+
+void AMonatyCharacter::TickLocomotion(const FLocomotionStepInput& Input, float DeltaTime)
+{
 	// Set required values
-	SetEssentialValues(DeltaTime);
+	SetEssentialValuesFromInput(Input, DeltaTime);
 
 	if (CurrentMovementState == EPlayerMovementState::Grounded)
 	{
@@ -66,8 +290,100 @@ void AMonatyCharacter::Tick(float DeltaTime)
 	StanceTimeline.TickTimeline(DeltaTime);
 
 	// Cache values
-	PreviousVelocity = GetVelocity();
-	PreviousAimYaw = AimingRotation.Yaw;
+	Locomotion.PreviousVelocity = FVector3f(Input.Velocity);
+	Locomotion.PreviousAimYaw = Locomotion.AimingRotation.Yaw;
+}
+
+int32 AMonatyCharacter::AdvanceFixedStepLocomotion(float DeltaTime, const FLocomotionStepInput& FrameInput)
+{
+	if (!FixedStep)
+	{
+		ResetFixedStepLocomotion();
+	}
+	FMonatyFixedStepState& State = *FixedStep;
+
+	// Step the locomotion at a fixed rate. The movement component runs at the frame rate, so live steps hold its
+	// input for the whole frame. Queued step inputs replace it one by one.
+	const double StepTime = 1.0 / FixedStepRate;
+	State.Accumulator += DeltaTime;
+	int32 Steps = 0;
+	while (State.Accumulator >= StepTime && Steps < MaxFixedStepsPerFrame)
+	{
+		const bool bQueued = State.StepInputs.Num() > 0;
+		if (bQueued && !State.StepInputs.IsValidIndex(State.NextStepInput))
+		{
+			break;
+		}
+		Steps++;
+		State.PreviousRotation = State.CurrentRotation;
+		TickLocomotion(bQueued ? State.StepInputs[State.NextStepInput++] : FrameInput, StepTime);
+		State.Accumulator -= StepTime;
+	}
+	// Drop the time we could not catch up on after a hitch instead of spiralling.
+	if (Steps == MaxFixedStepsPerFrame)
+	{
+		State.Accumulator = FMath::Min(State.Accumulator, StepTime);
+	}
+
+	// Interpolate the visual rotation between the last two steps.
+	const float RenderAlpha = static_cast<float>(FMath::Min(State.Accumulator / StepTime, 1.0));
+	SetActorRotation(FQuat::Slerp(State.PreviousRotation, State.CurrentRotation, RenderAlpha));
+	return Steps;
+}
+
+void AMonatyCharacter::ResetFixedStepLocomotion()
+{
+	if (!FixedStep)
+	{
+		FixedStep = MakeUnique<FMonatyFixedStepState>();
+	}
+	FixedStep->Accumulator = 0.0;
+	FixedStep->PreviousRotation = GetActorQuat();
+	FixedStep->CurrentRotation = FixedStep->PreviousRotation;
+	FixedStep->StepInputs.Reset();
+	FixedStep->NextStepInput = 0;
+}
+
+void AMonatyCharacter::QueueFixedStepInputs(TConstArrayView<FLocomotionStepInput> Inputs)
+{
+	if (!FixedStep)
+	{
+		ResetFixedStepLocomotion();
+	}
+	FixedStep->StepInputs.RemoveAt(0, FixedStep->NextStepInput, false);
+	FixedStep->NextStepInput = 0;
+	FixedStep->StepInputs.Append(Inputs.GetData(), Inputs.Num());
+}
+
+int32 AMonatyCharacter::GetQueuedFixedStepInputCount() const
+{
+	return FixedStep ? FixedStep->StepInputs.Num() - FixedStep->NextStepInput : 0;
+}
+
+FLocomotionStepInput AMonatyCharacter::GatherLocomotionStepInput() const
+{
+	FLocomotionStepInput Input;
+	Input.Velocity = GetVelocity();
+	Input.CurrentAcceleration = GetCharacterMovement()->GetCurrentAcceleration();
+	Input.MaxAcceleration = GetCharacterMovement()->GetMaxAcceleration();
+	Input.ControlRotation = GetControlRotation();
+	return Input;
+}
+
+FRotator AMonatyCharacter::GetLocomotionRotation() const
+{
+	return bUseFixedStepLocomotion && FixedStep ? FixedStep->CurrentRotation.Rotator() : GetActorRotation();
+}
+
+void AMonatyCharacter::SetLocomotionRotation(const FRotator& NewRotation)
+{
+	if (bUseFixedStepLocomotion && FixedStep)
+	{
+		// The actor rotation is interpolated towards this after the step.
+		FixedStep->CurrentRotation = NewRotation.Quaternion();
+		return;
+	}
+	SetActorRotation(NewRotation);
 }
 
 // Called to bind functionality to input
@@ -102,15 +418,65 @@ void AMonatyCharacter::PostInitializeComponents()
 	MyCharacterMovementComponent = Cast<UMonatyCharacterMovementComponent>(Super::GetMovementComponent());
 }
 
+void AMonatyCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+	// Pooled and freshly spawned characters get their controller after BeginPlay.
+	PlaceablesComponent->InitPlaceablesComponents();
+}
+
+void AMonatyCharacter::OnRep_Controller()
+{
+	Super::OnRep_Controller();
+	PlaceablesComponent->InitPlaceablesComponents();
+}
+
+void AMonatyCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	// Only simulated proxies read the compact state, the owner and the server derive it themselves.
+	DOREPLIFETIME_CONDITION(AMonatyCharacter, ReplicatedLocomotion, COND_SimulatedOnly);
+}
+
+bool AMonatyCharacter::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
+{
+	// The bunch holds just the actor's own properties at this point, movement included.
+	if (FMonatyNetStats::IsEnabled() && Bunch->GetNumBits() > 0)
+	{
+		FMonatyNetStats::Get().Record(EMonatyNetStatKind::Actor, GetClass()->GetFName(), Channel->Connection,
+		                              Bunch->GetNumBits());
+		FMonatyNetStats::Get().RecordProperties(this, Channel, *RepFlags);
+	}
+	return Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
+}
+
 void AMonatyCharacter::SetMovementModel()
 {
-	const FString ContextString = GetFullName();
-	// The struct is not null, so we set it to the current player movement model.
-	if (const FPlayerMovementModel* OutRow =
-		MovementModel.DataTable->FindRow<FPlayerMovementModel>(MovementModel.RowName, ContextString))
+	const UGameInstance* GameInstance = GetGameInstance();
+	UMonatyMovementModelSubsystem* MovementModels = GameInstance
+		                                                ? GameInstance->GetSubsystem<UMonatyMovementModelSubsystem>()
+		                                                : nullptr;
+	if (!MovementModels)
 	{
-		PlayerMovementModel = *OutRow;
+		return;
 	}
+	// Models are loaded once and shared by every character using them.
+	if (!MovementModelAsset.IsNull())
+	{
+		MovementModels->RequestMovementModel(MovementModelAsset,
+		                                     UMonatyMovementModelSubsystem::FOnMovementModelLoaded::CreateWeakLambda(
+			                                     this, [this](UMonatyMovementModelAsset* ModelAsset)
+			                                     {
+				                                     LoadedMovementModel = ModelAsset;
+			                                     }));
+		return;
+	}
+	if (!MovementModel.DataTable)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("AMonatyCharacter::SetMovementModel | No movement model set!"));
+		return;
+	}
+	LoadedMovementModel = MovementModels->GetMovementModelFromDataTable(MovementModel);
 }
 
 void AMonatyCharacter::SetStance(EPlayerStanceState NewStance)
@@ -119,7 +485,14 @@ void AMonatyCharacter::SetStance(EPlayerStanceState NewStance)
 	{
 		PreviousStanceState = CurrentStanceState;
 		CurrentStanceState = NewStance;
+		MONATY_DEBUG_RECORD(Locomotion, StanceChanged, this, GetActorLocation(), FVector::ZeroVector,
+		                    static_cast<uint8>(PreviousStanceState), static_cast<uint8>(NewStance));
 		OnStanceChanged(PreviousStanceState);
+		// Only the owning client runs the input handlers.
+		if (IsLocallyControlled() && !HasAuthority())
+		{
+			Server_SetStance(NewStance);
+		}
 	}
 }
 
@@ -129,7 +502,29 @@ void AMonatyCharacter::SetGait(EPlayerGaitState NewGait)
 	{
 		PreviousGaitState = CurrentGaitState;
 		CurrentGaitState = NewGait;
+		MONATY_DEBUG_RECORD(Locomotion, GaitChanged, this, GetActorLocation(), FVector::ZeroVector,
+		                    static_cast<uint8>(PreviousGaitState), static_cast<uint8>(NewGait));
 		OnGaitChanged(PreviousGaitState);
+		if (IsLocallyControlled() && !HasAuthority())
+		{
+			Server_SetGait(NewGait);
+		}
+	}
+}
+
+void AMonatyCharacter::Server_SetGait_Implementation(EPlayerGaitState NewGait)
+{
+	if (NewGait <= EPlayerGaitState::Sprinting)
+	{
+		SetGait(NewGait);
+	}
+}
+
+void AMonatyCharacter::Server_SetStance_Implementation(EPlayerStanceState NewStance)
+{
+	if (NewStance <= EPlayerStanceState::Crouching)
+	{
+		SetStance(NewStance);
 	}
 }
 
@@ -139,6 +534,8 @@ void AMonatyCharacter::SetMovementState(EPlayerMovementState NewMovement)
 	{
 		PreviousMovementState = CurrentMovementState;
 		CurrentMovementState = NewMovement;
+		MONATY_DEBUG_RECORD(Locomotion, MovementStateChanged, this, GetActorLocation(), FVector::ZeroVector,
+		                    static_cast<uint8>(PreviousMovementState), static_cast<uint8>(NewMovement));
 		OnMovementStateChanged(PreviousMovementState);
 	}
 }
@@ -146,12 +543,18 @@ void AMonatyCharacter::SetMovementState(EPlayerMovementState NewMovement)
 void AMonatyCharacter::SetLocationAndTargetRotation(FVector NewLocation, FRotator NewRotator)
 {
 	SetActorLocationAndRotation(NewLocation, NewRotator);
-	TargetRotation = NewRotator;
+	Locomotion.TargetRotation = FRotator3f(NewRotator);
+	// Snap the fixed step rotation too, so it does not interpolate back.
+	if (FixedStep)
+	{
+		FixedStep->PreviousRotation = NewRotator.Quaternion();
+		FixedStep->CurrentRotation = FixedStep->PreviousRotation;
+	}
 }
 
 void AMonatyCharacter::SetHasMovementInput(bool bNewHasMovementInput)
 {
-	bHasMovementInput = bNewHasMovementInput;
+	Locomotion.bHasMovementInput = bNewHasMovementInput;
 }
 
 EPlayerGaitState AMonatyCharacter::GetAllowedGait() const
@@ -176,7 +579,7 @@ EPlayerGaitState AMonatyCharacter::GetActualGait() const
 	// the Actual gait will still be running untill the character decelerates to the walking speed.
 	//const float LocWalkSpeed = MyCharacterMovementComponent->CurrentMovementSettings.WalkSpeed;
 	const float LocRunSpeed = MyCharacterMovementComponent->CurrentMovementSettings.SprintSpeed;
-	if (Speed > LocRunSpeed + 10.0f)
+	if (Locomotion.Speed > LocRunSpeed + 10.0f)
 	{
 		return EPlayerGaitState::Sprinting;
 	}
@@ -188,13 +591,13 @@ bool AMonatyCharacter::CanSprint() const
 	// Determine if the character is currently able to sprint based on the Rotation mode and current acceleration
 	// (input) rotation. If the character is in the Looking Rotation mode, only allow sprinting if there is full
 	// movement input and it is faced forward relative to the camera + or - 50 degrees.
-	if (!bHasMovementInput)
+	if (!Locomotion.bHasMovementInput)
 	{
 		return false;
 	}
-	const bool bValidInputAmount = MovementInputAmount > 0.9f;
-	const FRotator AccRot = Acceleration.ToOrientationRotator();
-	FRotator Delta = AccRot - AimingRotation;
+	const bool bValidInputAmount = Locomotion.MovementInputAmount > 0.9f;
+	const FRotator3f AccRot = Locomotion.Acceleration.ToOrientationRotator();
+	FRotator3f Delta = AccRot - Locomotion.AimingRotation;
 	Delta.Normalize();
 	return bValidInputAmount && FMath::Abs(Delta.Yaw) < 50.0f;
 }
@@ -202,13 +605,13 @@ bool AMonatyCharacter::CanSprint() const
 void AMonatyCharacter::LimitRotation(float AimYawMin, float AimYawMax, float InterpSpeed, float DeltaTime)
 {
 	// Prevent the character from rotating past a certain angle.
-	FRotator Delta = AimingRotation - GetActorRotation();
+	FRotator Delta = FRotator(Locomotion.AimingRotation) - GetLocomotionRotation();
 	Delta.Normalize();
 	const float RangeVal = Delta.Yaw;
 
 	if (RangeVal < AimYawMin || RangeVal > AimYawMax)
 	{
-		const float ControlRotYaw = AimingRotation.Yaw;
+		const float ControlRotYaw = Locomotion.AimingRotation.Yaw;
 		const float TargetYaw = ControlRotYaw + (RangeVal > 0.0f ? AimYawMin : AimYawMax);
 		SmoothCharacterRotation({0.0f, TargetYaw, 0.0f}, 0.0f, InterpSpeed, DeltaTime);
 	}
@@ -218,10 +621,11 @@ void AMonatyCharacter::SmoothCharacterRotation(FRotator Target, float TargetInte
                                                float DeltaTime)
 {
 	// Interpolate the Target Rotation for extra smooth rotation behavior
-	TargetRotation =
-		FMath::RInterpConstantTo(TargetRotation, Target, DeltaTime, TargetInterpSpeed);
-	SetActorRotation(
-		FMath::RInterpTo(GetActorRotation(), TargetRotation, DeltaTime, ActorInterpSpeed));
+	const FRotator TargetRotation =
+		FMath::RInterpConstantTo(FRotator(Locomotion.TargetRotation), Target, DeltaTime, TargetInterpSpeed);
+	Locomotion.TargetRotation = FRotator3f(TargetRotation);
+	SetLocomotionRotation(
+		FMath::RInterpTo(GetLocomotionRotation(), TargetRotation, DeltaTime, ActorInterpSpeed));
 }
 
 float AMonatyCharacter::CalculateGroundedRotationRate() const
@@ -229,69 +633,76 @@ float AMonatyCharacter::CalculateGroundedRotationRate() const
 	// Calculate the rotation rate by using the current Rotation Rate Curve in the Movement Settings.
 	// Using the curve in conjunction with the mapped speed gives you a high level of control over the rotation
 	// rates for each speed. Increase the speed if the camera is rotating quickly for more responsive rotation.
-	const float MappedSpeedVal = GetMyMovementComponent()->GetMappedSpeed();
-	const float CurveVal =
-		MyCharacterMovementComponent->CurrentMovementSettings.RotationRateCurve->GetFloatValue(MappedSpeedVal);
+	const float MappedSpeedVal = GetMyMovementComponent()->GetMappedSpeed(Locomotion.Speed);
+	const UCurveFloat* RotationRateCurve = MyCharacterMovementComponent->CurrentMovementSettings.RotationRateCurve;
+	if (!RotationRateCurve)
+	{
+		return 0.0f;
+	}
+	MONATY_INC_COUNTER(STAT_MonatyCurveEvaluations, CurveEvaluations, 1);
+	const float CurveVal = RotationRateCurve->GetFloatValue(MappedSpeedVal);
 	const float ClampedAimYawRate = FMath::GetMappedRangeValueClamped(FVector2f{0.0f, 300.0f}, FVector2f{1.0f, 3.0f},
-	                                                                  AimYawRate);
+	                                                                  Locomotion.AimYawRate);
 	return CurveVal * ClampedAimYawRate;
 }
 
 void AMonatyCharacter::SetAcceleration(const FVector& NewAcceleration)
 {
-	Acceleration = (NewAcceleration != FVector::ZeroVector || IsLocallyControlled())
-		               ? NewAcceleration
-		               : Acceleration / 2;
+	Locomotion.Acceleration = (NewAcceleration != FVector::ZeroVector || IsLocallyControlled())
+		                          ? FVector3f(NewAcceleration)
+		                          : Locomotion.Acceleration / 2;
 }
 
 void AMonatyCharacter::SetIsMoving(bool bNewIsMoving)
 {
-	bIsMoving = bNewIsMoving;
+	Locomotion.bIsMoving = bNewIsMoving;
 }
 
 FVector AMonatyCharacter::GetMovementInput() const
 {
-	return Acceleration;
+	return FVector(Locomotion.Acceleration);
 }
 
 void AMonatyCharacter::SetMovementInputAmount(float NewMovementInputAmount)
 {
-	MovementInputAmount = NewMovementInputAmount;
+	Locomotion.MovementInputAmount = NewMovementInputAmount;
 }
 
 void AMonatyCharacter::SetSpeed(float NewSpeed)
 {
-	Speed = NewSpeed;
+	Locomotion.Speed = NewSpeed;
 }
 
 void AMonatyCharacter::SetAimYawRate(float NewAimYawRate)
 {
-	AimYawRate = NewAimYawRate;
+	Locomotion.AimYawRate = NewAimYawRate;
 }
 
 void AMonatyCharacter::GetControlForwardRightVector(FVector& Forward, FVector& Right) const
 {
-	const FRotator ControlRot(0.0f, AimingRotation.Yaw, 0.0f);
+	const FRotator ControlRot(0.0f, Locomotion.AimingRotation.Yaw, 0.0f);
 	Forward = GetInputAxisValue("MoveForward/Backwards") * UKismetMathLibrary::GetForwardVector(ControlRot);
 	Right = GetInputAxisValue("MoveRight/Left") * UKismetMathLibrary::GetRightVector(ControlRot);
 }
 
-FPlayerMovementSettings AMonatyCharacter::GetCurrentMovementSettings() const
+const FPlayerMovementSettings& AMonatyCharacter::GetCurrentMovementSettings() const
 {
-	if (CurrentStanceState == EPlayerStanceState::Standing)
-	{
-		return PlayerMovementModel.Standing;
-	}
-	if (CurrentStanceState == EPlayerStanceState::Crouching)
+	static const FPlayerMovementSettings DefaultSettings;
+	if (!LoadedMovementModel)
 	{
-		return PlayerMovementModel.Crouching;
+		return DefaultSettings;
 	}
-
-	return PlayerMovementModel.Standing;
+	return LoadedMovementModel->GetSettingsForStance(CurrentStanceState);
 }
 
 void AMonatyCharacter::UpdateCharacterMovement()
 {
+	// Keep the movement component defaults until the movement model has loaded.
+	if (!LoadedMovementModel)
+	{
+		return;
+	}
+
 	// Set the Allowed Gait
 	const EPlayerGaitState AllowedGait = GetAllowedGait();
 
@@ -305,57 +716,167 @@ void AMonatyCharacter::UpdateCharacterMovement()
 
 void AMonatyCharacter::SetEssentialValues(float DeltaTime)
 {
-	CurrentAcceleration = GetCharacterMovement()->GetCurrentAcceleration();
-	ControlRotation = GetControlRotation();
-	EasedMaxAcceleration = GetCharacterMovement()->GetMaxAcceleration();
+	SetEssentialValuesFromInput(GatherLocomotionStepInput(), DeltaTime);
+}
+
+void AMonatyCharacter::SetEssentialValuesFromInput(const FLocomotionStepInput& Input, float DeltaTime)
+{
+	MONATY_SCOPED_STAT(STAT_MonatySetEssentialValues);
+
+	// Simulated proxies read the replicated locomotion state instead of deriving it.
+	if (GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		SetProxyEssentialValues(DeltaTime);
+		return;
+	}
+
+	Locomotion.CurrentAcceleration = FVector3f(Input.CurrentAcceleration);
+	Locomotion.ControlRotation = FRotator3f(Input.ControlRotation);
+	Locomotion.EasedMaxAcceleration = Input.MaxAcceleration;
 
 	// Interp AimingRotation to current control rotation for smooth character rotation movement. Decrease InterpSpeed
 	// for slower but smoother movement.
-	AimingRotation = FMath::RInterpTo(AimingRotation, ControlRotation, DeltaTime, 30);
+	Locomotion.AimingRotation = FRotator3f(
+		FMath::RInterpTo(FRotator(Locomotion.AimingRotation), Input.ControlRotation, DeltaTime, 30));
 
 	// These values represent how the capsule is moving as well as how it wants to move, and therefore are essential
 	// for any data driven animation system. They are also used throughout the system for various functions,
 	// so I found it is easiest to manage them all in one place.
 
-	const FVector CurrentVel = GetVelocity();
+	const FVector CurrentVel = Input.Velocity;
 
 	// Set the amount of Acceleration.
-	SetAcceleration((CurrentVel - PreviousVelocity) / DeltaTime);
+	SetAcceleration((CurrentVel - FVector(Locomotion.PreviousVelocity)) / DeltaTime);
 
 	// Determine if the character is moving by getting it's speed. The Speed equals the length of the horizontal (x y)
 	// velocity, so it does not take vertical movement into account. If the character is moving, update the last
 	// velocity rotation. This value is saved because it might be useful to know the last orientation of movement
 	// even after the character has stopped.
 	SetSpeed(CurrentVel.Size2D());
-	SetIsMoving(Speed > 1.0f);
+	SetIsMoving(Locomotion.Speed > 1.0f);
 
-	if (bIsMoving)
+	if (Locomotion.bIsMoving)
 	{
-		LastVelocityRotation = CurrentVel.ToOrientationRotator();
+		Locomotion.LastVelocityRotation = FRotator3f(CurrentVel.ToOrientationRotator());
 	}
 
 	// Determine if the character has movement input by getting its movement input amount.
 	// The Movement Input Amount is equal to the current acceleration divided by the max acceleration so that
 	// it has a range of 0-1, 1 being the maximum possible amount of input, and 0 being none.
 	// If the character has movement input, update the Last Movement Input Rotation.
-	SetMovementInputAmount(CurrentAcceleration.Size() / EasedMaxAcceleration);
-	SetHasMovementInput(MovementInputAmount > 0.0f);
-	if (bHasMovementInput)
+	SetMovementInputAmount(Locomotion.CurrentAcceleration.Size() / Locomotion.EasedMaxAcceleration);
+	SetHasMovementInput(Locomotion.MovementInputAmount > 0.0f);
+	if (Locomotion.bHasMovementInput)
 	{
-		LastMovementInputRotation = CurrentAcceleration.ToOrientationRotator();
+		Locomotion.LastMovementInputRotation = Locomotion.CurrentAcceleration.ToOrientationRotator();
 	}
 	// Set the Aim Yaw rate by comparing the current and previous Aim Yaw value, divided by Delta Seconds.
 	// This represents the speed the camera is rotating left to right.
-	SetAimYawRate(FMath::Abs((AimingRotation.Yaw - PreviousAimYaw) / DeltaTime));
+	SetAimYawRate(FMath::Abs((Locomotion.AimingRotation.Yaw - Locomotion.PreviousAimYaw) / DeltaTime));
+}
+
+void AMonatyCharacter::SetProxyEssentialValues(float DeltaTime)
+{
+	// Interp towards the replicated aim, it only changes at the net update rate.
+	Locomotion.AimingRotation = FRotator3f(
+		FMath::RInterpTo(FRotator(Locomotion.AimingRotation), ReplicatedLocomotion.GetAimRotation(), DeltaTime, 30));
+
+	// Velocity is already replicated by the movement component, so speed stays local.
+	const FVector CurrentVel = GetVelocity();
+	SetSpeed(CurrentVel.Size2D());
+	SetIsMoving(Locomotion.Speed > 1.0f);
+	if (Locomotion.bIsMoving)
+	{
+		Locomotion.LastVelocityRotation = FRotator3f(CurrentVel.ToOrientationRotator());
+	}
+
+	Locomotion.Acceleration = FVector3f(ReplicatedLocomotion.GetAcceleration());
+	SetMovementInputAmount(ReplicatedLocomotion.GetMovementInputAmount());
+	SetHasMovementInput(Locomotion.MovementInputAmount > 0.0f);
+	if (Locomotion.bHasMovementInput && !Locomotion.Acceleration.IsNearlyZero())
+	{
+		Locomotion.LastMovementInputRotation = Locomotion.Acceleration.ToOrientationRotator();
+	}
+	SetAimYawRate(FMath::Abs((Locomotion.AimingRotation.Yaw - Locomotion.PreviousAimYaw) / DeltaTime));
+
+	SetGait(ReplicatedLocomotion.GetGait());
+	SetStance(ReplicatedLocomotion.GetStance());
+}
+
+void AMonatyCharacter::UpdateReplicatedLocomotion()
+{
+	ReplicatedLocomotion.Pack(FRotator(Locomotion.AimingRotation), Locomotion.MovementInputAmount, CurrentGaitState,
+	                          CurrentStanceState, CurrentMovementState, FVector(Locomotion.Acceleration));
+}
+
+void AMonatyCharacter::UpdateLightweightProxy()
+{
+	const bool bShouldBeLightweight = GetLocalRole() == ROLE_SimulatedProxy && CVarLightweightProxies.GetValueOnGameThread();
+	if (bShouldBeLightweight == ProxySnapshots.IsValid())
+	{
+		return;
+	}
+
+	// The movement component only simulates and smooths proxies, neither is needed while interpolating snapshots.
+	MyCharacterMovementComponent->SetComponentTickEnabled(!bShouldBeLightweight);
+	ProxySnapshots.Reset();
+	if (bShouldBeLightweight)
+	{
+		// Drop any smoothing offset left on the mesh.
+		GetMesh()->SetRelativeLocationAndRotation(GetBaseTranslationOffset(), GetBaseRotationOffset());
+		ProxySnapshots = MakeUnique<FMonatyProxySnapshots>();
+		ProxySnapshots->Add(GetWorld()->GetTimeSeconds(), GetActorLocation(), GetVelocity());
+	}
+}
+
+void AMonatyCharacter::PostNetReceiveLocationAndRotation()
+{
+	if (!ProxySnapshots)
+	{
+		Super::PostNetReceiveLocationAndRotation();
+		return;
+	}
+	// Buffer the update, the tick moves the actor. Rotation is driven by the replicated aim instead.
+	const FRepMovement& Movement = GetReplicatedMovement();
+	ProxySnapshots->Add(GetWorld()->GetTimeSeconds(), FRepMovement::RebaseOntoLocalOrigin(Movement.Location, this),
+	                   Movement.LinearVelocity);
+}
+
+void AMonatyCharacter::TickLightweightProxy(float DeltaTime)
+{
+	MONATY_SCOPED_STAT(STAT_MonatyLightweightProxyTick);
+
+	FVector Location, Velocity = GetVelocity();
+	if (ProxySnapshots->Sample(GetWorld()->GetTimeSeconds() - CVarProxyInterpolationDelay.GetValueOnGameThread(),
+	                           Location, Velocity))
+	{
+		SetActorLocation(Location);
+		// The anim instance reads the velocity off the movement component.
+		MyCharacterMovementComponent->Velocity = Velocity;
+	}
+
+	// Face the replicated aim, no curves or essential values.
+	const FRotator Aim = ReplicatedLocomotion.GetAimRotation();
+	Locomotion.AimingRotation = FRotator3f(FMath::RInterpTo(FRotator(Locomotion.AimingRotation), Aim, DeltaTime, 30));
+	SetActorRotation(FMath::RInterpTo(GetActorRotation(), FRotator(0.0f, Aim.Yaw, 0.0f), DeltaTime, 10));
+
+	SetSpeed(Velocity.Size2D());
+	SetIsMoving(Locomotion.Speed > 1.0f);
+	SetMovementInputAmount(ReplicatedLocomotion.GetMovementInputAmount());
+	SetHasMovementInput(Locomotion.MovementInputAmount > 0.0f);
+	SetGait(ReplicatedLocomotion.GetGait());
+	SetStance(ReplicatedLocomotion.GetStance());
 }
 
 void AMonatyCharacter::UpdateGroundedRotation(float DeltaTime)
 {
-	const bool bCanUpdateMovingRot = (bIsMoving && bHasMovementInput || Speed > 150.0f);
+	MONATY_SCOPED_STAT(STAT_MonatyUpdateGroundedRotation);
+
+	const bool bCanUpdateMovingRot = (Locomotion.bIsMoving && Locomotion.bHasMovementInput || Locomotion.Speed > 150.0f);
 	if (bCanUpdateMovingRot)
 	{
 		const float GroundedRotationRate = CalculateGroundedRotationRate();
-		const float YawValue = AimingRotation.Yaw;
+		const float YawValue = Locomotion.AimingRotation.Yaw;
 		SmoothCharacterRotation({0.0f, YawValue, 0.0f}, 500.0f, GroundedRotationRate, DeltaTime);
 	}
 	else
@@ -368,52 +889,80 @@ void AMonatyCharacter::UpdateGroundedRotation(float DeltaTime)
 void AMonatyCharacter::UpdateInAirRotation(float DeltaTime)
 {
 	// Velocity / Looking Direction Rotation
-	SmoothCharacterRotation({0.0f, InAirRotation.Yaw, 0.0f}, 0.0f, 5.0f, DeltaTime);
+	SmoothCharacterRotation({0.0f, Locomotion.InAirRotation.Yaw, 0.0f}, 0.0f, 5.0f, DeltaTime);
 }
 
 void AMonatyCharacter::ForwardBackwardInput(float Value)
 {
+	if (FMonatyInputFrame* Pending = GetPendingInputFrame())
+	{
+		Pending->ForwardBackward = Value;
+	}
 	if (CurrentMovementState == EPlayerMovementState::Grounded || CurrentMovementState ==
 		EPlayerMovementState::InAir)
 	{
-		const FRotator DirRotator(0.0f, AimingRotation.Yaw, 0.0f);
+		const FRotator DirRotator(0.0f, Locomotion.AimingRotation.Yaw, 0.0f);
 		AddMovementInput(UKismetMathLibrary::GetForwardVector(DirRotator), Value);
 	}
 }
 
 void AMonatyCharacter::LeftRightInput(float Value)
 {
+	if (FMonatyInputFrame* Pending = GetPendingInputFrame())
+	{
+		Pending->LeftRight = Value;
+	}
 	if (CurrentMovementState == EPlayerMovementState::Grounded || CurrentMovementState ==
 		EPlayerMovementState::InAir)
 	{
 		// Default camera relative movement behavior
-		const FRotator DirRotator(0.0f, AimingRotation.Yaw, 0.0f);
+		const FRotator DirRotator(0.0f, Locomotion.AimingRotation.Yaw, 0.0f);
 		AddMovementInput(UKismetMathLibrary::GetRightVector(DirRotator), Value);
 	}
 }
 
 void AMonatyCharacter::LookUpDownInput(float Value)
 {
+	if (FMonatyInputFrame* Pending = GetPendingInputFrame())
+	{
+		Pending->LookUpDown = Value;
+	}
 	AddControllerPitchInput(LookUpDownRate * Value);
 }
 
 void AMonatyCharacter::LookLeftRightInput(float Value)
 {
+	if (FMonatyInputFrame* Pending = GetPendingInputFrame())
+	{
+		Pending->LookLeftRight = Value;
+	}
 	AddControllerYawInput(LookLeftRightRate * Value);
 }
 
 void AMonatyCharacter::SprintPressedAction()
 {
+	if (FMonatyInputFrame* Pending = GetPendingInputFrame())
+	{
+		Pending->Actions |= EMonatyInputActions::SprintPressed;
+	}
 	SetGait(EPlayerGaitState::Sprinting);
 }
 
 void AMonatyCharacter::SprintReleasedAction()
 {
+	if (FMonatyInputFrame* Pending = GetPendingInputFrame())
+	{
+		Pending->Actions |= EMonatyInputActions::SprintReleased;
+	}
 	SetGait(EPlayerGaitState::Walking);
 }
 
 void AMonatyCharacter::JumpPressedAction()
 {
+	if (FMonatyInputFrame* Pending = GetPendingInputFrame())
+	{
+		Pending->Actions |= EMonatyInputActions::JumpPressed;
+	}
 	if (CurrentMovementState == EPlayerMovementState::Grounded)
 	{
 		if (CurrentStanceState == EPlayerStanceState::Standing)
@@ -429,11 +978,19 @@ void AMonatyCharacter::JumpPressedAction()
 
 void AMonatyCharacter::JumpReleasedAction()
 {
+	if (FMonatyInputFrame* Pending = GetPendingInputFrame())
+	{
+		Pending->Actions |= EMonatyInputActions::JumpReleased;
+	}
 	StopJumping();
 }
 
 void AMonatyCharacter::StancePressedAction()
 {
+	if (FMonatyInputFrame* Pending = GetPendingInputFrame())
+	{
+		Pending->Actions |= EMonatyInputActions::StancePressed;
+	}
 	if (GetCharacterMovement()->IsMovingOnGround() && !(CurrentGaitState == EPlayerGaitState::Sprinting))
 	{
 		SetStance(EPlayerStanceState::Crouching);
@@ -443,6 +1000,10 @@ void AMonatyCharacter::StancePressedAction()
 
 void AMonatyCharacter::StanceReleasedAction()
 {
+	if (FMonatyInputFrame* Pending = GetPendingInputFrame())
+	{
+		Pending->Actions |= EMonatyInputActions::StanceReleased;
+	}
 	if (GetCharacterMovement()->IsMovingOnGround() && !(CurrentGaitState == EPlayerGaitState::Sprinting))
 	{
 		SetStance(EPlayerStanceState::Standing);
@@ -452,6 +1013,10 @@ void AMonatyCharacter::StanceReleasedAction()
 
 void AMonatyCharacter::PlaceModeAction()
 {
+	if (FMonatyInputFrame* Pending = GetPendingInputFrame())
+	{
+		Pending->Actions |= EMonatyInputActions::PlaceMode;
+	}
 	if (PlaceablesComponent)
 	{
 		// We toggle the place mode.
@@ -459,6 +1024,290 @@ void AMonatyCharacter::PlaceModeAction()
 	}
 }
 
+void AMonatyCharacter::ParkInPool()
+{
+	if (InputRecorder)
+	{
+		InputRecorder->RestoreTimeStep();
+		InputRecorder.Reset();
+	}
+	PlaceablesComponent->ResetForPool();
+
+	// State enums as constructed.
+	const AMonatyCharacter* Defaults = GetDefault<AMonatyCharacter>(GetClass());
+	CurrentMovementState = PreviousMovementState = Defaults->CurrentMovementState;
+	CurrentGaitState = PreviousGaitState = Defaults->CurrentGaitState;
+	CurrentStanceState = PreviousStanceState = Defaults->CurrentStanceState;
+	StanceTimeline.Stop();
+	StanceTimeline.SetPlaybackPosition(0.0f, false);
+
+	// Essential values.
+	Locomotion = {};
+	ReplicatedLocomotion = {};
+	if (ProxySnapshots)
+	{
+		ProxySnapshots->Reset();
+	}
+	if (LandingPrediction)
+	{
+		LandingPrediction->Reset();
+	}
+	FixedStep.Reset();
+
+	// Movement settings for the reset stance, and the walk speed the component starts with.
+	const UMonatyCharacterMovementComponent* DefaultMovement = Cast<UMonatyCharacterMovementComponent>(
+		Defaults->GetCharacterMovement());
+	MyCharacterMovementComponent->StopMovementImmediately();
+	MyCharacterMovementComponent->DisableMovement();
+	MyCharacterMovementComponent->SetMovementSettings(GetCurrentMovementSettings());
+	MyCharacterMovementComponent->bRequestMovementSettingsChange = DefaultMovement->bRequestMovementSettingsChange;
+	MyCharacterMovementComponent->NewMaxWalkSpeed = DefaultMovement->NewMaxWalkSpeed;
+	MyCharacterMovementComponent->MaxWalkSpeed = DefaultMovement->MaxWalkSpeed;
+	MyCharacterMovementComponent->MaxWalkSpeedCrouched = DefaultMovement->MaxWalkSpeedCrouched;
+
+	// Parked characters cost nothing until they are taken again.
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+	GetMesh()->SetComponentTickEnabled(false);
+	SetNetDormancy(DORM_DormantAll);
+	bIsParkedInPool = true;
+}
+
+void AMonatyCharacter::TakeFromPool(const FTransform& SpawnTransform)
+{
+	SetActorLocationAndRotation(SpawnTransform.GetLocation(), SpawnTransform.Rotator(), false, nullptr,
+	                            ETeleportType::ResetPhysics);
+	const FRotator3f SpawnRotation(SpawnTransform.Rotator());
+	Locomotion.TargetRotation = Locomotion.InAirRotation = SpawnRotation;
+	Locomotion.LastVelocityRotation = Locomotion.LastMovementInputRotation = SpawnRotation;
+	Locomotion.AimingRotation = Locomotion.ControlRotation = SpawnRotation;
+	Locomotion.PreviousAimYaw = SpawnRotation.Yaw;
+
+	MyCharacterMovementComponent->SetDefaultMovementMode();
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+	GetMesh()->SetComponentTickEnabled(true);
+	SetNetDormancy(DORM_Awake);
+	ForceNetUpdate();
+	bIsParkedInPool = false;
+}
+
+FMonatyInputFrame* AMonatyCharacter::GetPendingInputFrame()
+{
+	return InputRecorder && InputRecorder->Mode == EMonatyInputRecorderMode::Recording
+		       ? &InputRecorder->PendingFrame
+		       : nullptr;
+}
+
+void AMonatyCharacter::StartInputRecording()
+{
+	InputRecorder = MakeUnique<FMonatyInputRecorderState>();
+	InputRecorder->Mode = EMonatyInputRecorderMode::Recording;
+}
+
+bool AMonatyCharacter::StopInputRecording(const FString& FilePath)
+{
+	if (!InputRecorder || InputRecorder->Mode != EMonatyInputRecorderMode::Recording)
+	{
+		return false;
+	}
+	TArray<FMonatyInputFrame>& Frames = InputRecorder->Recording.Frames;
+	// The last frame result is only known now.
+	if (Frames.Num() > 0)
+	{
+		CaptureFrameResult(Frames.Last());
+	}
+	const bool bSaved = InputRecorder->Recording.SaveToFile(FilePath);
+	UE_LOG(LogTemp, Display, TEXT("AMonatyCharacter::StopInputRecording | Saved %d frames to %s: %s"),
+	       Frames.Num(), *FilePath, bSaved ? TEXT("Success") : TEXT("Failed"));
+	InputRecorder.Reset();
+	return bSaved;
+}
+
+bool AMonatyCharacter::StartInputReplay(const FString& FilePath, bool bExitWhenDone)
+{
+	TUniquePtr<FMonatyInputRecorderState> Replay = MakeUnique<FMonatyInputRecorderState>();
+	if (!Replay->Recording.LoadFromFile(FilePath) || Replay->Recording.Frames.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("AMonatyCharacter::StartInputReplay | Could not load recording %s!"), *FilePath);
+		return false;
+	}
+	// Restarting a replay keeps the time step from before the first one.
+	if (InputRecorder && InputRecorder->Mode == EMonatyInputRecorderMode::Replaying)
+	{
+		Replay->bPreviousUseFixedTimeStep = InputRecorder->bPreviousUseFixedTimeStep;
+		Replay->PreviousFixedDeltaTime = InputRecorder->PreviousFixedDeltaTime;
+	}
+	else
+	{
+		Replay->bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+		Replay->PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	}
+	InputRecorder = MoveTemp(Replay);
+	// Ignore live input while replaying.
+	if (APlayerController* PlayerController = Cast<APlayerController>(GetController()))
+	{
+		DisableInput(PlayerController);
+	}
+	// Headless replays have no controller, so the movement component must still simulate.
+	GetCharacterMovement()->bRunPhysicsWithNoController = true;
+
+	InputRecorder->Mode = EMonatyInputRecorderMode::Replaying;
+	InputRecorder->ReplayStartTime = FPlatformTime::Seconds();
+	InputRecorder->bExitWhenReplayDone = bExitWhenDone;
+
+	// Step the engine with the recorded delta times. With -benchmark the engine no longer waits for real time.
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(InputRecorder->Recording.Frames[0].DeltaTime);
+	return true;
+}
+
+FRotator AMonatyCharacter::GetControlRotation() const
+{
+	// Without a controller, replays and scripted input supply the control rotation.
+	if (InputRecorder && InputRecorder->bHasScriptedControlRotation && !Controller)
+	{
+		return InputRecorder->ScriptedControlRotation;
+	}
+	return Super::GetControlRotation();
+}
+
+void AMonatyCharacter::RecordInputFrame(float DeltaTime)
+{
+	// The previous frame has been fully simulated by now, store where it ended up.
+	TArray<FMonatyInputFrame>& Frames = InputRecorder->Recording.Frames;
+	if (Frames.Num() > 0)
+	{
+		CaptureFrameResult(Frames.Last());
+	}
+	FMonatyInputFrame& Pending = InputRecorder->PendingFrame;
+	Pending.DeltaTime = DeltaTime;
+	Pending.ControlRotation = FRotator3f(GetControlRotation());
+	Frames.Add(Pending);
+	Pending = {};
+}
+
+void AMonatyCharacter::ReplayInputFrame()
+{
+	FMonatyInputRecorderState& Replay = *InputRecorder;
+	const TArray<FMonatyInputFrame>& Frames = Replay.Recording.Frames;
+	if (Replay.ReplayFrameIndex > 0 && !CompareFrameResult(Frames[Replay.ReplayFrameIndex - 1]))
+	{
+		Replay.ReplayMismatchCount++;
+	}
+	if (!Frames.IsValidIndex(Replay.ReplayFrameIndex))
+	{
+		FinishInputReplay();
+		return;
+	}
+
+	ApplyInputFrame(Frames[Replay.ReplayFrameIndex++]);
+
+	// Queue the delta time of the next frame.
+	if (Frames.IsValidIndex(Replay.ReplayFrameIndex))
+	{
+		FApp::SetFixedDeltaTime(Frames[Replay.ReplayFrameIndex].DeltaTime);
+	}
+}
+
+void AMonatyCharacter::ApplyInputFrame(const FMonatyInputFrame& Frame)
+{
+	// Without a controller the frame supplies the control rotation.
+	if (Controller)
+	{
+		Controller->SetControlRotation(FRotator(Frame.ControlRotation));
+	}
+	else
+	{
+		if (!InputRecorder)
+		{
+			InputRecorder = MakeUnique<FMonatyInputRecorderState>();
+		}
+		InputRecorder->ScriptedControlRotation = FRotator(Frame.ControlRotation);
+		InputRecorder->bHasScriptedControlRotation = true;
+	}
+
+	// Feed the frame through the same handlers the input component uses.
+	ForwardBackwardInput(Frame.ForwardBackward);
+	LeftRightInput(Frame.LeftRight);
+	LookUpDownInput(Frame.LookUpDown);
+	LookLeftRightInput(Frame.LookLeftRight);
+	if (EnumHasAnyFlags(Frame.Actions, EMonatyInputActions::SprintPressed)) SprintPressedAction();
+	if (EnumHasAnyFlags(Frame.Actions, EMonatyInputActions::SprintReleased)) SprintReleasedAction();
+	if (EnumHasAnyFlags(Frame.Actions, EMonatyInputActions::JumpPressed)) JumpPressedAction();
+	if (EnumHasAnyFlags(Frame.Actions, EMonatyInputActions::JumpReleased)) JumpReleasedAction();
+	if (EnumHasAnyFlags(Frame.Actions, EMonatyInputActions::StancePressed)) StancePressedAction();
+	if (EnumHasAnyFlags(Frame.Actions, EMonatyInputActions::StanceReleased)) StanceReleasedAction();
+	if (EnumHasAnyFlags(Frame.Actions, EMonatyInputActions::PlaceMode)) PlaceModeAction();
+}
+
+void AMonatyCharacter::CaptureFrameResult(FMonatyInputFrame& Frame) const
+{
+	Frame.Location = FVector3f(GetActorLocation());
+	Frame.Rotation = FRotator3f(GetActorRotation());
+	Frame.MovementState = static_cast<uint8>(CurrentMovementState);
+	Frame.GaitState = static_cast<uint8>(CurrentGaitState);
+	Frame.StanceState = static_cast<uint8>(CurrentStanceState);
+}
+
+bool AMonatyCharacter::CompareFrameResult(const FMonatyInputFrame& Frame) const
+{
+	FMonatyInputFrame Actual;
+	CaptureFrameResult(Actual);
+	const bool bLocationMatches = Actual.Location.Equals(Frame.Location, ReplayLocationTolerance);
+	const bool bRotationMatches = Actual.Rotation.Equals(Frame.Rotation, ReplayRotationTolerance);
+	const bool bStatesMatch = Actual.MovementState == Frame.MovementState && Actual.GaitState == Frame.GaitState &&
+		Actual.StanceState == Frame.StanceState;
+	if (!(bLocationMatches && bRotationMatches && bStatesMatch))
+	{
+		UE_LOG(LogTemp, Warning,
+		       TEXT("AMonatyCharacter::CompareFrameResult | Frame %d diverged: location %s (expected %s), rotation %s (expected %s)"),
+		       InputRecorder ? InputRecorder->ReplayFrameIndex - 1 : INDEX_NONE, *Actual.Location.ToString(),
+		       *Frame.Location.ToString(),
+		       *Actual.Rotation.ToString(), *Frame.Rotation.ToString());
+		return false;
+	}
+	return true;
+}
+
+void FMonatyInputRecorderState::RestoreTimeStep() const
+{
+	if (Mode == EMonatyInputRecorderMode::Replaying)
+	{
+		FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+	}
+}
+
+void AMonatyCharacter::FinishInputReplay()
+{
+	// Done with the recording, the state goes with it.
+	const TUniquePtr<FMonatyInputRecorderState> Replay = MoveTemp(InputRecorder);
+	Replay->RestoreTimeStep();
+	if (APlayerController* PlayerController = Cast<APlayerController>(GetController()))
+	{
+		EnableInput(PlayerController);
+	}
+
+	double RecordedTime = 0.0;
+	for (const FMonatyInputFrame& Frame : Replay->Recording.Frames)
+	{
+		RecordedTime += Frame.DeltaTime;
+	}
+	const double ReplayTime = FPlatformTime::Seconds() - Replay->ReplayStartTime;
+	UE_LOG(LogTemp, Display,
+	       TEXT("AMonatyCharacter::FinishInputReplay | %d frames, %d mismatches, %.2fs recorded in %.2fs (%.1fx)"),
+	       Replay->Recording.Frames.Num(), Replay->ReplayMismatchCount, RecordedTime, ReplayTime,
+	       ReplayTime > 0.0 ? RecordedTime / ReplayTime : 0.0);
+
+	if (Replay->bExitWhenReplayDone)
+	{
+		FPlatformMisc::RequestExitWithStatus(false, Replay->ReplayMismatchCount > 0 ? 1 : 0);
+	}
+}
+
 void AMonatyCharacter::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode)
 {
 	Super::OnMovementModeChanged(PrevMovementMode, PreviousCustomMode);
@@ -480,11 +1329,23 @@ void AMonatyCharacter::OnMovementStateChanged(EPlayerMovementState PreviousState
 	if (CurrentMovementState == EPlayerMovementState::InAir)
 	{
 		// If the character enters the air, set the In Air Rotation and uncrouch if crouched.
-		InAirRotation = GetActorRotation();
+		Locomotion.InAirRotation = FRotator3f(GetActorRotation());
 		if (CurrentStanceState == EPlayerStanceState::Crouching)
 		{
 			UnCrouch();
 		}
+		if (ShouldPredictLanding())
+		{
+			if (LandingPrediction)
+			{
+				LandingPrediction->Reset();
+			}
+			PredictLanding();
+		}
+	}
+	else if (PreviousState == EPlayerMovementState::InAir && LandingPrediction)
+	{
+		LandingPrediction->Reset();
 	}
 }
 
@@ -501,10 +1362,72 @@ void AMonatyCharacter::OnGaitChanged(EPlayerGaitState PreviousGait)
 void AMonatyCharacter::OnJumped_Implementation()
 {
 	// Set the new In Air Rotation to the velocity rotation if speed is greater than 100.
-	InAirRotation = Speed > 100.0f ? LastVelocityRotation : GetActorRotation();
+	Locomotion.InAirRotation = Locomotion.Speed > 100.0f
+		                           ? Locomotion.LastVelocityRotation
+		                           : FRotator3f(GetActorRotation());
 }
 
 void AMonatyCharacter::Landed(const FHitResult& Hit)
 {
-	// Todo.
+	Super::Landed(Hit);
+	if (!LandingPrediction || !ShouldPredictLanding())
+	{
+		return;
+	}
+	FMonatyLandingAccuracy::RecordLanding(*LandingPrediction, GetActorLocation(), GetWorld()->GetTimeSeconds());
+}
+
+bool AMonatyCharacter::GetPredictedLanding(FVector& OutLocation, FVector& OutNormal, float& OutTimeToLand) const
+{
+	if (CurrentMovementState != EPlayerMovementState::InAir || !LandingPrediction || !LandingPrediction->HasLanding())
+	{
+		return false;
+	}
+	OutLocation = LandingPrediction->LandingLocation;
+	OutNormal = LandingPrediction->LandingNormal;
+	OutTimeToLand = LandingPrediction->GetTimeToLand(GetWorld()->GetTimeSeconds());
+	return true;
+}
+
+bool AMonatyCharacter::ShouldPredictLanding() const
+{
+	// Nothing reads the prediction there by default.
+	return bPredictLandingEverywhere || (!IsNetMode(NM_DedicatedServer) && GetLocalRole() != ROLE_SimulatedProxy);
+}
+
+void AMonatyCharacter::PredictLanding()
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const UCapsuleComponent* Capsule = GetCapsuleComponent();
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(LandingPrediction), false, this);
+	if (!LandingPrediction)
+	{
+		LandingPrediction = MakeUnique<FMonatyLandingPrediction>();
+	}
+	LandingPrediction->WalkableFloorZ = GetCharacterMovement()->GetWalkableFloorZ();
+	LandingPrediction->Predict(GetWorld(), GetActorLocation(), GetVelocity(), GetCharacterMovement()->GetGravityZ(),
+	                           Capsule->GetCollisionShape(), Capsule->GetCollisionObjectType(), QueryParams);
+	FMonatyLandingAccuracy::RecordPrediction(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+}
+
+void AMonatyCharacter::UpdateLandingPrediction()
+{
+	// Falls that started before this character predicted anything begin here.
+	if (!LandingPrediction)
+	{
+		PredictLanding();
+		return;
+	}
+	LandingPrediction->Update(GetWorld());
+	if (LandingPrediction->NeedsRefresh(GetVelocity(), GetWorld()->GetTimeSeconds()))
+	{
+		PredictLanding();
+	}
+
+	if (MONATY_DEBUG_ENABLED(Locomotion) && LandingPrediction->HasLanding())
+	{
+		DrawDebugSphere(GetWorld(), LandingPrediction->LandingLocation, 20.0f, 8, FColor::Cyan);
+		DrawDebugLine(GetWorld(), LandingPrediction->LandingLocation,
+		              LandingPrediction->LandingLocation + LandingPrediction->LandingNormal * 50.0f, FColor::Cyan);
+	}
 }
@@ -0,0 +1,129 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Character/MonatyCharacterPool.h"
+
+#include "Character/MonatyCharacter.h"
+#include "Engine/World.h"
+
+static TAutoConsoleVariable<bool> CVarPoolCharacters(
+	TEXT("monaty.Pool.Characters"),
+	false,
+	TEXT("Reuse parked characters for respawns and joins instead of constructing new ones. Off until the pooled and ")
+	TEXT("constructed spawn times have been compared on a real server."));
+
+// Parked characters wait out of the way until they are taken.
+static const FVector PoolParkingLocation(0.0f, 0.0f, -100000.0f);
+
+bool UMonatyCharacterPoolSubsystem::IsPoolEnabled()
+{
+	return CVarPoolCharacters.GetValueOnGameThread();
+}
+
+bool UMonatyCharacterPoolSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UMonatyCharacterPoolSubsystem::Prewarm(TSubclassOf<AMonatyCharacter> CharacterClass, int32 Count)
+{
+	if (!CharacterClass || GetWorld()->GetNetMode() == NM_Client)
+	{
+		return;
+	}
+	TArray<AMonatyCharacter*>& Parked = Pools.FindOrAdd(CharacterClass).Characters;
+	Parked.Reserve(Count);
+	while (Parked.Num() < Count)
+	{
+		AMonatyCharacter* Character = SpawnCharacter(CharacterClass, FTransform(PoolParkingLocation));
+		if (!Character)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UMonatyCharacterPoolSubsystem::Prewarm | Could not spawn %s!"),
+			       *CharacterClass->GetName());
+			return;
+		}
+		Character->ParkInPool();
+		Parked.Add(Character);
+	}
+}
+
+AMonatyCharacter* UMonatyCharacterPoolSubsystem::Acquire(TSubclassOf<AMonatyCharacter> CharacterClass,
+                                                        const FTransform& SpawnTransform)
+{
+	if (FMonatyCharacterPoolList* Pool = Pools.Find(CharacterClass))
+	{
+		while (Pool->Characters.Num() > 0)
+		{
+			AMonatyCharacter* Character = Pool->Characters.Pop(false);
+			if (IsValid(Character))
+			{
+				Character->TakeFromPool(SpawnTransform);
+				return Character;
+			}
+		}
+	}
+	return SpawnCharacter(CharacterClass, SpawnTransform);
+}
+
+void UMonatyCharacterPoolSubsystem::Release(AMonatyCharacter* Character)
+{
+	if (!IsValid(Character))
+	{
+		return;
+	}
+	Character->ParkInPool();
+	Pools.FindOrAdd(Character->GetClass()).Characters.Add(Character);
+}
+
+int32 UMonatyCharacterPoolSubsystem::GetNumParked(TSubclassOf<AMonatyCharacter> CharacterClass) const
+{
+	const FMonatyCharacterPoolList* Pool = Pools.Find(CharacterClass);
+	return Pool ? Pool->Characters.Num() : 0;
+}
+
+AMonatyCharacter* UMonatyCharacterPoolSubsystem::SpawnCharacter(TSubclassOf<AMonatyCharacter> CharacterClass,
+                                                               const FTransform& SpawnTransform)
+{
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParameters.ObjectFlags |= RF_Transient;
+	return GetWorld()->SpawnActor<AMonatyCharacter>(CharacterClass, SpawnTransform, SpawnParameters);
+}
+
+void UMonatyCharacterPoolSubsystem::RecordSpawnTime(bool bPooled, double Milliseconds)
+{
+	(bPooled ? PooledSpawnMs : SpawnedSpawnMs).Samples.Add(Milliseconds);
+}
+
+void UMonatyCharacterPoolSubsystem::RecordLeaveTime(bool bPooled, double Milliseconds)
+{
+	(bPooled ? PooledLeaveMs : DestroyedLeaveMs).Samples.Add(Milliseconds);
+}
+
+void UMonatyCharacterPoolSubsystem::PrintSpawnStats(FOutputDevice& Ar) const
+{
+	const auto PrintSeries = [&Ar](const TCHAR* Label, const FMonatyBenchmarkSeries& Series)
+	{
+		Ar.Logf(TEXT("%s: %d characters, mean %.3f ms, p99 %.3f ms, max %.3f ms"), Label, Series.Samples.Num(),
+		        Series.GetMean(), Series.GetPercentile(99.0), Series.GetPercentile(100.0));
+	};
+	PrintSeries(TEXT("Join pooled"), PooledSpawnMs);
+	PrintSeries(TEXT("Join constructed"), SpawnedSpawnMs);
+	PrintSeries(TEXT("Leave parked"), PooledLeaveMs);
+	PrintSeries(TEXT("Leave destroyed"), DestroyedLeaveMs);
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice PoolStatsCommand(
+	TEXT("Monaty.Pool.Stats"),
+	TEXT("Prints the join and leave hitch: time spent getting characters ready for possession, pooled and ")
+	TEXT("constructed, and getting rid of them when their player leaves, parked and destroyed."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+		[](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			if (const UMonatyCharacterPoolSubsystem* Pool = World
+				                                                ? World->GetSubsystem<UMonatyCharacterPoolSubsystem>()
+				                                                : nullptr)
+			{
+				Pool->PrintSpawnStats(Ar);
+			}
+		}));
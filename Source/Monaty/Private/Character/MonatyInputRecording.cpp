@@ -0,0 +1,150 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Character/MonatyInputRecording.h"
+
+#include "EngineUtils.h"
+#include "Character/MonatyCharacter.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerStart.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+FArchive& operator<<(FArchive& Ar, FMonatyInputFrame& Frame)
+{
+	Ar << Frame.DeltaTime;
+	Ar << Frame.ForwardBackward;
+	Ar << Frame.LeftRight;
+	Ar << Frame.LookUpDown;
+	Ar << Frame.LookLeftRight;
+	Ar << reinterpret_cast<uint8&>(Frame.Actions);
+	Ar << Frame.ControlRotation;
+	Ar << Frame.Location;
+	Ar << Frame.Rotation;
+	Ar << Frame.MovementState;
+	Ar << Frame.GaitState;
+	Ar << Frame.StanceState;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FMonatyInputRecording& Recording)
+{
+	uint32 Magic = FMonatyInputRecording::FileMagic;
+	uint32 Version = FMonatyInputRecording::FileVersion;
+	Ar << Magic;
+	Ar << Version;
+	if (Ar.IsLoading() && (Magic != FMonatyInputRecording::FileMagic || Version != FMonatyInputRecording::FileVersion))
+	{
+		Ar.SetError();
+		return Ar;
+	}
+	Ar << Recording.Frames;
+	return Ar;
+}
+
+bool FMonatyInputRecording::SaveToFile(const FString& FilePath) const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	Writer << const_cast<FMonatyInputRecording&>(*this);
+	return FFileHelper::SaveArrayToFile(Bytes, *ResolvePath(FilePath));
+}
+
+bool FMonatyInputRecording::LoadFromFile(const FString& FilePath)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *ResolvePath(FilePath)))
+	{
+		return false;
+	}
+	FMemoryReader Reader(Bytes);
+	Reader << *this;
+	return !Reader.IsError();
+}
+
+FString FMonatyInputRecording::GetRecordingDir()
+{
+	return FPaths::ProjectSavedDir() / TEXT("InputRecordings");
+}
+
+FString FMonatyInputRecording::ResolvePath(const FString& FilePath)
+{
+	return FPaths::IsRelative(FilePath) ? GetRecordingDir() / FilePath : FilePath;
+}
+
+namespace MonatyInputRecording
+{
+	AMonatyCharacter* FindLocalCharacter(UWorld* World)
+	{
+		return Cast<AMonatyCharacter>(UGameplayStatics::GetPlayerCharacter(World, 0));
+	}
+
+	AMonatyCharacter* SpawnReplayCharacter(UWorld* World)
+	{
+		// Headless servers have no player, so spawn the default pawn at the first player start.
+		const AGameModeBase* GameMode = World->GetAuthGameMode();
+		if (!GameMode || !GameMode->DefaultPawnClass || !GameMode->DefaultPawnClass->IsChildOf<AMonatyCharacter>())
+		{
+			return nullptr;
+		}
+		FTransform SpawnTransform = FTransform::Identity;
+		for (TActorIterator<APlayerStart> It(World); It; ++It)
+		{
+			SpawnTransform = It->GetActorTransform();
+			break;
+		}
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+		return World->SpawnActor<AMonatyCharacter>(GameMode->DefaultPawnClass, SpawnTransform, SpawnParameters);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs StartRecordCommand(
+	TEXT("Monaty.Input.Record"),
+	TEXT("Starts recording the local character input."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (AMonatyCharacter* Character = MonatyInputRecording::FindLocalCharacter(World))
+		{
+			Character->StartInputRecording();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs StopRecordCommand(
+	TEXT("Monaty.Input.StopRecord"),
+	TEXT("Stops recording and saves it. Usage: Monaty.Input.StopRecord <File>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		AMonatyCharacter* Character = MonatyInputRecording::FindLocalCharacter(World);
+		if (Character && Args.Num() > 0)
+		{
+			Character->StopInputRecording(Args[0]);
+		}
+	}));
+
+// Run headless and faster than real time with:
+// -server -nullrhi -benchmark -ExecCmds="Monaty.Input.Replay <File> exit"
+static FAutoConsoleCommandWithWorldAndArgs ReplayCommand(
+	TEXT("Monaty.Input.Replay"),
+	TEXT("Replays a recording and compares the results. Usage: Monaty.Input.Replay <File> [exit]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (Args.Num() == 0)
+		{
+			return;
+		}
+		AMonatyCharacter* Character = MonatyInputRecording::FindLocalCharacter(World);
+		if (!Character)
+		{
+			Character = MonatyInputRecording::SpawnReplayCharacter(World);
+		}
+		if (!Character)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Monaty.Input.Replay | No character to replay on!"));
+			return;
+		}
+		const bool bExitWhenDone = Args.Num() > 1 && Args[1].Equals(TEXT("exit"), ESearchCase::IgnoreCase);
+		Character->StartInputReplay(Args[0], bExitWhenDone);
+	}));
@@ -0,0 +1,176 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Character/MonatyLandingPrediction.h"
+
+#include "Engine/World.h"
+#include "Profiling/MonatyBenchmark.h"
+#include "Profiling/MonatyStats.h"
+
+static TAutoConsoleVariable<float> CVarLandingRefreshSpeed(
+	TEXT("monaty.Landing.RefreshSpeed"),
+	50.0f,
+	TEXT("How far the velocity of a falling character may drift off the predicted arc, in cm/s, before the landing is ")
+	TEXT("predicted again."));
+
+void FMonatyLandingPrediction::Predict(const UWorld* World, const FVector& Location, const FVector& Velocity,
+                                       float GravityZ, const FCollisionShape& Shape, ECollisionChannel Channel,
+                                       const FCollisionQueryParams& QueryParams)
+{
+	MONATY_SCOPED_STAT(STAT_MonatyLandingPrediction);
+	MONATY_INC_COUNTER(STAT_MonatyTraces, Traces, NumSegments);
+
+	ArcLocation = Location;
+	ArcVelocity = Velocity;
+	ArcGravityZ = GravityZ;
+	ArcTime = World->GetTimeSeconds();
+	IssueFrame = GFrameCounter;
+	bLost = false;
+	PredictionCount++;
+
+	// Chords through the arc, short enough that a chord and the arc don't hit different things in practice.
+	FVector SegmentStart = Location;
+	for (int32 Index = 0; Index < NumSegments; Index++)
+	{
+		const FVector SegmentEnd = GetArcLocation(Location, Velocity, GravityZ,
+		                                          ArcDuration * (Index + 1) / NumSegments);
+		Traces[Index] = World->AsyncSweepByChannel(EAsyncTraceType::Single, SegmentStart, SegmentEnd, FQuat::Identity,
+		                                           Channel, Shape, QueryParams);
+		SegmentStart = SegmentEnd;
+	}
+}
+
+bool FMonatyLandingPrediction::Update(const UWorld* World)
+{
+	// Async traces are done at the start of the next frame.
+	if (!IsPending() || GFrameCounter <= IssueFrame)
+	{
+		return false;
+	}
+
+	bHasLanding = false;
+	for (int32 Index = 0; Index < NumSegments; Index++)
+	{
+		FTraceDatum Datum;
+		if (!World->QueryTraceData(Traces[Index], Datum))
+		{
+			// The results are gone, e.g. after a hitch. Predict again.
+			bLost = true;
+			break;
+		}
+		const FHitResult* Hit = FHitResult::GetFirstBlockingHit(Datum.OutHits);
+		// Starting in penetration means touching the floor that was just left.
+		if (!Hit || Hit->bStartPenetrating)
+		{
+			continue;
+		}
+		// A wall or a ceiling changes the velocity, which triggers a new prediction from there.
+		if (Hit->ImpactNormal.Z >= WalkableFloorZ)
+		{
+			LandingLocation = Hit->Location;
+			LandingNormal = Hit->ImpactNormal;
+			LandingTime = ArcTime + ArcDuration * (Index + Hit->Time) / NumSegments;
+			bHasLanding = true;
+		}
+		break;
+	}
+	for (FTraceHandle& Trace : Traces)
+	{
+		Trace = FTraceHandle();
+	}
+	return true;
+}
+
+bool FMonatyLandingPrediction::NeedsRefresh(const FVector& Velocity, double Time) const
+{
+	if (IsPending())
+	{
+		return false;
+	}
+	if (bLost || (!bHasLanding && Time >= ArcTime + ArcDuration) || (bHasLanding && Time > LandingTime + OverdueTime))
+	{
+		return true;
+	}
+	const FVector ArcVelocityNow = ArcVelocity + FVector(0.0f, 0.0f, ArcGravityZ * (Time - ArcTime));
+	const float RefreshSpeed = CVarLandingRefreshSpeed.GetValueOnGameThread();
+	return FVector::DistSquared(Velocity, ArcVelocityNow) > FMath::Square(RefreshSpeed);
+}
+
+void FMonatyLandingPrediction::Reset()
+{
+	for (FTraceHandle& Trace : Traces)
+	{
+		Trace = FTraceHandle();
+	}
+	bHasLanding = false;
+	bLost = false;
+	PredictionCount = 0;
+}
+
+FVector FMonatyLandingPrediction::GetArcLocation(const FVector& Location, const FVector& Velocity, float GravityZ,
+                                                 float Time)
+{
+	return Location + Velocity * Time + FVector(0.0f, 0.0f, 0.5f * GravityZ * Time * Time);
+}
+
+namespace
+{
+	FMonatyBenchmarkReport& GetLandingReport()
+	{
+		static FMonatyBenchmarkReport Report;
+		if (Report.Series.Num() == 0)
+		{
+			Report.Name = TEXT("LandingPrediction");
+			Report.AddSeries(TEXT("LocationErrorCm"));
+			Report.AddSeries(TEXT("TimeErrorMs"));
+			Report.AddSeries(TEXT("PredictionsPerFall"));
+			Report.AddSeries(TEXT("PredictMs"));
+		}
+		return Report;
+	}
+
+	int32 UnpredictedLandings = 0;
+}
+
+void FMonatyLandingAccuracy::RecordPrediction(double Milliseconds)
+{
+	GetLandingReport().Series[3].Samples.Add(Milliseconds);
+}
+
+void FMonatyLandingAccuracy::RecordLanding(const FMonatyLandingPrediction& Prediction, const FVector& Location,
+                                           double Time)
+{
+	FMonatyBenchmarkReport& Report = GetLandingReport();
+	if (!Prediction.HasLanding())
+	{
+		UnpredictedLandings++;
+		return;
+	}
+	Report.Series[0].Samples.Add(FVector::Dist(Prediction.LandingLocation, Location));
+	Report.Series[1].Samples.Add(FMath::Abs(Prediction.LandingTime - Time) * 1000.0);
+	Report.Series[2].Samples.Add(Prediction.PredictionCount);
+}
+
+void FMonatyLandingAccuracy::Report(bool bReset)
+{
+	FMonatyBenchmarkReport& Report = GetLandingReport();
+	UE_LOG(LogTemp, Display, TEXT("FMonatyLandingAccuracy::Report | %d predicted landings, %d without a prediction"),
+	       Report.Series[0].Samples.Num(), UnpredictedLandings);
+	Report.SaveCsv();
+	if (bReset)
+	{
+		for (FMonatyBenchmarkSeries& Series : Report.Series)
+		{
+			Series.Samples.Reset();
+		}
+		UnpredictedLandings = 0;
+	}
+}
+
+static FAutoConsoleCommand LandingReportCommand(
+	TEXT("Monaty.Landing.Report"),
+	TEXT("Prints and saves how far predicted landings were off and what predicting them cost. Usage: ")
+	TEXT("Monaty.Landing.Report [reset]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FMonatyLandingAccuracy::Report(Args.Num() > 0 && Args[0].Equals(TEXT("reset"), ESearchCase::IgnoreCase));
+	}));
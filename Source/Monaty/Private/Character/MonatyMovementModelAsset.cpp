@@ -0,0 +1,141 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Character/MonatyMovementModelAsset.h"
+
+#include "EngineUtils.h"
+#include "Engine/AssetManager.h"
+#include "Engine/DataTable.h"
+
+const FPrimaryAssetType UMonatyMovementModelAsset::PrimaryAssetType = TEXT("MonatyMovementModel");
+UMonatyMovementModelAsset::FOnMovementModelChanged UMonatyMovementModelAsset::OnMovementModelChanged;
+
+FPrimaryAssetId UMonatyMovementModelAsset::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
+
+void UMonatyMovementModelAsset::PostLoad()
+{
+	Super::PostLoad();
+	// Also runs when the package is reloaded, which replaces the object characters point at.
+	OnMovementModelChanged.Broadcast(this);
+}
+
+#if WITH_EDITOR
+void UMonatyMovementModelAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	OnMovementModelChanged.Broadcast(this);
+}
+#endif
+
+void UMonatyMovementModelSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	ModelChangedHandle = UMonatyMovementModelAsset::OnMovementModelChanged.AddUObject(
+		this, &UMonatyMovementModelSubsystem::OnMovementModelChanged);
+
+	// Start loading every model up front, so they are usually in memory before the first character spawns.
+	if (UAssetManager* AssetManager = UAssetManager::GetIfValid())
+	{
+		PreloadHandle = AssetManager->LoadPrimaryAssetsWithType(UMonatyMovementModelAsset::PrimaryAssetType);
+	}
+}
+
+void UMonatyMovementModelSubsystem::Deinitialize()
+{
+	UMonatyMovementModelAsset::OnMovementModelChanged.Remove(ModelChangedHandle);
+	if (PreloadHandle.IsValid())
+	{
+		PreloadHandle->CancelHandle();
+		PreloadHandle.Reset();
+	}
+	Super::Deinitialize();
+}
+
+void UMonatyMovementModelSubsystem::RequestMovementModel(const TSoftObjectPtr<UMonatyMovementModelAsset>& ModelAsset,
+                                                         FOnMovementModelLoaded OnLoaded)
+{
+	const FSoftObjectPath Path = ModelAsset.ToSoftObjectPath();
+	if (UMonatyMovementModelAsset** Found = LoadedModels.Find(Path))
+	{
+		OnLoaded.ExecuteIfBound(*Found);
+		return;
+	}
+	if (UMonatyMovementModelAsset* Loaded = ModelAsset.Get())
+	{
+		LoadedModels.Add(Path, Loaded);
+		OnLoaded.ExecuteIfBound(Loaded);
+		return;
+	}
+
+	// Only the first request for a model starts the load, the rest wait for it.
+	TArray<FOnMovementModelLoaded>& Pending = PendingRequests.FindOrAdd(Path);
+	Pending.Add(MoveTemp(OnLoaded));
+	if (Pending.Num() > 1)
+	{
+		return;
+	}
+	UAssetManager::GetStreamableManager().RequestAsyncLoad(Path, FStreamableDelegate::CreateWeakLambda(this, [this, Path]()
+	{
+		UMonatyMovementModelAsset* Loaded = Cast<UMonatyMovementModelAsset>(Path.ResolveObject());
+		if (Loaded)
+		{
+			LoadedModels.Add(Path, Loaded);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UMonatyMovementModelSubsystem::RequestMovementModel | Could not load %s!"),
+			       *Path.ToString());
+		}
+		TArray<FOnMovementModelLoaded> Callbacks;
+		PendingRequests.RemoveAndCopyValue(Path, Callbacks);
+		for (const FOnMovementModelLoaded& Callback : Callbacks)
+		{
+			Callback.ExecuteIfBound(Loaded);
+		}
+	}));
+}
+
+UMonatyMovementModelAsset* UMonatyMovementModelSubsystem::GetMovementModelFromDataTable(
+	const FDataTableRowHandle& RowHandle)
+{
+	if (!RowHandle.DataTable)
+	{
+		return nullptr;
+	}
+	const FString Key = RowHandle.DataTable->GetPathName() + TEXT(":") + RowHandle.RowName.ToString();
+	if (UMonatyMovementModelAsset** Found = DataTableModels.Find(Key))
+	{
+		return *Found;
+	}
+	const FPlayerMovementModel* Row = RowHandle.GetRow<FPlayerMovementModel>(TEXT("GetMovementModelFromDataTable"));
+	if (!Row)
+	{
+		return nullptr;
+	}
+	UMonatyMovementModelAsset* ModelAsset = NewObject<UMonatyMovementModelAsset>(this);
+	ModelAsset->Model = *Row;
+	DataTableModels.Add(Key, ModelAsset);
+	return ModelAsset;
+}
+
+void UMonatyMovementModelSubsystem::OnMovementModelChanged(UMonatyMovementModelAsset* ModelAsset)
+{
+	const FSoftObjectPath Path(ModelAsset);
+	if (UMonatyMovementModelAsset** Found = LoadedModels.Find(Path))
+	{
+		*Found = ModelAsset;
+		// Point characters at the reloaded object, their movement component picks the settings up next tick.
+		if (UWorld* World = GetWorld())
+		{
+			for (TActorIterator<AMonatyCharacter> It(World); It; ++It)
+			{
+				if (It->MovementModelAsset.ToSoftObjectPath() == Path)
+				{
+					It->LoadedMovementModel = ModelAsset;
+				}
+			}
+		}
+	}
+}
@@ -3,15 +3,33 @@
 #include "Components/MonatyCharacterMovementComponent.h"
 
 #include "Curves/CurveVector.h"
+#include "Profiling/MonatyBenchmark.h"
+#include "Profiling/MonatyStats.h"
 
 UMonatyCharacterMovementComponent::UMonatyCharacterMovementComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 }
 
+void UMonatyCharacterMovementComponent::SendClientAdjustment()
+{
+	const FNetworkPredictionData_Server_Character* ServerData = HasPredictionData_Server()
+		                                                            ? GetPredictionData_Server_Character()
+		                                                            : nullptr;
+	// A pending adjustment that doesn't just acknowledge the move is a correction.
+	if (ServerData && ServerData->PendingAdjustment.TimeStamp > 0.0f && !ServerData->PendingAdjustment.bAckGoodMove)
+	{
+		ServerCorrectionCount++;
+		MONATY_INC_COUNTER(STAT_MonatyCorrections, Corrections, 1);
+	}
+	Super::SendClientAdjustment();
+}
+
 void UMonatyCharacterMovementComponent::OnMovementUpdated(float DeltaTime, const FVector& OldLocation,
                                                             const FVector& OldVelocity)
 {
+	MONATY_BENCHMARK_SCOPE(OnMovementUpdated);
+
 	Super::OnMovementUpdated(DeltaTime, OldLocation, OldVelocity);
 
 	if (!CharacterOwner)
@@ -29,35 +47,48 @@ void UMonatyCharacterMovementComponent::OnMovementUpdated(float DeltaTime, const
 
 void UMonatyCharacterMovementComponent::PhysWalking(float deltaTime, int32 Iterations)
 {
+	MONATY_SCOPED_STAT(STAT_MonatyPhysWalking);
+	MONATY_BENCHMARK_SCOPE(PhysWalking);
+
 	if (CurrentMovementSettings.MovementCurve)
 	{
 		// Update the Ground Friction using the Movement Curve.
 		// This allows for fine control over movement behavior at each speed.
-		GroundFriction = CurrentMovementSettings.MovementCurve->GetVectorValue(GetMappedSpeed()).Z;
+		GroundFriction = SampleMovementCurve().Z;
 	}
 	Super::PhysWalking(deltaTime, Iterations);
 }
 
 float UMonatyCharacterMovementComponent::GetMaxAcceleration() const
 {
+	MONATY_BENCHMARK_SCOPE(GetMaxAcceleration);
+
 	// Update the Acceleration using the Movement Curve.
 	// This allows for fine control over movement behavior at each speed.
 	if (!IsMovingOnGround() || !CurrentMovementSettings.MovementCurve)
 	{
 		return Super::GetMaxAcceleration();
 	}
-	return CurrentMovementSettings.MovementCurve->GetVectorValue(GetMappedSpeed()).X;
+	return SampleMovementCurve().X;
 }
 
 float UMonatyCharacterMovementComponent::GetMaxBrakingDeceleration() const
 {
+	MONATY_BENCHMARK_SCOPE(GetMaxBrakingDeceleration);
+
 	// Update the Deceleration using the Movement Curve.
 	// This allows for fine control over movement behavior at each speed.
 	if (!IsMovingOnGround() || !CurrentMovementSettings.MovementCurve)
 	{
 		return Super::GetMaxBrakingDeceleration();
 	}
-	return CurrentMovementSettings.MovementCurve->GetVectorValue(GetMappedSpeed()).Y;
+	return SampleMovementCurve().Y;
+}
+
+FVector3f UMonatyCharacterMovementComponent::SampleMovementCurve() const
+{
+	MONATY_INC_COUNTER(STAT_MonatyCurveEvaluations, CurveEvaluations, 1);
+	return FVector3f(CurrentMovementSettings.MovementCurve->GetVectorValue(GetMappedSpeed()));
 }
 
 void UMonatyCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags) // Client only
@@ -77,11 +108,16 @@ float UMonatyCharacterMovementComponent::GetMappedSpeed() const
 	// Map the character's current speed to the configured movement speeds with a range of 0-3,
 	// with 0 = stopped, 1 = the Walk Speed, 2 = the Run Speed, and 3 = the Sprint Speed.
 	// This allows us to vary the movement speeds but still use the mapped range in calculations for consistent results
+	return GetMappedSpeed(Velocity.Size2D());
+}
 
-	const float Speed = Velocity.Size2D();
-	const float LocWalkSpeed = CurrentMovementSettings.WalkSpeed;
-	const float LocRunSpeed = CurrentMovementSettings.SprintSpeed;
+float UMonatyCharacterMovementComponent::GetMappedSpeed(float Speed) const
+{
+	return MapSpeed(Speed, CurrentMovementSettings.WalkSpeed, CurrentMovementSettings.SprintSpeed);
+}
 
+float UMonatyCharacterMovementComponent::MapSpeed(float Speed, float LocWalkSpeed, float LocRunSpeed)
+{
 	if (Speed > LocWalkSpeed)
 	{
 		return FMath::GetMappedRangeValueClamped(FVector2f{LocWalkSpeed, LocRunSpeed}, FVector2f{1.0f, 2.0f}, Speed);
@@ -90,7 +126,7 @@ float UMonatyCharacterMovementComponent::GetMappedSpeed() const
 	return FMath::GetMappedRangeValueClamped(FVector2f{0.0f, LocWalkSpeed}, FVector2f{0.0f, 1.0f}, Speed);
 }
 
-void UMonatyCharacterMovementComponent::SetMovementSettings(FPlayerMovementSettings NewMovementSettings)
+void UMonatyCharacterMovementComponent::SetMovementSettings(const FPlayerMovementSettings& NewMovementSettings)
 {
 	// Set the current movement settings from the owner
 	CurrentMovementSettings = NewMovementSettings;
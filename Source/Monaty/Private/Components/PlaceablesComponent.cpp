@@ -2,9 +2,31 @@
 
 #include "Components/PlaceablesComponent.h"
 
+#include "Debug/MonatyDebug.h"
+#include "DrawDebugHelpers.h"
 #include "GameFramework/Character.h"
+#include "GameFramework/GameStateBase.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/KismetSystemLibrary.h"
+#include "Net/MonatyLagCompensation.h"
+#include "Placeables/PlaceablesSubsystem.h"
+#include "Profiling/MonatyStats.h"
+#include "Profiling/MonatyTelemetry.h"
+
+static TAutoConsoleVariable<float> CVarMaxViewOriginError(
+	TEXT("monaty.Placeables.MaxViewOriginError"),
+	500.0f,
+	TEXT("How far a client's camera may be from its rewound capsule when it places something."));
+
+static TAutoConsoleVariable<float> CVarCharacterClearance(
+	TEXT("monaty.Placeables.CharacterClearance"),
+	50.0f,
+	TEXT("How close to another character, rewound to the client's time, a placement may be."));
+
+static TAutoConsoleVariable<float> CVarMaxTiltError(
+	TEXT("monaty.Placeables.MaxTiltError"),
+	5.0f,
+	TEXT("Degrees a conforming placement may be tilted away from the ground the server probes under it."));
 
 // Sets default values for this component's properties
 UPlaceablesComponent::UPlaceablesComponent()
@@ -12,8 +34,8 @@ UPlaceablesComponent::UPlaceablesComponent()
 	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
 	// off to improve performance if you don't need them.
 	PrimaryComponentTick.bCanEverTick = true;
-
-	// ...
+	// Placements made by clients are sent to the server.
+	SetIsReplicatedByDefault(true);
 }
 
 // Called when the game starts
@@ -31,6 +53,8 @@ void UPlaceablesComponent::BeginPlay()
 void UPlaceablesComponent::TickComponent(float DeltaTime, ELevelTick TickType,
                                          FActorComponentTickFunction* ThisTickFunction)
 {
+	MONATY_SCOPED_STAT(STAT_MonatyPlaceablesTick);
+
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
 	// If we are in place mode, we update.
@@ -72,6 +96,7 @@ void UPlaceablesComponent::StartPlacingActors(FDataTableRowHandle PlaceableHandl
 		if (PlaceableData->StaticStruct())
 		{
 			CurrentPlaceableData = *PlaceableData;
+			CurrentPlaceableHandle = PlaceableHandle;
 			// Spawn new placeable.
 			CreatePlaceableActor();
 		}
@@ -88,6 +113,25 @@ void UPlaceablesComponent::StopPlacingActors()
 }
 
 
+void UPlaceablesComponent::ResetForPool()
+{
+	StopPlacingActors();
+	DestroyCurrentPlaceable();
+	for (FTraceHandle& Probe : FootprintProbes)
+	{
+		Probe = FTraceHandle();
+	}
+	CurrentPlaceableData = {};
+	CurrentPlaceableHandle = {};
+	BrokenRule = EPlacementRule::None;
+	PlaceableTransform = FTransform::Identity;
+	PlaceableRotationZ = GetDefault<UPlaceablesComponent>(GetClass())->PlaceableRotationZ;
+	bCanPlaceActor = false;
+	bIsSnapped = false;
+	PlayerController = nullptr;
+	SetComponentTickEnabled(false);
+}
+
 void UPlaceablesComponent::CreatePlaceableActor()
 {
 	// Return if now valid class.
@@ -102,13 +146,25 @@ void UPlaceablesComponent::CreatePlaceableActor()
 	if (APlaceableActor* PlaceableActor = GetWorld()->SpawnActor<APlaceableActor>(
 		CurrentPlaceableData.PlaceableActorClass, SpawnTransform, SpawnParameters))
 	{
+		MONATY_INC_COUNTER(STAT_MonatySpawns, Spawns, 1);
 		CurrentPlaceable = PlaceableActor;
 		PlaceableTransform = FTransform::Identity;
+		// The same footprint the server probes.
+		CurrentFootprintExtent = CurrentPlaceableData.bConformToSurface
+			                         ? GetFootprintExtent(CurrentPlaceableData)
+			                         : CurrentPlaceableData.FootprintExtent;
+		for (FTraceHandle& Probe : FootprintProbes)
+		{
+			Probe.Invalidate();
+		}
 	}
 }
 
 FHitResult UPlaceablesComponent::GetTraceHitResult() const
 {
+	MONATY_SCOPED_STAT(STAT_MonatyPlaceablesTrace);
+	MONATY_INC_COUNTER(STAT_MonatyTraces, Traces, 1);
+
 	const FVector StartLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
 	const FVector EndLocation = PlayerController->PlayerCameraManager->GetCameraRotation().Vector() * TraceDistance +
 		StartLocation;
@@ -117,10 +173,12 @@ FHitResult UPlaceablesComponent::GetTraceHitResult() const
 	UKismetSystemLibrary::LineTraceSingle(GetWorld(), StartLocation, EndLocation,
 	                                      UEngineTypes::ConvertToTraceType(ECC_Visibility),
 	                                      false, IgnoreActors,
-	                                      bDebugMode
+	                                      MONATY_DEBUG_ENABLED(Placement)
 		                                      ? EDrawDebugTrace::ForOneFrame
 		                                      : EDrawDebugTrace::None, Result,
 	                                      true);
+	MONATY_DEBUG_RECORD(Placement, Trace, this, StartLocation,
+	                    Result.bBlockingHit ? Result.ImpactPoint : EndLocation, Result.bBlockingHit);
 	return Result;
 }
 
@@ -131,13 +189,190 @@ void UPlaceablesComponent::UpdatePlaceablePosition()
 
 	// Otherwise, calculate positions.
 	FHitResult HitResult = GetTraceHitResult();
-	FVector HitLocation = HitResult.TraceEnd;
+	FVector HitLocation = HitResult.bBlockingHit ? HitResult.ImpactPoint : HitResult.TraceEnd;
 	// Update placeable transform.
 	FTransform NewPlaceableTransform = {GetPlaceableRotation(), GetFixedHitLocation(HitLocation), FVector::OneVector};
+	// Snap to a free socket of a nearby structure if there is one.
+	bIsSnapped = false;
+	if (bSnapEnabled)
+	{
+		if (const UPlaceablesSubsystem* Placeables = GetWorld()->GetSubsystem<UPlaceablesSubsystem>())
+		{
+			bIsSnapped = Placeables->FindSnapTransform(CurrentPlaceableData.PlacedActorClass, NewPlaceableTransform,
+			                                           SnapDistance, NewPlaceableTransform);
+		}
+	}
+	// Update can place, a snapped structure is supported by the one it snaps to.
+	bCanPlaceActor = HitResult.bBlockingHit || bIsSnapped;
+	if (CurrentPlaceableData.bConformToSurface && !bIsSnapped && HitResult.bBlockingHit)
+	{
+		// Fit with last frame's probes, then queue this frame's. Costs the game thread no more than queueing them.
+		const FTransform ProbeTransform = NewPlaceableTransform;
+		bCanPlaceActor = ApplyFootprintFit(NewPlaceableTransform);
+		QueueFootprintProbes(ProbeTransform);
+	}
+	// The placeable's rules, the server checks them again.
+	BrokenRule = EPlacementRule::None;
+	if (bCanPlaceActor)
+	{
+		FPlacementCandidate Candidate;
+		Candidate.Location = NewPlaceableTransform.GetLocation();
+		Candidate.SurfaceNormal = HitResult.bBlockingHit && !bIsSnapped && !CurrentPlaceableData.bConformToSurface
+			                          ? HitResult.ImpactNormal
+			                          : NewPlaceableTransform.GetRotation().GetUpVector();
+		Candidate.bSnapped = bIsSnapped;
+		BrokenRule = CheckPlacementRules(CurrentPlaceableHandle, Candidate);
+		bCanPlaceActor = BrokenRule == EPlacementRule::None;
+	}
 	UpdatePlaceableTransform(NewPlaceableTransform);
-	// Update can place.
-	bCanPlaceActor = HitResult.bBlockingHit;
 	UpdatePlaceableMaterials(bCanPlaceActor);
+
+	MONATY_DEBUG_RECORD(Placement, PlacementValidity, this, NewPlaceableTransform.GetLocation(), FVector::ZeroVector,
+	                    bCanPlaceActor, bIsSnapped);
+	if (MONATY_DEBUG_ENABLED(Snap) && bIsSnapped)
+	{
+		DrawDebugCoordinateSystem(GetWorld(), NewPlaceableTransform.GetLocation(), NewPlaceableTransform.Rotator(),
+		                          50.0f);
+	}
+}
+
+void UPlaceablesComponent::QueueFootprintProbes(const FTransform& Transform)
+{
+	MONATY_INC_COUNTER(STAT_MonatyTraces, Traces, NumFootprintProbes);
+
+	FVector LocalPoints[NumFootprintProbes];
+	GetFootprintProbePoints(CurrentFootprintExtent, LocalPoints);
+	// Probe around the upright transform, the fit adds the tilt.
+	const FTransform Upright(FRotator(0.0f, Transform.Rotator().Yaw, 0.0f), Transform.GetLocation());
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(PlaceableFootprint), true);
+	QueryParams.AddIgnoredActor(CurrentPlaceable);
+	QueryParams.AddIgnoredActor(PlayerCharacter);
+	const FVector ProbeOffset = FVector::UpVector * FootprintProbeDistance;
+	for (int32 Index = 0; Index < NumFootprintProbes; Index++)
+	{
+		const FVector Point = Upright.TransformPosition(LocalPoints[Index]);
+		FootprintProbes[Index] = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Point + ProbeOffset,
+		                                                             Point - ProbeOffset, ECC_Visibility, QueryParams);
+	}
+}
+
+bool UPlaceablesComponent::ProbeFootprintPlane(const FTransform& Transform, const FVector2D& Extent,
+                                               FVector& OutNormal, FVector& OutCentroid, float& OutSlopeAngle,
+                                               float& OutGap) const
+{
+	MONATY_INC_COUNTER(STAT_MonatyTraces, Traces, NumFootprintProbes);
+
+	FVector LocalPoints[NumFootprintProbes];
+	GetFootprintProbePoints(Extent, LocalPoints);
+	const FTransform Upright(FRotator(0.0f, Transform.Rotator().Yaw, 0.0f), Transform.GetLocation());
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(PlaceableFootprint), true);
+	QueryParams.AddIgnoredActor(PlayerCharacter);
+	const FVector ProbeOffset = FVector::UpVector * FootprintProbeDistance;
+	FVector Points[NumFootprintProbes];
+	for (int32 Index = 0; Index < NumFootprintProbes; Index++)
+	{
+		const FVector Point = Upright.TransformPosition(LocalPoints[Index]);
+		FHitResult Hit;
+		if (!GetWorld()->LineTraceSingleByChannel(Hit, Point + ProbeOffset, Point - ProbeOffset, ECC_Visibility,
+		                                          QueryParams))
+		{
+			return false;
+		}
+		Points[Index] = Hit.ImpactPoint;
+	}
+	FitFootprintPlane(Points, OutNormal, OutCentroid, OutSlopeAngle, OutGap);
+	return true;
+}
+
+FVector2D UPlaceablesComponent::GetFootprintExtent(const FPlaceableData& Data)
+{
+	if (!Data.FootprintExtent.IsNearlyZero() || !Data.PlaceableActorClass)
+	{
+		return Data.FootprintExtent;
+	}
+	const FVector BoundsExtent = AActor::GetActorClassDefaultComponentsLocalBoundingBox(Data.PlaceableActorClass, true)
+		.GetExtent();
+	return FVector2D(BoundsExtent.X, BoundsExtent.Y);
+}
+
+void UPlaceablesComponent::GetFootprintProbePoints(const FVector2D& Extent, FVector (&OutPoints)[NumFootprintProbes])
+{
+	OutPoints[0] = {Extent.X, Extent.Y, 0.0f};
+	OutPoints[1] = {-Extent.X, Extent.Y, 0.0f};
+	OutPoints[2] = {-Extent.X, -Extent.Y, 0.0f};
+	OutPoints[3] = {Extent.X, -Extent.Y, 0.0f};
+	OutPoints[4] = FVector::ZeroVector;
+}
+
+void UPlaceablesComponent::FitFootprintPlane(const FVector (&Points)[NumFootprintProbes], FVector& OutNormal,
+                                             FVector& OutCentroid, float& OutSlopeAngle, float& OutGap)
+{
+	// Plane through the centroid, with the normal from the footprint diagonals.
+	OutNormal = ((Points[2] - Points[0]) ^ (Points[3] - Points[1])).GetSafeNormal();
+	if (OutNormal.Z < 0.0f)
+	{
+		OutNormal = -OutNormal;
+	}
+	OutCentroid = FVector::ZeroVector;
+	for (const FVector& Point : Points)
+	{
+		OutCentroid += Point / NumFootprintProbes;
+	}
+	OutSlopeAngle = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(OutNormal.Z, -1.0, 1.0)));
+	OutGap = 0.0f;
+	for (const FVector& Point : Points)
+	{
+		OutGap = FMath::Max(OutGap, FMath::Abs((Point - OutCentroid) | OutNormal));
+	}
+}
+
+bool UPlaceablesComponent::ApplyFootprintFit(FTransform& InOutTransform)
+{
+	FVector Points[NumFootprintProbes];
+	for (int32 Index = 0; Index < NumFootprintProbes; Index++)
+	{
+		FTraceDatum Datum;
+		if (!FootprintProbes[Index].IsValid() || !GetWorld()->QueryTraceData(FootprintProbes[Index], Datum))
+		{
+			return false;
+		}
+		const FHitResult* Hit = FHitResult::GetFirstBlockingHit(Datum.OutHits);
+		// Nothing under a corner means it overhangs further than the probes reach.
+		if (!Hit)
+		{
+			FootprintGap = FootprintProbeDistance;
+			return false;
+		}
+		Points[Index] = Hit->ImpactPoint;
+	}
+
+	FVector Normal;
+	FVector Centroid;
+	FitFootprintPlane(Points, Normal, Centroid, FootprintSlopeAngle, FootprintGap);
+	const bool bFits = FootprintSlopeAngle <= CurrentPlaceableData.MaxSlopeAngle &&
+		FootprintGap <= CurrentPlaceableData.MaxGap;
+	MONATY_DEBUG_RECORD(Footprint, FootprintFit, this, Centroid, Centroid + Normal * 100.0f, bFits, 0,
+	                    FootprintSlopeAngle, FootprintGap);
+	if (MONATY_DEBUG_ENABLED(Footprint))
+	{
+		for (const FVector& Point : Points)
+		{
+			DrawDebugPoint(GetWorld(), Point, 8.0f, bFits ? FColor::Green : FColor::Red);
+		}
+		DrawDebugLine(GetWorld(), Centroid, Centroid + Normal * 100.0f, bFits ? FColor::Green : FColor::Red);
+	}
+	if (!bFits)
+	{
+		return false;
+	}
+
+	// Tilt onto the plane and sit on it right below the aim point.
+	const FVector Location = InOutTransform.GetLocation();
+	const float PlaneZ = Centroid.Z - (Normal.X * (Location.X - Centroid.X) + Normal.Y * (Location.Y - Centroid.Y)) /
+		Normal.Z;
+	InOutTransform.SetRotation(FQuat::FindBetweenNormals(FVector::UpVector, Normal) * InOutTransform.GetRotation());
+	InOutTransform.SetLocation(GetFixedHitLocation({Location.X, Location.Y, PlaneZ}));
+	return true;
 }
 
 void UPlaceablesComponent::DestroyCurrentPlaceable()
@@ -176,6 +411,8 @@ void UPlaceablesComponent::UpdatePlaceableTransform(const FTransform& Transform)
 
 void UPlaceablesComponent::UpdatePlaceableMaterials(bool bCanPlace) const
 {
+	MONATY_SCOPED_STAT(STAT_MonatyPlaceablesMaterials);
+
 	// Make sure that the current placeable is valid.
 	if (!CurrentPlaceable) return;
 	// Loop through all its meshes.
@@ -188,6 +425,7 @@ void UPlaceablesComponent::UpdatePlaceableMaterials(bool bCanPlace) const
 		{
 			// Set material
 			MeshComponent->SetMaterial(MaterialIndex, bCanPlace ? AllowPlaceMaterial : DenyPlaceMaterial);
+			MONATY_INC_COUNTER(STAT_MonatyMaterialChanges, MaterialChanges, 1);
 		}
 	}
 }
@@ -201,15 +439,198 @@ void UPlaceablesComponent::ConstructPlaceableActor()
 
 	// Destroy placeable actor.
 	DestroyCurrentPlaceable();
-	// Create the placed actor.
-	const FTransform SpawnTransform = PlaceableTransform;
-	const FActorSpawnParameters SpawnParameters = {
-	};
-	// Try and spawn placeable.
-	if (AActor* PlacedActor = GetWorld()->SpawnActor<AActor>(
-		CurrentPlaceableData.PlacedActorClass, SpawnTransform, SpawnParameters))
+	// Create the placed actor, on the server so everyone gets it.
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	const FVector ViewOrigin = PlayerController->PlayerCameraManager->GetCameraLocation();
+	const double ClientTime = GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+	if (!GetOwner()->HasAuthority())
+	{
+		ServerConstructPlaceableActor(CurrentPlaceableHandle, PlaceableTransform, ViewOrigin, ClientTime);
+		return;
+	}
+	ServerConstructPlaceableActor_Implementation(CurrentPlaceableHandle, PlaceableTransform, ViewOrigin, ClientTime);
+}
+
+EPlacementRule UPlaceablesComponent::CheckPlacementRules(const FDataTableRowHandle& Placeable,
+                                                         const FPlacementCandidate& Candidate, bool bRecordStats) const
+{
+	UPlaceablesSubsystem* Placeables = GetWorld()->GetSubsystem<UPlaceablesSubsystem>();
+	const FPlacementRuleProgram* Program = Placeables ? Placeables->GetRuleProgram(Placeable) : nullptr;
+	if (!Program)
+	{
+		return EPlacementRule::None;
+	}
+	const uint32 OwnerId = UPlaceablesSubsystem::GetOwnerId(
+		PlayerCharacter ? PlayerCharacter->GetPlayerState() : nullptr);
+	EPlacementRule Result = EPlacementRule::None;
+	Placeables->EvaluatePlacementRules(*Program, OwnerId, MakeArrayView(&Candidate, 1), MakeArrayView(&Result, 1),
+	                                   bRecordStats);
+	return Result;
+}
+
+EPlacementRejection UPlaceablesComponent::ValidatePlacement(const FDataTableRowHandle& Placeable,
+                                                            const FPlaceableData& Data, const FTransform& Transform,
+                                                            const FVector& ViewOrigin, double ClientTime,
+                                                            bool& bOutSnapped) const
+{
+	bOutSnapped = false;
+	// The rules apply to the host too. Snapped placements sit right on a free socket.
+	if (const UPlaceablesSubsystem* Placeables = GetWorld()->GetSubsystem<UPlaceablesSubsystem>())
+	{
+		FPlacementCandidate Candidate;
+		Candidate.Location = Transform.GetLocation();
+		Candidate.SurfaceNormal = Transform.GetRotation().GetUpVector();
+		FTransform SnapTransform;
+		Candidate.bSnapped = Placeables->FindSnapTransform(Data.PlacedActorClass, Transform, 1.0f, SnapTransform);
+		bOutSnapped = Candidate.bSnapped;
+		// The client tilted conforming placements onto the ground it probed, the server probes it again rather than
+		// trusting the tilt.
+		if (Data.bConformToSurface && !Candidate.bSnapped)
+		{
+			FVector Normal;
+			FVector Centroid;
+			float SlopeAngle = 0.0f;
+			float Gap = 0.0f;
+			const bool bProbed = ProbeFootprintPlane(Transform, GetFootprintExtent(Data), Normal, Centroid, SlopeAngle,
+			                                         Gap);
+			const float TiltError = bProbed
+				                        ? FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(
+					                        Normal | Candidate.SurfaceNormal, -1.0, 1.0)))
+				                        : 180.0f;
+			if (!bProbed || SlopeAngle > Data.MaxSlopeAngle || Gap > Data.MaxGap ||
+				TiltError > CVarMaxTiltError.GetValueOnGameThread())
+			{
+				UE_LOG(LogTemp, Warning,
+				       TEXT("UPlaceablesComponent::ValidatePlacement | Footprint of %s doesn't fit, slope %.1f, gap %.1f, tilt error %.1f"),
+				       *GetOwner()->GetName(), SlopeAngle, Gap, TiltError);
+				return EPlacementRejection::Footprint;
+			}
+			Candidate.SurfaceNormal = Normal;
+		}
+		// Upright placements stand on what the client aimed at, the slope rule checks the surface under them.
+		else if (!Candidate.bSnapped)
+		{
+			MONATY_INC_COUNTER(STAT_MonatyTraces, Traces, 1);
+			FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(PlaceableSurface), true);
+			QueryParams.AddIgnoredActor(PlayerCharacter);
+			const FVector ProbeOffset = FVector::UpVector * FootprintProbeDistance;
+			FHitResult Hit;
+			if (!GetWorld()->LineTraceSingleByChannel(Hit, Candidate.Location + ProbeOffset,
+			                                          Candidate.Location - ProbeOffset, ECC_Visibility, QueryParams))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("UPlaceablesComponent::ValidatePlacement | Nothing under the placement of %s"),
+				       *GetOwner()->GetName());
+				return EPlacementRejection::Footprint;
+			}
+			Candidate.SurfaceNormal = Hit.ImpactNormal;
+		}
+		const EPlacementRule Rule = CheckPlacementRules(Placeable, Candidate, true);
+		if (Rule != EPlacementRule::None)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UPlaceablesComponent::ValidatePlacement | Placement by %s breaks rule %s"),
+			       *GetOwner()->GetName(), GetPlacementRuleName(Rule));
+			return EPlacementRejection::RuleBroken;
+		}
+	}
+
+	if (!PlayerCharacter || PlayerCharacter->IsLocallyControlled())
+	{
+		return EPlacementRejection::None;
+	}
+	// Check against the world as the client saw it, not as it is now. Without a history the reach is still checked
+	// from where the character is.
+	const UMonatyLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<
+		UMonatyLagCompensationSubsystem>();
+	const double Time = LagCompensation ? LagCompensation->GetRewindTime(ClientTime) : 0.0;
+	FMonatyCapsuleSample OwnerCapsule;
+	const FVector OwnerLocation = LagCompensation && LagCompensation->RewindCharacter(PlayerCharacter, Time, OwnerCapsule)
+		                              ? FVector(OwnerCapsule.Location)
+		                              : PlayerCharacter->GetActorLocation();
+	if (FVector::Dist(ViewOrigin, OwnerLocation) > CVarMaxViewOriginError.GetValueOnGameThread())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlaceablesComponent::ValidatePlacement | View origin too far from %s"),
+		       *PlayerCharacter->GetName());
+		return EPlacementRejection::ViewOrigin;
+	}
+	if (FVector::Dist(ViewOrigin, Transform.GetLocation()) > TraceDistance)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlaceablesComponent::ValidatePlacement | Placement out of reach of %s"),
+		       *PlayerCharacter->GetName());
+		return EPlacementRejection::OutOfReach;
+	}
+	TArray<ACharacter*> Overlapping;
+	if (LagCompensation && LagCompensation->OverlapSphere(Time, Transform.GetLocation(), CVarCharacterClearance.GetValueOnGameThread(),
+	                                   Overlapping, PlayerCharacter) > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlaceablesComponent::ValidatePlacement | Placement by %s blocked by %s"),
+		       *PlayerCharacter->GetName(), *Overlapping[0]->GetName());
+		return EPlacementRejection::BlockedByCharacter;
+	}
+	return EPlacementRejection::None;
+}
+
+void UPlaceablesComponent::ServerConstructPlaceableActor_Implementation(const FDataTableRowHandle& Placeable,
+                                                                        const FTransform& Transform,
+                                                                        const FVector_NetQuantize& ViewOrigin,
+                                                                        double ClientTime)
+{
+	// Everything the client sent is checked before it is used. GetRow rejects tables of another row struct.
+	const FPlaceableData* Data = Placeable.GetRow<FPlaceableData>(
+		TEXT("UPlaceablesComponent::ServerConstructPlaceableActor"));
+	EPlacementRejection Rejection = EPlacementRejection::None;
+	bool bSnapped = false;
+	if (!Data || !Data->PlacedActorClass)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlaceablesComponent::ServerConstructPlaceableActor | Unknown placeable %s from %s"),
+		       *Placeable.ToDebugString(), *GetOwner()->GetName());
+		Rejection = EPlacementRejection::UnknownPlaceable;
+	}
+	else if (!Transform.IsValid() || !Transform.GetScale3D().Equals(FVector::OneVector) || !FMath::IsFinite(ClientTime) ||
+		ViewOrigin.ContainsNaN())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlaceablesComponent::ServerConstructPlaceableActor | Invalid transform from %s"),
+		       *GetOwner()->GetName());
+		Rejection = EPlacementRejection::InvalidTransform;
+	}
+	else
+	{
+		Rejection = ValidatePlacement(Placeable, *Data, Transform, ViewOrigin, ClientTime, bSnapped);
+	}
+	if (Rejection == EPlacementRejection::None)
+	{
+		UPlaceablesSubsystem* Placeables = GetWorld()->GetSubsystem<UPlaceablesSubsystem>();
+		const uint32 OwnerId = UPlaceablesSubsystem::GetOwnerId(PlayerCharacter ? PlayerCharacter->GetPlayerState() : nullptr);
+		if (Placeables && Placeables->SpawnPlacedActor(Data->PlacedActorClass, Transform, OwnerId))
+		{
+			UE_LOG(LogTemp, Display, TEXT("UPlaceablesComponent::ConstructPlaceableActor Successfully created Placed Actor"));
+		}
+		else
+		{
+			Rejection = EPlacementRejection::SpawnFailed;
+		}
+	}
+	if (Rejection != EPlacementRejection::None)
+	{
+		MONATY_DEBUG_RECORD(Placement, PlacementRejected, this, Transform.GetLocation(), ViewOrigin,
+		                    static_cast<uint8>(Rejection));
+	}
+
+	if (FMonatyTelemetry::IsEnabled())
 	{
-		UE_LOG(LogTemp, Display, TEXT("UPlaceablesComponent::ConstructPlaceableActor Successfully created Placed Actor"));
+		FMonatyTelemetryRecord Record;
+		Record.Frame = static_cast<uint32>(GFrameCounter);
+		Record.Source = GetOwner()->GetUniqueID();
+		Record.Time = GetWorld()->GetTimeSeconds();
+		Record.Type = EMonatyTelemetryType::Placement;
+		Record.State[0] = Rejection == EPlacementRejection::None;
+		// What the server found, bIsSnapped is the preview's and only set on the placing client.
+		Record.State[1] = bSnapped;
+		Record.State[2] = static_cast<uint8>(Rejection);
+		Record.Values[0] = Transform.GetLocation().X;
+		Record.Values[1] = Transform.GetLocation().Y;
+		Record.Values[2] = Transform.GetLocation().Z;
+		Record.Values[3] = Transform.Rotator().Yaw;
+		FMonatyTelemetry::Push(Record);
 	}
 }
 
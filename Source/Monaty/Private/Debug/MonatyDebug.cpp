@@ -0,0 +1,234 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Debug/MonatyDebug.h"
+
+#include "DrawDebugHelpers.h"
+#include "Engine/World.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+bool FMonatyDebug::ChannelEnabled[static_cast<int32>(EMonatyDebugChannel::Count)] = {};
+bool FMonatyDebug::bRecord = true;
+
+#if MONATY_WITH_DEBUG
+
+static FAutoConsoleVariableRef CVarDebugPlacement(
+	TEXT("monaty.Debug.Placement"),
+	FMonatyDebug::ChannelEnabled[static_cast<int32>(EMonatyDebugChannel::Placement)],
+	TEXT("Draw the placement trace and whether the preview can be placed."));
+
+static FAutoConsoleVariableRef CVarDebugFootprint(
+	TEXT("monaty.Debug.Footprint"),
+	FMonatyDebug::ChannelEnabled[static_cast<int32>(EMonatyDebugChannel::Footprint)],
+	TEXT("Draw the footprint probes and the fitted plane of placements that conform to the surface."));
+
+static FAutoConsoleVariableRef CVarDebugSnap(
+	TEXT("monaty.Debug.Snap"),
+	FMonatyDebug::ChannelEnabled[static_cast<int32>(EMonatyDebugChannel::Snap)],
+	TEXT("Draw where the preview snaps to."));
+
+static FAutoConsoleVariableRef CVarDebugLocomotion(
+	TEXT("monaty.Debug.Locomotion"),
+	FMonatyDebug::ChannelEnabled[static_cast<int32>(EMonatyDebugChannel::Locomotion)],
+	TEXT("Draw each character's gait, stance, movement state and speed."));
+
+static FAutoConsoleVariableRef CVarDebugRecord(
+	TEXT("monaty.Debug.Record"),
+	FMonatyDebug::bRecord,
+	TEXT("Record traces, placement decisions and locomotion transitions into the debug log."));
+
+namespace MonatyDebugLog
+{
+	static constexpr int32 Capacity = 8192;
+
+	// Rolling log, the oldest entry is overwritten once full.
+	TArray<FMonatyDebugEntry> Entries;
+	int32 NextEntry = 0;
+	int32 NumEntries = 0;
+
+	template <typename VisitorType>
+	void ForEachEntry(VisitorType&& Visitor)
+	{
+		const int32 First = (NextEntry - NumEntries + Capacity) % Capacity;
+		for (int32 Offset = 0; Offset < NumEntries; Offset++)
+		{
+			Visitor(Entries[(First + Offset) % Capacity]);
+		}
+	}
+
+	const TCHAR* GetChannelName(EMonatyDebugChannel Channel)
+	{
+		switch (Channel)
+		{
+		case EMonatyDebugChannel::Placement:
+			return TEXT("Placement");
+		case EMonatyDebugChannel::Footprint:
+			return TEXT("Footprint");
+		case EMonatyDebugChannel::Snap:
+			return TEXT("Snap");
+		case EMonatyDebugChannel::Locomotion:
+			return TEXT("Locomotion");
+		default:
+			return TEXT("Unknown");
+		}
+	}
+
+	const TCHAR* GetEventName(EMonatyDebugEvent Event)
+	{
+		switch (Event)
+		{
+		case EMonatyDebugEvent::Trace:
+			return TEXT("Trace");
+		case EMonatyDebugEvent::PlacementValidity:
+			return TEXT("PlacementValidity");
+		case EMonatyDebugEvent::FootprintFit:
+			return TEXT("FootprintFit");
+		case EMonatyDebugEvent::PlacementRejected:
+			return TEXT("PlacementRejected");
+		case EMonatyDebugEvent::GaitChanged:
+			return TEXT("GaitChanged");
+		case EMonatyDebugEvent::StanceChanged:
+			return TEXT("StanceChanged");
+		case EMonatyDebugEvent::MovementStateChanged:
+			return TEXT("MovementStateChanged");
+		default:
+			return TEXT("Unknown");
+		}
+	}
+}
+
+void FMonatyDebug::Record(const FMonatyDebugEntry& Entry)
+{
+	using namespace MonatyDebugLog;
+
+	check(IsInGameThread());
+	if (Entries.Num() == 0)
+	{
+		Entries.SetNum(Capacity);
+	}
+	Entries[NextEntry] = Entry;
+	NextEntry = (NextEntry + 1) % Capacity;
+	NumEntries = FMath::Min(NumEntries + 1, Capacity);
+}
+
+void FMonatyDebug::Record(EMonatyDebugChannel Channel, EMonatyDebugEvent Event, const UObject* Source,
+                          const FVector& Start, const FVector& End, uint8 Value0, uint8 Value1, float Scalar,
+                          float Scalar2)
+{
+	FMonatyDebugEntry Entry;
+	const UWorld* World = Source ? Source->GetWorld() : nullptr;
+	Entry.Time = World ? World->GetTimeSeconds() : 0.0;
+	Entry.Frame = GFrameCounter;
+	Entry.Source = Source ? Source->GetUniqueID() : 0;
+	Entry.Channel = Channel;
+	Entry.Event = Event;
+	Entry.Values[0] = Value0;
+	Entry.Values[1] = Value1;
+	Entry.Start = FVector3f(Start);
+	Entry.End = FVector3f(End);
+	Entry.Scalar = Scalar;
+	Entry.Scalar2 = Scalar2;
+	Record(Entry);
+}
+
+bool FMonatyDebug::DumpCsv(const FString& FilePath)
+{
+	using namespace MonatyDebugLog;
+
+	FString Csv = TEXT("Frame,Time,Source,Channel,Event,Value0,Value1,StartX,StartY,StartZ,EndX,EndY,EndZ,Scalar,")
+		TEXT("Scalar2\n");
+	ForEachEntry([&Csv](const FMonatyDebugEntry& Entry)
+	{
+		Csv += FString::Printf(TEXT("%llu,%.4f,%u,%s,%s,%d,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.3f,%.3f\n"), Entry.Frame,
+		                       Entry.Time, Entry.Source, GetChannelName(Entry.Channel), GetEventName(Entry.Event),
+		                       Entry.Values[0], Entry.Values[1], Entry.Start.X, Entry.Start.Y, Entry.Start.Z,
+		                       Entry.End.X, Entry.End.Y, Entry.End.Z, Entry.Scalar, Entry.Scalar2);
+	});
+	return FFileHelper::SaveStringToFile(Csv, *FilePath);
+}
+
+void FMonatyDebug::DrawRecent(const UWorld* World, double Seconds, float Duration)
+{
+	using namespace MonatyDebugLog;
+
+	if (!World)
+	{
+		return;
+	}
+	const double FromTime = World->GetTimeSeconds() - Seconds;
+	ForEachEntry([World, FromTime, Duration](const FMonatyDebugEntry& Entry)
+	{
+		if (Entry.Time < FromTime)
+		{
+			return;
+		}
+		const FVector Start(Entry.Start);
+		switch (Entry.Event)
+		{
+		case EMonatyDebugEvent::Trace:
+			DrawDebugLine(World, Start, FVector(Entry.End), Entry.Values[0] ? FColor::Green : FColor::Red, false,
+			              Duration);
+			break;
+		case EMonatyDebugEvent::PlacementValidity:
+		case EMonatyDebugEvent::FootprintFit:
+			DrawDebugPoint(World, Start, 8.0f, Entry.Values[0] ? FColor::Green : FColor::Red, false, Duration);
+			break;
+		case EMonatyDebugEvent::PlacementRejected:
+			DrawDebugSphere(World, Start, 25.0f, 8, FColor::Red, false, Duration);
+			break;
+		default:
+			DrawDebugString(World, Start, FString::Printf(TEXT("%s %d>%d"), GetEventName(Entry.Event),
+			                                              Entry.Values[0], Entry.Values[1]), nullptr, FColor::White,
+			                Duration);
+			break;
+		}
+	});
+}
+
+static FAutoConsoleCommand DumpDebugLogCommand(
+	TEXT("Monaty.Debug.DumpLog"),
+	TEXT("Dumps the debug log to CSV. Usage: Monaty.Debug.DumpLog [File]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString FilePath = Args.Num() > 0
+			                         ? Args[0]
+			                         : FPaths::ProfilingDir() / TEXT("Monaty") /
+			                         FString::Printf(TEXT("MonatyDebugLog-%s.csv"), *FDateTime::Now().ToString());
+		const bool bSaved = FMonatyDebug::DumpCsv(FilePath);
+		UE_LOG(LogTemp, Display, TEXT("Monaty.Debug.DumpLog | %s %s"), bSaved ? TEXT("Saved") : TEXT("Could not save"),
+		       *FilePath);
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs DrawDebugLogCommand(
+	TEXT("Monaty.Debug.DrawLog"),
+	TEXT("Draws the debug log of the last seconds. Usage: Monaty.Debug.DrawLog [Seconds] [Duration]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const double Seconds = Args.Num() > 0 ? FCString::Atod(*Args[0]) : 5.0;
+		const float Duration = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 10.0f;
+		FMonatyDebug::DrawRecent(World, Seconds, Duration);
+	}));
+
+#else
+
+void FMonatyDebug::Record(const FMonatyDebugEntry& Entry)
+{
+}
+
+void FMonatyDebug::Record(EMonatyDebugChannel Channel, EMonatyDebugEvent Event, const UObject* Source,
+                          const FVector& Start, const FVector& End, uint8 Value0, uint8 Value1, float Scalar,
+                          float Scalar2)
+{
+}
+
+bool FMonatyDebug::DumpCsv(const FString& FilePath)
+{
+	return false;
+}
+
+void FMonatyDebug::DrawRecent(const UWorld* World, double Seconds, float Duration)
+{
+}
+
+#endif
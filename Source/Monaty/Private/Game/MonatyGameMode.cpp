@@ -0,0 +1,101 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Game/MonatyGameMode.h"
+
+#include "Character/MonatyCharacter.h"
+#include "Character/MonatyCharacterPool.h"
+#include "Engine/World.h"
+#include "Game/MonatyPlayerController.h"
+
+AMonatyGameMode::AMonatyGameMode()
+{
+	DefaultPawnClass = AMonatyCharacter::StaticClass();
+	PlayerControllerClass = AMonatyPlayerController::StaticClass();
+}
+
+void AMonatyGameMode::StartPlay()
+{
+	Super::StartPlay();
+	if (UMonatyCharacterPoolSubsystem::IsPoolEnabled() && DefaultPawnClass &&
+		DefaultPawnClass->IsChildOf<AMonatyCharacter>())
+	{
+		if (UMonatyCharacterPoolSubsystem* Pool = GetWorld()->GetSubsystem<UMonatyCharacterPoolSubsystem>())
+		{
+			Pool->Prewarm(DefaultPawnClass.Get(), PrewarmedCharacters);
+		}
+	}
+}
+
+APawn* AMonatyGameMode::SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer,
+                                                                   const FTransform& SpawnTransform)
+{
+	UClass* PawnClass = GetDefaultPawnClassForController(NewPlayer);
+	UMonatyCharacterPoolSubsystem* Pool = GetWorld()->GetSubsystem<UMonatyCharacterPoolSubsystem>();
+	const double StartTime = FPlatformTime::Seconds();
+	if (!Pool || !UMonatyCharacterPoolSubsystem::IsPoolEnabled() || !PawnClass ||
+		!PawnClass->IsChildOf<AMonatyCharacter>())
+	{
+		APawn* Pawn = Super::SpawnDefaultPawnAtTransform_Implementation(NewPlayer, SpawnTransform);
+		if (Pool)
+		{
+			Pool->RecordSpawnTime(false, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+		}
+		return Pawn;
+	}
+
+	const bool bPooled = Pool->GetNumParked(PawnClass) > 0;
+	AMonatyCharacter* Character = Pool->Acquire(PawnClass, SpawnTransform);
+	if (Character)
+	{
+		Character->SetInstigator(GetInstigator());
+	}
+	Pool->RecordSpawnTime(bPooled, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return Character;
+}
+
+void AMonatyGameMode::RespawnPlayer(AController* Controller)
+{
+	if (!Controller)
+	{
+		return;
+	}
+	if (APawn* Pawn = Controller->GetPawn())
+	{
+		if (!ReleaseCharacter(Controller))
+		{
+			// Without the pool a respawn replaces the character.
+			Controller->UnPossess();
+			Pawn->Destroy();
+		}
+	}
+	RestartPlayer(Controller);
+}
+
+bool AMonatyGameMode::ReleaseCharacter(AController* Controller)
+{
+	AMonatyCharacter* Character = Controller ? Cast<AMonatyCharacter>(Controller->GetPawn()) : nullptr;
+	UMonatyCharacterPoolSubsystem* Pool = GetWorld()->GetSubsystem<UMonatyCharacterPoolSubsystem>();
+	if (!Character || !Pool || !UMonatyCharacterPoolSubsystem::IsPoolEnabled())
+	{
+		return false;
+	}
+	Controller->UnPossess();
+	Pool->Release(Character);
+	return true;
+}
+
+static FAutoConsoleCommandWithWorldAndArgs RespawnCommand(
+	TEXT("Monaty.Pool.Respawn"),
+	TEXT("Respawns every player, to compare spawn times with monaty.Pool.Characters on and off."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		AMonatyGameMode* GameMode = World ? World->GetAuthGameMode<AMonatyGameMode>() : nullptr;
+		if (!GameMode)
+		{
+			return;
+		}
+		for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			GameMode->RespawnPlayer(It->Get());
+		}
+	}));
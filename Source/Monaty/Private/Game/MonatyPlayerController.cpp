@@ -0,0 +1,28 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Game/MonatyPlayerController.h"
+
+#include "Character/MonatyCharacterPool.h"
+#include "Engine/World.h"
+#include "Game/MonatyGameMode.h"
+
+void AMonatyPlayerController::PawnLeavingGame()
+{
+	AMonatyGameMode* GameMode = GetWorld()->GetAuthGameMode<AMonatyGameMode>();
+	UMonatyCharacterPoolSubsystem* Pool = GetWorld()->GetSubsystem<UMonatyCharacterPoolSubsystem>();
+	if (!GameMode || !GetPawn())
+	{
+		Super::PawnLeavingGame();
+		return;
+	}
+	const double StartTime = FPlatformTime::Seconds();
+	const bool bPooled = GameMode->ReleaseCharacter(this);
+	if (!bPooled)
+	{
+		Super::PawnLeavingGame();
+	}
+	if (Pool)
+	{
+		Pool->RecordLeaveTime(bPooled, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}
+}
@@ -0,0 +1,383 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Net/MonatyLagCompensation.h"
+
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "Profiling/MonatyBenchmark.h"
+#include "Profiling/MonatyStats.h"
+
+static TAutoConsoleVariable<int32> CVarLagCompMaxCharacters(
+	TEXT("monaty.LagComp.MaxCharacters"),
+	128,
+	TEXT("Characters the lag compensation history has room for. Read when the world starts."));
+
+static TAutoConsoleVariable<int32> CVarLagCompFrames(
+	TEXT("monaty.LagComp.Frames"),
+	64,
+	TEXT("Server frames kept in the lag compensation history. Read when the world starts."));
+
+static TAutoConsoleVariable<float> CVarLagCompMaxRewindMs(
+	TEXT("monaty.LagComp.MaxRewindMs"),
+	300.0f,
+	TEXT("How far back a client may ask the server to check, in milliseconds."));
+
+/* Capsule history */
+
+float FMonatyCapsuleSample::GetSegmentDistance(const FVector& Start, const FVector& End) const
+{
+	const FVector Center(Location);
+	const FVector Axis(0.0f, 0.0f, FMath::Max(HalfHeight - Radius, 0.0f));
+	FVector OnSegment, OnAxis;
+	FMath::SegmentDistToSegmentSafe(Start, End, Center - Axis, Center + Axis, OnSegment, OnAxis);
+	return FVector::Dist(OnSegment, OnAxis) - Radius;
+}
+
+void FMonatyCapsuleHistory::Init(int32 InMaxCharacters, int32 InMaxFrames)
+{
+	MaxCharacters = FMath::Max(InMaxCharacters, 1);
+	MaxFrames = FMath::Max(InMaxFrames, 2);
+	Head = INDEX_NONE;
+	NumFrames = 0;
+	Samples.Init(FMonatyCapsuleSample(), MaxCharacters * MaxFrames);
+	FrameTimes.Init(0.0, MaxFrames);
+	UsedSlots.Init(false, MaxCharacters);
+}
+
+int32 FMonatyCapsuleHistory::AddCharacter()
+{
+	const int32 Slot = UsedSlots.Find(false);
+	if (Slot != INDEX_NONE)
+	{
+		UsedSlots[Slot] = true;
+		// The slot's old samples belong to someone else.
+		for (int32 Row = 0; Row < MaxFrames; Row++)
+		{
+			Samples[Row * MaxCharacters + Slot] = FMonatyCapsuleSample();
+		}
+	}
+	return Slot;
+}
+
+void FMonatyCapsuleHistory::RemoveCharacter(int32 Slot)
+{
+	if (UsedSlots.IsValidIndex(Slot))
+	{
+		UsedSlots[Slot] = false;
+	}
+}
+
+void FMonatyCapsuleHistory::BeginFrame(double Time)
+{
+	Head = (Head + 1) % MaxFrames;
+	NumFrames = FMath::Min(NumFrames + 1, MaxFrames);
+	FrameTimes[Head] = Time;
+	FMemory::Memzero(&Samples[Head * MaxCharacters], MaxCharacters * sizeof(FMonatyCapsuleSample));
+}
+
+void FMonatyCapsuleHistory::Record(int32 Slot, const FMonatyCapsuleSample& Sample)
+{
+	check(Head != INDEX_NONE && UsedSlots[Slot]);
+	Samples[Head * MaxCharacters + Slot] = Sample;
+}
+
+double FMonatyCapsuleHistory::GetOldestTime() const
+{
+	return NumFrames > 0 ? FrameTimes[GetRow(NumFrames - 1)] : 0.0;
+}
+
+double FMonatyCapsuleHistory::GetNewestTime() const
+{
+	return NumFrames > 0 ? FrameTimes[Head] : 0.0;
+}
+
+bool FMonatyCapsuleHistory::FindFrames(double Time, int32& OutOlder, int32& OutNewer, float& OutAlpha) const
+{
+	if (NumFrames == 0 || Time < GetOldestTime() || Time > GetNewestTime())
+	{
+		return false;
+	}
+	// Binary search by age, times get older as the age grows.
+	int32 Low = 0;
+	int32 High = NumFrames - 1;
+	while (High - Low > 1)
+	{
+		const int32 Middle = (Low + High) / 2;
+		if (FrameTimes[GetRow(Middle)] >= Time)
+		{
+			Low = Middle;
+		}
+		else
+		{
+			High = Middle;
+		}
+	}
+	OutNewer = GetRow(Low);
+	OutOlder = GetRow(High);
+	const double Span = FrameTimes[OutNewer] - FrameTimes[OutOlder];
+	OutAlpha = Span > 0.0 ? FMath::Clamp(static_cast<float>((Time - FrameTimes[OutOlder]) / Span), 0.0f, 1.0f) : 1.0f;
+	return true;
+}
+
+bool FMonatyCapsuleHistory::Rewind(int32 Slot, double Time, FMonatyCapsuleSample& OutSample) const
+{
+	int32 Older, Newer;
+	float Alpha;
+	if (!UsedSlots.IsValidIndex(Slot) || !UsedSlots[Slot] || !FindFrames(Time, Older, Newer, Alpha))
+	{
+		return false;
+	}
+	const FMonatyCapsuleSample& OlderSample = Samples[Older * MaxCharacters + Slot];
+	const FMonatyCapsuleSample& NewerSample = Samples[Newer * MaxCharacters + Slot];
+	if (!OlderSample.IsValid() || !NewerSample.IsValid())
+	{
+		return false;
+	}
+	OutSample = Lerp(OlderSample, NewerSample, Alpha);
+	return true;
+}
+
+FMonatyCapsuleSample FMonatyCapsuleHistory::Lerp(const FMonatyCapsuleSample& A, const FMonatyCapsuleSample& B,
+                                                 float Alpha)
+{
+	FMonatyCapsuleSample Result;
+	Result.Location = FMath::Lerp(A.Location, B.Location, Alpha);
+	Result.Yaw = A.Yaw + FMath::FindDeltaAngleDegrees(A.Yaw, B.Yaw) * Alpha;
+	Result.Radius = FMath::Lerp(A.Radius, B.Radius, Alpha);
+	Result.HalfHeight = FMath::Lerp(A.HalfHeight, B.HalfHeight, Alpha);
+	return Result;
+}
+
+/* Subsystem */
+
+bool UMonatyLagCompensationSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && World->GetNetMode() != NM_Client && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UMonatyLagCompensationSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	History.Init(CVarLagCompMaxCharacters.GetValueOnGameThread(), CVarLagCompFrames.GetValueOnGameThread());
+	SlotCharacters.SetNum(History.GetMaxCharacters());
+}
+
+TStatId UMonatyLagCompensationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMonatyLagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+void UMonatyLagCompensationSubsystem::RegisterCharacter(ACharacter* Character)
+{
+	if (!Character || CharacterSlots.Contains(Character))
+	{
+		return;
+	}
+	const int32 Slot = History.AddCharacter();
+	if (Slot == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Warning,
+		       TEXT("UMonatyLagCompensationSubsystem::RegisterCharacter | History is full, %s is not compensated!"),
+		       *Character->GetName());
+		return;
+	}
+	SlotCharacters[Slot] = Character;
+	CharacterSlots.Add(Character, Slot);
+}
+
+void UMonatyLagCompensationSubsystem::UnregisterCharacter(ACharacter* Character)
+{
+	int32 Slot = INDEX_NONE;
+	if (CharacterSlots.RemoveAndCopyValue(Character, Slot))
+	{
+		History.RemoveCharacter(Slot);
+		SlotCharacters[Slot].Reset();
+	}
+}
+
+void UMonatyLagCompensationSubsystem::Tick(float DeltaTime)
+{
+	MONATY_SCOPED_STAT(STAT_MonatyLagCompRecord);
+
+	History.BeginFrame(GetWorld()->GetTimeSeconds());
+	for (const TPair<TObjectKey<ACharacter>, int32>& Pair : CharacterSlots)
+	{
+		const ACharacter* Character = SlotCharacters[Pair.Value].Get();
+		// Hidden characters are parked in the pool and can't be hit.
+		if (!Character || Character->IsHidden())
+		{
+			continue;
+		}
+		const UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+		FMonatyCapsuleSample Sample;
+		Sample.Location = FVector3f(Capsule->GetComponentLocation());
+		Sample.Yaw = Character->GetActorRotation().Yaw;
+		Sample.Radius = Capsule->GetScaledCapsuleRadius();
+		Sample.HalfHeight = Capsule->GetScaledCapsuleHalfHeight();
+		History.Record(Pair.Value, Sample);
+	}
+}
+
+double UMonatyLagCompensationSubsystem::GetRewindTime(double ClientTime) const
+{
+	const double MaxRewindSeconds = CVarLagCompMaxRewindMs.GetValueOnGameThread() / 1000.0;
+	const double Newest = History.GetNewestTime();
+	return FMath::Clamp(ClientTime, FMath::Max(History.GetOldestTime(), Newest - MaxRewindSeconds), Newest);
+}
+
+bool UMonatyLagCompensationSubsystem::RewindCharacter(const ACharacter* Character, double Time,
+                                                      FMonatyCapsuleSample& OutSample) const
+{
+	const int32* Slot = CharacterSlots.Find(Character);
+	return Slot && History.Rewind(*Slot, Time, OutSample);
+}
+
+int32 UMonatyLagCompensationSubsystem::OverlapSphere(double Time, const FVector& Center, float Radius,
+                                                     TArray<ACharacter*>& OutCharacters,
+                                                     const AActor* IgnoreActor) const
+{
+	MONATY_SCOPED_STAT(STAT_MonatyLagCompQuery);
+
+	const int32 PreviousNum = OutCharacters.Num();
+	History.ForEachAt(Time, [&](int32 Slot, const FMonatyCapsuleSample& Sample)
+	{
+		ACharacter* Character = SlotCharacters[Slot].Get();
+		if (Character && Character != IgnoreActor && Sample.GetSegmentDistance(Center, Center) < Radius)
+		{
+			OutCharacters.Add(Character);
+		}
+	});
+	return OutCharacters.Num() - PreviousNum;
+}
+
+ACharacter* UMonatyLagCompensationSubsystem::LineTrace(double Time, const FVector& Start, const FVector& End,
+                                                       const AActor* IgnoreActor) const
+{
+	MONATY_SCOPED_STAT(STAT_MonatyLagCompQuery);
+
+	ACharacter* Closest = nullptr;
+	float ClosestDistanceSquared = TNumericLimits<float>::Max();
+	History.ForEachAt(Time, [&](int32 Slot, const FMonatyCapsuleSample& Sample)
+	{
+		ACharacter* Character = SlotCharacters[Slot].Get();
+		if (!Character || Character == IgnoreActor || Sample.GetSegmentDistance(Start, End) > 0.0f)
+		{
+			return;
+		}
+		// Good enough ordering for characters, which don't overlap each other.
+		const float DistanceSquared = FVector::DistSquared(Start, FVector(Sample.Location));
+		if (DistanceSquared < ClosestDistanceSquared)
+		{
+			ClosestDistanceSquared = DistanceSquared;
+			Closest = Character;
+		}
+	});
+	return Closest;
+}
+
+/* Benchmark */
+
+static FAutoConsoleCommand LagCompensationBenchmarkCommand(
+	TEXT("Monaty.Bench.LagComp"),
+	TEXT("Benchmarks the lag compensation history with synthetic players. Usage: Monaty.Bench.LagComp [Players] [batches=N]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		int32 Players = 100;
+		int32 Batches = 200;
+		for (const FString& Arg : Args)
+		{
+			if (Arg.StartsWith(TEXT("batches=")))
+			{
+				Batches = FMath::Max(FCString::Atoi(*Arg.RightChop(8)), 1);
+			}
+			else if (Arg.IsNumeric())
+			{
+				Players = FMath::Max(FCString::Atoi(*Arg), 1);
+			}
+		}
+
+		// Players walking around a 100 m square at a 60 Hz server tick.
+		constexpr int32 QueriesPerBatch = 100;
+		constexpr double TickSeconds = 1.0 / 60.0;
+		const int32 Frames = CVarLagCompFrames.GetValueOnGameThread();
+		FRandomStream Random(Players);
+		FMonatyCapsuleHistory History;
+		History.Init(Players, Frames);
+		TArray<FMonatyCapsuleSample> Current;
+		Current.SetNum(Players);
+		for (FMonatyCapsuleSample& Sample : Current)
+		{
+			History.AddCharacter();
+			Sample.Location = FVector3f(Random.FRandRange(-5000.0f, 5000.0f), Random.FRandRange(-5000.0f, 5000.0f), 90.0f);
+			Sample.Radius = 35.0f;
+			Sample.HalfHeight = 90.0f;
+		}
+		const auto RecordFrame = [&](int32 Frame)
+		{
+			History.BeginFrame(Frame * TickSeconds);
+			for (int32 Slot = 0; Slot < Players; Slot++)
+			{
+				Current[Slot].Location += FVector3f(Random.FRandRange(-10.0f, 10.0f), Random.FRandRange(-10.0f, 10.0f), 0.0f);
+				History.Record(Slot, Current[Slot]);
+			}
+		};
+		int32 Frame = 0;
+		for (; Frame < Frames; Frame++)
+		{
+			RecordFrame(Frame);
+		}
+
+		FMonatyBenchmarkReport Report;
+		Report.Name = FString::Printf(TEXT("LagCompBenchmark-%dp"), Players);
+		FMonatyBenchmarkSeries& RecordUs = Report.AddSeries(TEXT("RecordFrameUs"));
+		FMonatyBenchmarkSeries& RewindNs = Report.AddSeries(TEXT("RewindOneNs"));
+		FMonatyBenchmarkSeries& OverlapNs = Report.AddSeries(TEXT("OverlapSphereAllNs"));
+		FMonatyBenchmarkSeries& TraceNs = Report.AddSeries(TEXT("LineTraceAllNs"));
+		int32 Hits = 0;
+		const auto RandomTime = [&]()
+		{
+			return Random.FRandRange(History.GetOldestTime(), History.GetNewestTime());
+		};
+		for (int32 Batch = 0; Batch < Batches; Batch++)
+		{
+			double StartTime = FPlatformTime::Seconds();
+			RecordFrame(Frame++);
+			RecordUs.Samples.Add((FPlatformTime::Seconds() - StartTime) * 1.0e6);
+
+			StartTime = FPlatformTime::Seconds();
+			for (int32 Query = 0; Query < QueriesPerBatch; Query++)
+			{
+				FMonatyCapsuleSample Sample;
+				Hits += History.Rewind(Random.RandHelper(Players), RandomTime(), Sample) ? 1 : 0;
+			}
+			RewindNs.Samples.Add((FPlatformTime::Seconds() - StartTime) * 1.0e9 / QueriesPerBatch);
+
+			StartTime = FPlatformTime::Seconds();
+			for (int32 Query = 0; Query < QueriesPerBatch; Query++)
+			{
+				const FVector Center = FVector(Current[Random.RandHelper(Players)].Location);
+				History.ForEachAt(RandomTime(), [&](int32 Slot, const FMonatyCapsuleSample& Sample)
+				{
+					Hits += Sample.GetSegmentDistance(Center, Center) < 50.0f ? 1 : 0;
+				});
+			}
+			OverlapNs.Samples.Add((FPlatformTime::Seconds() - StartTime) * 1.0e9 / QueriesPerBatch);
+
+			StartTime = FPlatformTime::Seconds();
+			for (int32 Query = 0; Query < QueriesPerBatch; Query++)
+			{
+				const FVector Start = FVector(Current[Random.RandHelper(Players)].Location);
+				const FVector End = Start + Random.GetUnitVector() * 5000.0f;
+				History.ForEachAt(RandomTime(), [&](int32 Slot, const FMonatyCapsuleSample& Sample)
+				{
+					Hits += Sample.GetSegmentDistance(Start, End) <= 0.0f ? 1 : 0;
+				});
+			}
+			TraceNs.Samples.Add((FPlatformTime::Seconds() - StartTime) * 1.0e9 / QueriesPerBatch);
+		}
+		UE_LOG(LogTemp, Display, TEXT("Monaty.Bench.LagComp | %d players, %d frames, %llu KB of history, %d hits"),
+		       Players, Frames, static_cast<uint64>(History.GetAllocatedSize() / 1024), Hits);
+		Report.SaveCsv();
+	}));
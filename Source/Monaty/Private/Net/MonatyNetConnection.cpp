@@ -0,0 +1,16 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Net/MonatyNetConnection.h"
+
+#include "Net/DataBunch.h"
+
+int32 UMonatyNetConnection::SendRawBunch(FOutBunch& Bunch, bool InAllowMerge, const FNetTraceCollector* BunchCollector)
+{
+	// Large RPCs are split into partial bunches, each comes through here. A bunch merged into the previous one of
+	// the same channel arrives with that one's bits included.
+	if (bCountingRPC)
+	{
+		CountedRPCBits += Bunch.GetNumBits();
+	}
+	return Super::SendRawBunch(Bunch, InAllowMerge, BunchCollector);
+}
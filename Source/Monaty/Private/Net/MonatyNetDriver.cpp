@@ -0,0 +1,50 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Net/MonatyNetDriver.h"
+
+#include "Net/MonatyNetConnection.h"
+#include "Net/MonatyNetStats.h"
+
+void UMonatyNetDriver::ProcessRemoteFunction(AActor* Actor, UFunction* Function, void* Parameters,
+                                             FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject)
+{
+	if (!FMonatyNetStats::IsEnabled())
+	{
+		Super::ProcessRemoteFunction(Actor, Function, Parameters, OutParms, Stack, SubObject);
+		return;
+	}
+
+	// Multicasts go out on every client connection, everything else on the owner's. The connections count the bits
+	// of the bunches the call is written to.
+	TArray<UMonatyNetConnection*, TInlineAllocator<1>> Connections;
+	if (Function->FunctionFlags & FUNC_NetMulticast)
+	{
+		for (UNetConnection* Connection : ClientConnections)
+		{
+			if (UMonatyNetConnection* MonatyConnection = Cast<UMonatyNetConnection>(Connection))
+			{
+				Connections.Add(MonatyConnection);
+			}
+		}
+	}
+	else if (UMonatyNetConnection* Connection = Cast<UMonatyNetConnection>(Actor->GetNetConnection()))
+	{
+		Connections.Add(Connection);
+	}
+	for (UMonatyNetConnection* Connection : Connections)
+	{
+		Connection->bCountingRPC = true;
+		Connection->CountedRPCBits = 0;
+	}
+
+	Super::ProcessRemoteFunction(Actor, Function, Parameters, OutParms, Stack, SubObject);
+
+	// Unreliable multicasts are queued for the next update of the actor, their bits count with it.
+	FMonatyNetStats& NetStats = FMonatyNetStats::Get();
+	const FName FunctionName = NetStats.GetFunctionName(Function);
+	for (UMonatyNetConnection* Connection : Connections)
+	{
+		Connection->bCountingRPC = false;
+		NetStats.Record(EMonatyNetStatKind::RPC, FunctionName, Connection, Connection->CountedRPCBits);
+	}
+}
@@ -0,0 +1,364 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Net/MonatyNetStats.h"
+
+#include "Algo/BinarySearch.h"
+#include "Engine/ActorChannel.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/Actor.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/CoreNet.h"
+
+static TAutoConsoleVariable<bool> CVarNetStats(
+	TEXT("monaty.Net.Stats"),
+	true,
+	TEXT("Count outgoing bytes and calls per RPC and replicated property. Compiled out of shipping builds."));
+
+static const TCHAR* GetKindName(EMonatyNetStatKind Kind)
+{
+	switch (Kind)
+	{
+	case EMonatyNetStatKind::RPC:
+		return TEXT("RPC");
+	case EMonatyNetStatKind::Actor:
+		return TEXT("Actor");
+	case EMonatyNetStatKind::Property:
+		return TEXT("Property");
+	default:
+		return TEXT("Unknown");
+	}
+}
+
+// Whether a property with Condition goes out in a bunch with RepFlags. Custom conditions count as met.
+static bool IsConditionMet(ELifetimeCondition Condition, const FReplicationFlags& RepFlags)
+{
+	switch (Condition)
+	{
+	case COND_InitialOnly:
+		return RepFlags.bNetInitial;
+	case COND_OwnerOnly:
+		return RepFlags.bNetOwner;
+	case COND_SkipOwner:
+		return !RepFlags.bNetOwner;
+	case COND_SimulatedOnly:
+		return RepFlags.bNetSimulated;
+	case COND_AutonomousOnly:
+		return !RepFlags.bNetSimulated;
+	case COND_SimulatedOrPhysics:
+		return RepFlags.bNetSimulated || RepFlags.bRepPhysics;
+	case COND_InitialOrOwner:
+		return RepFlags.bNetInitial || RepFlags.bNetOwner;
+	case COND_ReplayOrOwner:
+		return RepFlags.bReplay || RepFlags.bNetOwner;
+	case COND_ReplayOnly:
+		return RepFlags.bReplay;
+	case COND_SimulatedOnlyNoReplay:
+		return RepFlags.bNetSimulated && !RepFlags.bReplay;
+	case COND_SimulatedOrPhysicsNoReplay:
+		return (RepFlags.bNetSimulated || RepFlags.bRepPhysics) && !RepFlags.bReplay;
+	case COND_SkipReplay:
+		return !RepFlags.bReplay;
+	case COND_Never:
+		return false;
+	default:
+		return true;
+	}
+}
+
+// Writes Value the way the rep layout sends it: plain structs and arrays member by member, everything else through
+// its NetSerialize. Object references stand in as one 32 bit id, about the size of a known NetGUID, the exports of
+// new ones are not counted. Nothing here touches a package map, so measuring never assigns or exports a NetGUID.
+static void SerializePropertyValue(const FProperty* Property, const void* Value, FNetBitWriter& Writer)
+{
+	if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+	{
+		if (!(StructProperty->Struct->StructFlags & STRUCT_NetSerializeNative))
+		{
+			for (TFieldIterator<FProperty> It(StructProperty->Struct); It; ++It)
+			{
+				if (It->PropertyFlags & CPF_RepSkip)
+				{
+					continue;
+				}
+				for (int32 Index = 0; Index < It->ArrayDim; Index++)
+				{
+					SerializePropertyValue(*It, It->ContainerPtrToValuePtr<void>(Value, Index), Writer);
+				}
+			}
+			return;
+		}
+	}
+	else if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+	{
+		FScriptArrayHelper Array(ArrayProperty, Value);
+		uint16 Num = Array.Num();
+		Writer << Num;
+		for (int32 Index = 0; Index < Array.Num(); Index++)
+		{
+			SerializePropertyValue(ArrayProperty->Inner, Array.GetRawPtr(Index), Writer);
+		}
+		return;
+	}
+	else if (const FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(Property))
+	{
+		const UObject* Object = ObjectProperty->GetObjectPropertyValue(Value);
+		uint32 Id = Object ? Object->GetUniqueID() : 0;
+		Writer << Id;
+		return;
+	}
+	else if (CastField<FInterfaceProperty>(Property))
+	{
+		const UObject* Object = static_cast<const FScriptInterface*>(Value)->GetObject();
+		uint32 Id = Object ? Object->GetUniqueID() : 0;
+		Writer << Id;
+		return;
+	}
+	Property->NetSerializeItem(Writer, nullptr, const_cast<void*>(Value));
+}
+
+FMonatyNetStats& FMonatyNetStats::Get()
+{
+	static FMonatyNetStats Instance;
+	return Instance;
+}
+
+bool FMonatyNetStats::IsEnabled()
+{
+#if UE_BUILD_SHIPPING
+	return false;
+#else
+	return CVarNetStats.GetValueOnGameThread();
+#endif
+}
+
+void FMonatyNetStats::Record(EMonatyNetStatKind Kind, FName Name, const UNetConnection* Connection, int64 Bits)
+{
+	const double Now = FPlatformTime::Seconds();
+	if (StartTime == 0.0)
+	{
+		StartTime = Now;
+		SecondStartTime = Now;
+	}
+	if (Now - SecondStartTime >= 1.0)
+	{
+		RollSecond(Now);
+	}
+
+	const uint32 ConnectionId = Connection ? Connection->GetConnectionId() : 0;
+	if (Connection && !ConnectionNames.Contains(ConnectionId))
+	{
+		ConnectionNames.Add(ConnectionId, Connection->LowLevelGetRemoteAddress(true));
+	}
+	const FMonatyNetStatKey Key = {ConnectionId, Kind, Name};
+	for (FMonatyNetStatEntry* Entry : {&Totals.FindOrAdd(Key), &CurrentSecond.FindOrAdd(Key)})
+	{
+		Entry->Calls++;
+		Entry->Bits += FMath::Max<int64>(Bits, 0);
+	}
+}
+
+void FMonatyNetStats::RecordProperties(const AActor* Actor, UActorChannel* Channel, const FReplicationFlags& RepFlags)
+{
+	const TArray<FPropertyLayout>& Layout = GetPropertyLayout(Actor->GetClass());
+	// Channels are pooled, the first bunch of every actor starts over from the class defaults.
+	TArray<FPropertyValue>& Values = ChannelValues.FindOrAdd(Channel);
+	if (RepFlags.bNetInitial || Values.Num() != Layout.Num())
+	{
+		Values.Reset(Layout.Num());
+		for (const FPropertyLayout& Property : Layout)
+		{
+			Values.Add({Property.DefaultValue, Property.DefaultBits});
+		}
+	}
+
+	FNetBitWriter Writer(nullptr, 256);
+	for (int32 Index = 0; Index < Layout.Num(); Index++)
+	{
+		const FPropertyLayout& Property = Layout[Index];
+		if (!IsConditionMet(Property.Condition, RepFlags))
+		{
+			continue;
+		}
+		Writer.Reset();
+		SerializePropertyValue(Property.Property, Property.Property->ContainerPtrToValuePtr<void>(Actor,
+			                       Property.ArrayIndex), Writer);
+		FPropertyValue& Sent = Values[Index];
+		if (Sent.Bits == Writer.GetNumBits() && FMemory::Memcmp(Sent.Value.GetData(), Writer.GetData(),
+		                                                        Writer.GetNumBytes()) == 0)
+		{
+			continue;
+		}
+		Sent.Value = TArray<uint8>(Writer.GetData(), Writer.GetNumBytes());
+		Sent.Bits = Writer.GetNumBits();
+		Record(EMonatyNetStatKind::Property, Property.Name, Channel->Connection, Sent.Bits);
+	}
+}
+
+const TArray<FMonatyNetStats::FPropertyLayout>& FMonatyNetStats::GetPropertyLayout(const UClass* Class)
+{
+	if (const TArray<FPropertyLayout>* Found = PropertyLayouts.Find(Class))
+	{
+		return *Found;
+	}
+
+	const UObject* Defaults = Class->GetDefaultObject();
+	TArray<FLifetimeProperty> LifetimeProperties;
+	Defaults->GetLifetimeReplicatedProps(LifetimeProperties);
+	TArray<FPropertyLayout>& Layout = PropertyLayouts.Add(Class);
+	FNetBitWriter Writer(nullptr, 256);
+	for (const FLifetimeProperty& LifetimeProperty : LifetimeProperties)
+	{
+		if (!Class->ClassReps.IsValidIndex(LifetimeProperty.RepIndex))
+		{
+			continue;
+		}
+		const FRepRecord& Rep = Class->ClassReps[LifetimeProperty.RepIndex];
+		FPropertyLayout& Property = Layout.AddDefaulted_GetRef();
+		Property.Property = Rep.Property;
+		Property.ArrayIndex = Rep.Index;
+		Property.Condition = LifetimeProperty.Condition;
+		Property.Name = Rep.Property->ArrayDim > 1
+			                ? FName(*FString::Printf(TEXT("%s::%s[%d]"), *Class->GetName(), *Rep.Property->GetName(),
+			                                         Rep.Index))
+			                : FName(*FString::Printf(TEXT("%s::%s"), *Class->GetName(), *Rep.Property->GetName()));
+		Writer.Reset();
+		SerializePropertyValue(Rep.Property, Rep.Property->ContainerPtrToValuePtr<void>(Defaults, Rep.Index), Writer);
+		Property.DefaultValue = TArray<uint8>(Writer.GetData(), Writer.GetNumBytes());
+		Property.DefaultBits = Writer.GetNumBits();
+	}
+	return Layout;
+}
+
+FName FMonatyNetStats::GetFunctionName(const UFunction* Function)
+{
+	if (const FName* Found = FunctionNames.Find(Function))
+	{
+		return *Found;
+	}
+	const FName Name(*FString::Printf(TEXT("%s::%s"), *Function->GetOuterUClass()->GetName(), *Function->GetName()));
+	FunctionNames.Add(Function, Name);
+	return Name;
+}
+
+void FMonatyNetStats::RollSecond(double Now)
+{
+	for (const TPair<FMonatyNetStatKey, FMonatyNetStatEntry>& Pair : CurrentSecond)
+	{
+		History.Add({SecondIndex, Pair.Key, Pair.Value});
+	}
+	LastSecond = MoveTemp(CurrentSecond);
+	CurrentSecond.Reset();
+	// Gaps without traffic still count as seconds.
+	SecondIndex += FMath::Max(1, FMath::FloorToInt(Now - SecondStartTime));
+	SecondStartTime = Now;
+
+	for (auto It = ChannelValues.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	// Drop the oldest seconds, the history is sorted by second.
+	const int32 OldestSecond = SecondIndex - MaxHistorySeconds;
+	const int32 FirstKept = Algo::LowerBoundBy(History, OldestSecond, &FSecondRow::Second);
+	if (FirstKept > 0)
+	{
+		History.RemoveAt(0, FirstKept, false);
+	}
+}
+
+void FMonatyNetStats::Reset()
+{
+	Totals.Reset();
+	CurrentSecond.Reset();
+	LastSecond.Reset();
+	History.Reset();
+	ChannelValues.Reset();
+	StartTime = 0.0;
+	SecondIndex = 0;
+}
+
+void FMonatyNetStats::Print(FOutputDevice& Ar, int32 MaxRows)
+{
+	// Sum the connections, the CSV has the per connection split.
+	TMap<TPair<EMonatyNetStatKind, FName>, TPair<FMonatyNetStatEntry, FMonatyNetStatEntry>> Rows;
+	for (const TPair<FMonatyNetStatKey, FMonatyNetStatEntry>& Pair : Totals)
+	{
+		FMonatyNetStatEntry& Total = Rows.FindOrAdd({Pair.Key.Kind, Pair.Key.Name}).Key;
+		Total.Calls += Pair.Value.Calls;
+		Total.Bits += Pair.Value.Bits;
+	}
+	for (const TPair<FMonatyNetStatKey, FMonatyNetStatEntry>& Pair : LastSecond)
+	{
+		FMonatyNetStatEntry& PerSecond = Rows.FindOrAdd({Pair.Key.Kind, Pair.Key.Name}).Value;
+		PerSecond.Calls += Pair.Value.Calls;
+		PerSecond.Bits += Pair.Value.Bits;
+	}
+	Rows.ValueSort([](const TPair<FMonatyNetStatEntry, FMonatyNetStatEntry>& A,
+	                  const TPair<FMonatyNetStatEntry, FMonatyNetStatEntry>& B)
+	{
+		return A.Key.Bits > B.Key.Bits;
+	});
+
+	const double Elapsed = StartTime > 0.0 ? FPlatformTime::Seconds() - StartTime : 0.0;
+	Ar.Logf(TEXT("Monaty net stats over %.1f s, %d connections"), Elapsed, ConnectionNames.Num());
+	Ar.Logf(TEXT("%-8s %-60s %10s %12s %10s %12s"), TEXT("Kind"), TEXT("Name"), TEXT("Calls"), TEXT("Bytes"),
+	        TEXT("Calls/s"), TEXT("Bytes/s"));
+	int32 RowCount = 0;
+	for (const auto& Row : Rows)
+	{
+		if (RowCount++ >= MaxRows)
+		{
+			break;
+		}
+		Ar.Logf(TEXT("%-8s %-60s %10llu %12llu %10llu %12llu"), GetKindName(Row.Key.Key), *Row.Key.Value.ToString(),
+		        Row.Value.Key.Calls, Row.Value.Key.Bits / 8, Row.Value.Value.Calls, Row.Value.Value.Bits / 8);
+	}
+}
+
+bool FMonatyNetStats::DumpCsv(const FString& FilePath)
+{
+	FString Csv = TEXT("Second,Connection,Kind,Name,Calls,Bytes\n");
+	for (const FSecondRow& Row : History)
+	{
+		const FString* ConnectionName = ConnectionNames.Find(Row.Key.ConnectionId);
+		Csv += FString::Printf(TEXT("%d,%s,%s,%s,%llu,%llu\n"), Row.Second,
+		                       ConnectionName ? **ConnectionName : TEXT("None"), GetKindName(Row.Key.Kind),
+		                       *Row.Key.Name.ToString(), Row.Entry.Calls, Row.Entry.Bits / 8);
+	}
+	return FFileHelper::SaveStringToFile(Csv, *FilePath);
+}
+
+static FAutoConsoleCommandWithOutputDevice PrintNetStatsCommand(
+	TEXT("Monaty.Net.Print"),
+	TEXT("Prints bytes and calls per RPC and replicated property, in total and over the last second."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+	{
+		FMonatyNetStats::Get().Print(Ar, 50);
+	}));
+
+static FAutoConsoleCommand DumpNetStatsCsvCommand(
+	TEXT("Monaty.Net.DumpCsv"),
+	TEXT("Dumps the per second, per connection net stats to CSV. Usage: Monaty.Net.DumpCsv [File]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString FilePath = Args.Num() > 0
+			                         ? Args[0]
+			                         : FPaths::ProfilingDir() / TEXT("Monaty") /
+			                         FString::Printf(TEXT("MonatyNetStats-%s.csv"), *FDateTime::Now().ToString());
+		const bool bSaved = FMonatyNetStats::Get().DumpCsv(FilePath);
+		UE_LOG(LogTemp, Display, TEXT("Monaty.Net.DumpCsv | %s %s"), bSaved ? TEXT("Saved") : TEXT("Could not save"),
+		       *FilePath);
+	}));
+
+static FAutoConsoleCommand ResetNetStatsCommand(
+	TEXT("Monaty.Net.Reset"),
+	TEXT("Clears the Monaty net stats."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FMonatyNetStats::Get().Reset();
+	}));
@@ -0,0 +1,195 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Net/MonatyReplicationGraph.h"
+
+#include "Engine/LevelScriptActor.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/Info.h"
+#include "GameFramework/PlayerController.h"
+#include "Placeables/PlaceableActor.h"
+#include "Placeables/PlacedActor.h"
+#include "Profiling/MonatyBenchmark.h"
+#include "Profiling/MonatyStats.h"
+
+void UMonatyReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	// Explicit routes, every other class inherits from its closest parent in here.
+	ClassRoutes.Reset();
+	ClassRoutes.Add(AActor::StaticClass(), EMonatyReplicationRoute::SpatializeDynamic);
+	ClassRoutes.Add(AInfo::StaticClass(), EMonatyReplicationRoute::AlwaysRelevant);
+	ClassRoutes.Add(APlayerController::StaticClass(), EMonatyReplicationRoute::NotRouted);
+	ClassRoutes.Add(ALevelScriptActor::StaticClass(), EMonatyReplicationRoute::NotRouted);
+	ClassRoutes.Add(ACharacter::StaticClass(), EMonatyReplicationRoute::SpatializeDynamic);
+	ClassRoutes.Add(APlacedActor::StaticClass(), EMonatyReplicationRoute::SpatializeDormancy);
+	// The placement preview only exists on the placing client.
+	ClassRoutes.Add(APlaceableActor::StaticClass(), EMonatyReplicationRoute::NotRouted);
+
+	SetClassInfo(AActor::StaticClass(), true);
+	SetClassInfo(AInfo::StaticClass(), false);
+	SetClassInfo(ACharacter::StaticClass(), true);
+	SetClassInfo(APlacedActor::StaticClass(), true, PlacedActorCullDistance);
+}
+
+void UMonatyReplicationGraph::SetClassInfo(UClass* Class, bool bSpatialize, float CullDistance)
+{
+	const AActor* ActorCDO = Class->GetDefaultObject<AActor>();
+	FClassReplicationInfo ClassInfo;
+	if (bSpatialize)
+	{
+		ClassInfo.SetCullDistanceSquared(CullDistance > 0.0f
+			                                 ? FMath::Square(CullDistance)
+			                                 : ActorCDO->NetCullDistanceSquared);
+	}
+	ClassInfo.ReplicationPeriodFrame = FMath::Max<uint32>(
+		FMath::RoundToInt(NetDriver->NetServerMaxTickRate / ActorCDO->NetUpdateFrequency), 1);
+	GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+}
+
+EMonatyReplicationRoute UMonatyReplicationGraph::GetRouteForClass(UClass* Class)
+{
+	if (const EMonatyReplicationRoute* Found = ClassRoutes.Find(Class))
+	{
+		return *Found;
+	}
+	EMonatyReplicationRoute Route = GetRouteForClass(Class->GetSuperClass());
+	// Relevancy flags set on the class itself win over the inherited route.
+	const AActor* ActorCDO = Class->GetDefaultObject<AActor>();
+	if (Route != EMonatyReplicationRoute::NotRouted)
+	{
+		if (ActorCDO->bAlwaysRelevant)
+		{
+			Route = EMonatyReplicationRoute::AlwaysRelevant;
+		}
+		else if (ActorCDO->bOnlyRelevantToOwner)
+		{
+			Route = EMonatyReplicationRoute::OwnerRelevant;
+		}
+		else if (Route == EMonatyReplicationRoute::SpatializeDynamic && ActorCDO->NetDormancy > DORM_Awake)
+		{
+			Route = EMonatyReplicationRoute::SpatializeDormancy;
+		}
+	}
+	ClassRoutes.Add(Class, Route);
+	return Route;
+}
+
+void UMonatyReplicationGraph::InitGlobalGraphNodes()
+{
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = GridCellSize;
+	GridNode->SpatialBias = GridSpatialBias;
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UMonatyReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	// Also gathers the connection's own controller and view target.
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* OwnerNode = CreateNewNode<
+		UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(OwnerNode, RepGraphConnection);
+	OwnerRelevantNodes.Add(RepGraphConnection->NetConnection, OwnerNode);
+}
+
+void UMonatyReplicationGraph::RemoveClientConnection(UNetConnection* NetConnection)
+{
+	OwnerRelevantNodes.Remove(NetConnection);
+	Super::RemoveClientConnection(NetConnection);
+}
+
+void UMonatyReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo,
+                                                          FGlobalActorReplicationInfo& GlobalInfo)
+{
+	switch (GetRouteForClass(ActorInfo.Class))
+	{
+	case EMonatyReplicationRoute::AlwaysRelevant:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+	case EMonatyReplicationRoute::OwnerRelevant:
+		if (UReplicationGraphNode_AlwaysRelevant_ForConnection* OwnerNode = OwnerRelevantNodes.FindRef(
+			ActorInfo.Actor->GetNetConnection()))
+		{
+			OwnerNode->NotifyAddNetworkActor(ActorInfo);
+		}
+		else
+		{
+			// Not possessed or owned yet, e.g. a pawn spawned before its controller takes it.
+			ActorsWithoutNetConnection.Add(ActorInfo.Actor);
+		}
+		break;
+	case EMonatyReplicationRoute::SpatializeStatic:
+		GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+		break;
+	case EMonatyReplicationRoute::SpatializeDynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+	case EMonatyReplicationRoute::SpatializeDormancy:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+	default:
+		break;
+	}
+}
+
+void UMonatyReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	switch (GetRouteForClass(ActorInfo.Class))
+	{
+	case EMonatyReplicationRoute::AlwaysRelevant:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+	case EMonatyReplicationRoute::OwnerRelevant:
+		ActorsWithoutNetConnection.RemoveSingleSwap(ActorInfo.Actor, false);
+		// The owner may already be gone, so look in every connection.
+		for (const TPair<UNetConnection*, UReplicationGraphNode_AlwaysRelevant_ForConnection*>& Pair :
+		     OwnerRelevantNodes)
+		{
+			Pair.Value->NotifyRemoveNetworkActor(ActorInfo, false);
+		}
+		break;
+	case EMonatyReplicationRoute::SpatializeStatic:
+		GridNode->RemoveActor_Static(ActorInfo);
+		break;
+	case EMonatyReplicationRoute::SpatializeDynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+	case EMonatyReplicationRoute::SpatializeDormancy:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+	default:
+		break;
+	}
+}
+
+int32 UMonatyReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+	MONATY_SCOPED_STAT(STAT_MonatyReplicateActors);
+	MONATY_BENCHMARK_SCOPE(ServerReplicateActors);
+	RouteActorsWithoutNetConnection();
+	return Super::ServerReplicateActors(DeltaSeconds);
+}
+
+void UMonatyReplicationGraph::RouteActorsWithoutNetConnection()
+{
+	for (int32 Index = ActorsWithoutNetConnection.Num() - 1; Index >= 0; Index--)
+	{
+		AActor* Actor = ActorsWithoutNetConnection[Index];
+		if (!IsValid(Actor))
+		{
+			ActorsWithoutNetConnection.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+		if (UReplicationGraphNode_AlwaysRelevant_ForConnection* OwnerNode = OwnerRelevantNodes.FindRef(
+			Actor->GetNetConnection()))
+		{
+			OwnerNode->NotifyAddNetworkActor(FNewReplicatedActorInfo(Actor));
+			ActorsWithoutNetConnection.RemoveAtSwap(Index, 1, false);
+		}
+	}
+}
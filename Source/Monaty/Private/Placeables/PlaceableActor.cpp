@@ -6,8 +6,8 @@
 // Sets default values
 APlaceableActor::APlaceableActor()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	// The preview only moves when the placeables component moves it.
+	PrimaryActorTick.bCanEverTick = false;
 
 	PlaceableRootComponent = CreateDefaultSubobject<USceneComponent>("RootComponent");
 	SetRootComponent(PlaceableRootComponent);
@@ -26,13 +26,6 @@ void APlaceableActor::BeginPlay()
 	
 }
 
-// Called every frame
-void APlaceableActor::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-}
-
 void APlaceableActor::InitializeCollisionResponses() const
 {
 	PlaceableMeshComponent->SetCollisionProfileName("OverlapAll");
@@ -0,0 +1,128 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Placeables/PlaceableSnapIndex.h"
+
+// Points closer than this are treated as the same socket.
+static constexpr float SnapMatchTolerance = 1.0f;
+
+FIntVector FPlaceableSnapIndex::GetCell(const FVector& Location) const
+{
+	return FIntVector(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize),
+	                  FMath::FloorToInt(Location.Z / CellSize));
+}
+
+void FPlaceableSnapIndex::AddToCell(int32 EntryIndex)
+{
+	Cells.FindOrAdd(GetCell(Entries[EntryIndex].Location)).Add(EntryIndex);
+}
+
+void FPlaceableSnapIndex::RemoveFromCell(int32 EntryIndex)
+{
+	const FIntVector Cell = GetCell(Entries[EntryIndex].Location);
+	if (TArray<int32>* CellEntries = Cells.Find(Cell))
+	{
+		CellEntries->RemoveSingleSwap(EntryIndex, false);
+		if (CellEntries->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+void FPlaceableSnapIndex::AddActor(const AActor* Actor, const TArray<FPlaceableSnapPoint>& Points)
+{
+	if (!Actor || Points.Num() == 0)
+	{
+		return;
+	}
+	const FTransform& ActorTransform = Actor->GetActorTransform();
+	TArray<int32>& OwnedEntries = ActorEntries.FindOrAdd(Actor);
+	for (const FPlaceableSnapPoint& Point : Points)
+	{
+		FEntry Entry;
+		Entry.Owner = Actor;
+		Entry.Point = Point;
+		Entry.Location = ActorTransform.TransformPosition(Point.LocalOffset);
+		Entry.Rotation = ActorTransform.GetRotation() * FQuat(FVector::UpVector, FMath::DegreesToRadians(Point.LocalYaw));
+		const int32 EntryIndex = Entries.Add(MoveTemp(Entry));
+		OwnedEntries.Add(EntryIndex);
+
+		// A free socket of a neighbour in the same spot means the two are snapped together, neither is free anymore.
+		const int32 MatchIndex = FindNearest(Entries[EntryIndex].Location, SnapMatchTolerance, Point);
+		if (MatchIndex != INDEX_NONE && Entries[MatchIndex].Owner != Entries[EntryIndex].Owner)
+		{
+			RemoveFromCell(MatchIndex);
+			Entries[MatchIndex].OccupiedBy = EntryIndex;
+			Entries[EntryIndex].OccupiedBy = MatchIndex;
+			continue;
+		}
+		AddToCell(EntryIndex);
+	}
+}
+
+void FPlaceableSnapIndex::RemoveActor(const AActor* Actor)
+{
+	TArray<int32> OwnedEntries;
+	if (!ActorEntries.RemoveAndCopyValue(Actor, OwnedEntries))
+	{
+		return;
+	}
+	for (const int32 EntryIndex : OwnedEntries)
+	{
+		const int32 PartnerIndex = Entries[EntryIndex].OccupiedBy;
+		if (PartnerIndex == INDEX_NONE)
+		{
+			RemoveFromCell(EntryIndex);
+		}
+		else if (Entries.IsValidIndex(PartnerIndex))
+		{
+			// The neighbour's socket is free again.
+			Entries[PartnerIndex].OccupiedBy = INDEX_NONE;
+			AddToCell(PartnerIndex);
+		}
+		Entries.RemoveAt(EntryIndex);
+	}
+}
+
+int32 FPlaceableSnapIndex::FindNearest(const FVector& Location, float Radius, const FPlaceableSnapPoint& Point) const
+{
+	const FIntVector MinCell = GetCell(Location - FVector(Radius));
+	const FIntVector MaxCell = GetCell(Location + FVector(Radius));
+	int32 BestIndex = INDEX_NONE;
+	double BestDistanceSquared = FMath::Square(Radius);
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+			{
+				const TArray<int32>* CellEntries = Cells.Find(FIntVector(X, Y, Z));
+				if (!CellEntries)
+				{
+					continue;
+				}
+				for (const int32 EntryIndex : *CellEntries)
+				{
+					const FEntry& Entry = Entries[EntryIndex];
+					const double DistanceSquared = FVector::DistSquared(Entry.Location, Location);
+					if (DistanceSquared <= BestDistanceSquared && Point.IsCompatibleWith(Entry.Point))
+					{
+						BestDistanceSquared = DistanceSquared;
+						BestIndex = EntryIndex;
+					}
+				}
+			}
+		}
+	}
+	return BestIndex;
+}
+
+int32 FPlaceableSnapIndex::GetNumFree() const
+{
+	int32 NumFree = 0;
+	for (const TPair<FIntVector, TArray<int32>>& Cell : Cells)
+	{
+		NumFree += Cell.Value.Num();
+	}
+	return NumFree;
+}
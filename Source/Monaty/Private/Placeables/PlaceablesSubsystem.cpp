@@ -0,0 +1,1008 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Placeables/PlaceablesSubsystem.h"
+
+#include "AI/NavigationSystemBase.h"
+#include "Components/PlaceablesComponent.h"
+#include "EngineUtils.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/FileManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/Paths.h"
+#include "Placeables/PlacedActor.h"
+#include "Placeables/PlacementOwnedRegion.h"
+#include "Placeables/PlacementRemovals.h"
+#include "Profiling/MonatyStats.h"
+
+static TAutoConsoleVariable<float> CVarRestoreBudgetMs(
+	TEXT("monaty.Placeables.RestoreBudgetMs"),
+	2.0f,
+	TEXT("Milliseconds per frame spent spawning restored placements."));
+
+static TAutoConsoleVariable<bool> CVarAutosave(
+	TEXT("monaty.Placeables.Autosave"),
+	false,
+	TEXT("Journal placement changes to Saved/Placements on the server, and recover them when the world starts."));
+
+static TAutoConsoleVariable<float> CVarAutosaveInterval(
+	TEXT("monaty.Placeables.AutosaveInterval"),
+	5.0f,
+	TEXT("Seconds between handing dirty placements to the autosave writer."));
+
+AActor* UPlaceablesSubsystem::SpawnPlacedActor(TSubclassOf<AActor> PlacedActorClass, const FTransform& Transform,
+                                               uint32 OwnerId, uint32 PlacementId)
+{
+	if (!PlacedActorClass)
+	{
+		return nullptr;
+	}
+	// Deferred, so the owner is set before BeginPlay registers the placement.
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.bDeferConstruction = true;
+	AActor* PlacedActor = GetWorld()->SpawnActor<AActor>(PlacedActorClass, Transform, SpawnParameters);
+	if (PlacedActor)
+	{
+		APlacedActor* Placed = Cast<APlacedActor>(PlacedActor);
+		if (Placed)
+		{
+			Placed->PlacementOwnerId = OwnerId;
+		}
+		PlacedActor->FinishSpawning(Transform);
+		if (!IsValid(PlacedActor))
+		{
+			return nullptr;
+		}
+		MONATY_INC_COUNTER(STAT_MonatySpawns, Spawns, 1);
+		PlacedActor->OnDestroyed.AddDynamic(this, &UPlaceablesSubsystem::OnPlacedActorDestroyed);
+		// Placed actors register themselves in BeginPlay.
+		if (!Placed)
+		{
+			PlacementIndex.Add(PlacedActor, OwnerId);
+		}
+
+		if (PlacementId == 0)
+		{
+			PlacementIds.Add(PlacedActor, NextPlacementId++);
+			MarkPlacementDirty(PlacedActor);
+		}
+		else
+		{
+			PlacementIds.Add(PlacedActor, PlacementId);
+			NextPlacementId = FMath::Max(NextPlacementId, PlacementId + 1);
+		}
+	}
+	return PlacedActor;
+}
+
+void UPlaceablesSubsystem::RegisterPlacedActor(APlacedActor* PlacedActor)
+{
+	SnapIndex.AddActor(PlacedActor, PlacedActor->SnapPoints);
+	PlacementIndex.Add(PlacedActor, PlacedActor->PlacementOwnerId);
+}
+
+void UPlaceablesSubsystem::UnregisterPlacedActor(const APlacedActor* PlacedActor)
+{
+	SnapIndex.RemoveActor(PlacedActor);
+	PlacementIndex.Remove(PlacedActor);
+}
+
+uint32 UPlaceablesSubsystem::GetOwnerId(const APlayerState* PlayerState)
+{
+	if (!PlayerState)
+	{
+		return 0;
+	}
+	// Without an online subsystem there is no unique id, the player id at least holds for the session.
+	const FUniqueNetIdRepl& UniqueId = PlayerState->GetUniqueId();
+	const uint32 OwnerId = UniqueId.IsValid()
+		                       ? FCrc::StrCrc32(*UniqueId.ToString())
+		                       : static_cast<uint32>(PlayerState->GetPlayerId()) + 1;
+	// 0 means nobody.
+	return OwnerId != 0 ? OwnerId : 1;
+}
+
+int32 UPlaceablesSubsystem::QueryPlacements(const FPlacementQuery& Query, TArray<AActor*>& OutActors)
+{
+	MONATY_SCOPED_STAT(STAT_MonatyPlacementQuery);
+	const int32 StartNum = OutActors.Num();
+	PlacementIndex.ForEach(Query, [&OutActors](int32 EntryIndex, const FPlacementSpatialIndex::FEntry& Entry)
+	{
+		if (AActor* Actor = Entry.Actor.Get())
+		{
+			OutActors.Add(Actor);
+		}
+	});
+	return OutActors.Num() - StartNum;
+}
+
+int32 UPlaceablesSubsystem::DamagePlacements(const FPlacementQuery& Query, float Damage)
+{
+	if (GetWorld()->GetNetMode() == NM_Client)
+	{
+		return 0;
+	}
+	TArray<AActor*> Destroyed;
+	TArray<APlacedActor*> Damaged;
+	{
+		MONATY_SCOPED_STAT(STAT_MonatyPlacementQuery);
+		PlacementIndex.ForEach(Query, [&](int32 EntryIndex, FPlacementSpatialIndex::FEntry& Entry)
+		{
+			// Only placed actors have health, it lives on the actor.
+			APlacedActor* Placed = Cast<APlacedActor>(Entry.Actor.Get());
+			if (!Placed)
+			{
+				return;
+			}
+			Placed->Health -= Damage;
+			if (Placed->Health <= 0.0f)
+			{
+				Destroyed.Add(Placed);
+			}
+			else
+			{
+				Damaged.Add(Placed);
+			}
+		});
+	}
+	// Outside of the walk, waking them up touches the autosave.
+	for (APlacedActor* Placed : Damaged)
+	{
+		Placed->NotifyPlacementChanged();
+	}
+	RemovePlacedActors(Destroyed);
+	return Destroyed.Num();
+}
+
+int32 UPlaceablesSubsystem::RemovePlacements(const FPlacementQuery& Query)
+{
+	if (GetWorld()->GetNetMode() == NM_Client)
+	{
+		return 0;
+	}
+	TArray<AActor*> Actors;
+	QueryPlacements(Query, Actors);
+	RemovePlacedActors(Actors);
+	return Actors.Num();
+}
+
+void UPlaceablesSubsystem::RemovePlacedActors(TArrayView<AActor* const> Actors)
+{
+	if (Actors.Num() == 0)
+	{
+		return;
+	}
+	MONATY_SCOPED_STAT(STAT_MonatyDemolish);
+	// Navigation gathers the dirty areas while locked and rebuilds them once on release.
+	FNavigationLockContext NavigationLock(GetWorld(), ENavigationLockReason::Unknown);
+	// Clients destroy the batch themselves. Without a remote role the placements' own destruction isn't replicated,
+	// channels still open close as usual. The multicast goes first, the placements have to exist to be referenced.
+	if (PlacementRemovals)
+	{
+		TArray<AActor*> Batch;
+		for (int32 Start = 0; Start < Actors.Num(); Start += APlacementRemovals::MaxBatchSize)
+		{
+			Batch.Reset();
+			Batch.Append(Actors.GetData() + Start, FMath::Min(APlacementRemovals::MaxBatchSize, Actors.Num() - Start));
+			PlacementRemovals->Multicast_RemovePlacements(Batch);
+		}
+		for (AActor* Actor : Actors)
+		{
+			Actor->SetReplicates(false);
+		}
+	}
+	// The indices and autosave are updated in OnPlacedActorDestroyed.
+	for (AActor* Actor : Actors)
+	{
+		Actor->Destroy();
+	}
+}
+
+int32 UPlaceablesSubsystem::SpawnPlacedActors(TArrayView<const FSavedPlacement> Placements)
+{
+	FNavigationLockContext NavigationLock(GetWorld(), ENavigationLockReason::Unknown);
+	int32 SpawnedCount = 0;
+	for (const FSavedPlacement& Placement : Placements)
+	{
+		if (SpawnPlacedActor(Placement.PlacedActorClass, Placement.Transform, Placement.OwnerId))
+		{
+			SpawnedCount++;
+		}
+	}
+	return SpawnedCount;
+}
+
+const FPlacementRuleProgram* UPlaceablesSubsystem::GetRuleProgram(const FDataTableRowHandle& Placeable)
+{
+	if (!Placeable.DataTable)
+	{
+		return nullptr;
+	}
+	TMap<FName, FPlacementRuleProgram>* Programs = RulePrograms.Find(Placeable.DataTable);
+	if (!Programs)
+	{
+		Programs = &RulePrograms.Add(Placeable.DataTable);
+		Placeable.DataTable->ForeachRow<FPlaceableData>(
+			TEXT("UPlaceablesSubsystem::GetRuleProgram"), [Programs](const FName& RowName, const FPlaceableData& Data)
+			{
+				Programs->Add(RowName, FPlacementRuleProgram::Compile(Data.Rules, Data.PlacedActorClass));
+			});
+	}
+	return Programs->Find(Placeable.RowName);
+}
+
+void UPlaceablesSubsystem::EvaluatePlacementRules(const FPlacementRuleProgram& Program, uint32 OwnerId,
+                                                  TArrayView<const FPlacementCandidate> Candidates,
+                                                  TArrayView<EPlacementRule> OutResults, bool bRecordStats)
+{
+	MONATY_SCOPED_STAT(STAT_MonatyPlacementRules);
+	check(OutResults.Num() >= Candidates.Num());
+	const double StartTime = bRecordStats ? FPlatformTime::Seconds() : 0.0;
+
+	const int32 NumCandidates = Candidates.Num();
+	for (int32 Index = 0; Index < NumCandidates; Index++)
+	{
+		OutResults[Index] = EPlacementRule::None;
+	}
+	// Marks every candidate still standing that fails the check with the rule.
+	const auto RejectIf = [&Candidates, &OutResults, NumCandidates](EPlacementRule Rule, auto&& Fails)
+	{
+		for (int32 Index = 0; Index < NumCandidates; Index++)
+		{
+			if (OutResults[Index] == EPlacementRule::None && Fails(Candidates[Index]))
+			{
+				OutResults[Index] = Rule;
+			}
+		}
+	};
+	const auto InNoBuildZone = [](const FPlacementZone& Zone) { return Zone.Type == EPlacementZoneType::NoBuild; };
+	const auto InOwnRegion = [OwnerId](const FPlacementZone& Zone)
+	{
+		return Zone.Type == EPlacementZoneType::Owned && Zone.OwnerId == OwnerId;
+	};
+	const auto InOthersRegion = [OwnerId](const FPlacementZone& Zone)
+	{
+		return Zone.Type == EPlacementZoneType::Owned && Zone.OwnerId != OwnerId;
+	};
+
+	for (const FPlacementRuleProgram::FOp& Op : Program.Ops)
+	{
+		switch (Op.Rule)
+		{
+		case EPlacementRule::PlayerCap:
+			{
+				// Placements without an owner have no cap.
+				const bool bAtCap = OwnerId != 0 &&
+					PlacementIndex.CountOwned(OwnerId, Program.PlacedActorClass) >= Op.Limit;
+				RejectIf(Op.Rule, [bAtCap](const FPlacementCandidate&) { return bAtCap; });
+				break;
+			}
+		case EPlacementRule::Slope:
+			RejectIf(Op.Rule, [&Op](const FPlacementCandidate& Candidate)
+			{
+				return Candidate.SurfaceNormal.Z < Op.Limit;
+			});
+			break;
+		case EPlacementRule::NoBuildZone:
+			RejectIf(Op.Rule, [this, &InNoBuildZone](const FPlacementCandidate& Candidate)
+			{
+				return ZoneIndex.AnyAt(Candidate.Location, InNoBuildZone);
+			});
+			break;
+		case EPlacementRule::OthersRegion:
+			RejectIf(Op.Rule, [this, &InOthersRegion](const FPlacementCandidate& Candidate)
+			{
+				return ZoneIndex.AnyAt(Candidate.Location, InOthersRegion);
+			});
+			break;
+		case EPlacementRule::OutsideOwnRegion:
+			RejectIf(Op.Rule, [this, &InOwnRegion](const FPlacementCandidate& Candidate)
+			{
+				return !ZoneIndex.AnyAt(Candidate.Location, InOwnRegion);
+			});
+			break;
+		case EPlacementRule::Spacing:
+			RejectIf(Op.Rule, [this, &Op](const FPlacementCandidate& Candidate)
+			{
+				return !Candidate.bSnapped && PlacementIndex.AnyWithin(Candidate.Location, Op.Limit);
+			});
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (!bRecordStats)
+	{
+		return;
+	}
+	for (int32 Index = 0; Index < NumCandidates; Index++)
+	{
+		RuleRejections[static_cast<int32>(OutResults[Index])]++;
+	}
+	RuleCandidates += NumCandidates;
+	RuleSeconds += FPlatformTime::Seconds() - StartTime;
+}
+
+void UPlaceablesSubsystem::PrintRuleStats(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("%llu candidates checked, %.3f us each, %d zones"), RuleCandidates,
+	        RuleCandidates > 0 ? RuleSeconds * 1000000.0 / RuleCandidates : 0.0, ZoneIndex.Num());
+	for (int32 RuleIndex = 0; RuleIndex < static_cast<int32>(EPlacementRule::Count); RuleIndex++)
+	{
+		const EPlacementRule Rule = static_cast<EPlacementRule>(RuleIndex);
+		Ar.Logf(TEXT("  %s: %llu"), Rule == EPlacementRule::None ? TEXT("Passed") : GetPlacementRuleName(Rule),
+		        RuleRejections[RuleIndex]);
+	}
+}
+
+void UPlaceablesSubsystem::ResetRuleStats()
+{
+	FMemory::Memzero(RuleRejections);
+	RuleCandidates = 0;
+	RuleSeconds = 0.0;
+}
+
+void UPlaceablesSubsystem::OnPlacedActorDestroyed(AActor* DestroyedActor)
+{
+	SnapIndex.RemoveActor(DestroyedActor);
+	PlacementIndex.Remove(DestroyedActor);
+	uint32 PlacementId = 0;
+	if (PlacementIds.RemoveAndCopyValue(DestroyedActor, PlacementId) && Journal)
+	{
+		// Destroyed actors can't be looked up anymore, the stale pointer marks the removal.
+		DirtyPlacements.Add(PlacementId, nullptr);
+	}
+}
+
+void UPlaceablesSubsystem::MarkPlacementDirty(const AActor* PlacedActor)
+{
+	if (!Journal)
+	{
+		return;
+	}
+	if (const uint32* PlacementId = PlacementIds.Find(PlacedActor))
+	{
+		DirtyPlacements.Add(*PlacementId, const_cast<AActor*>(PlacedActor));
+	}
+}
+
+void UPlaceablesSubsystem::FlushDirtyPlacements()
+{
+	if (!Journal || DirtyPlacements.Num() == 0)
+	{
+		return;
+	}
+	MONATY_SCOPED_STAT(STAT_MonatyAutosave);
+	const double StartTime = FPlatformTime::Seconds();
+	for (const TPair<uint32, TWeakObjectPtr<AActor>>& Pair : DirtyPlacements)
+	{
+		FPlacementRecord Record;
+		Record.Id = Pair.Key;
+		if (const AActor* PlacedActor = Pair.Value.Get())
+		{
+			Record.ClassPath = PlacedActor->GetClass()->GetPathName();
+			Record.Transform = PlacedActor->GetActorTransform();
+			if (const FPlacementSpatialIndex::FEntry* Entry = PlacementIndex.Find(PlacedActor))
+			{
+				Record.OwnerId = Entry->OwnerId;
+			}
+		}
+		else
+		{
+			Record.bRemoved = true;
+		}
+		Journal->Enqueue(MoveTemp(Record));
+	}
+	FlushedRecordCount += DirtyPlacements.Num();
+	DirtyPlacements.Reset();
+	Journal->Wake();
+	AutosaveCostMs.Samples.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+void UPlaceablesSubsystem::PrintAutosaveStats(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("Autosave %s: %d flushes, %d records, game thread cost mean %.4f ms, p99 %.4f ms, max %.4f ms"),
+	        Journal ? TEXT("on") : TEXT("off"), AutosaveCostMs.Samples.Num(), FlushedRecordCount,
+	        AutosaveCostMs.GetMean(), AutosaveCostMs.GetPercentile(99.0), AutosaveCostMs.GetPercentile(100.0));
+}
+
+void UPlaceablesSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+	if (InWorld.GetNetMode() == NM_DedicatedServer || InWorld.GetNetMode() == NM_ListenServer)
+	{
+		PlacementRemovals = InWorld.SpawnActor<APlacementRemovals>();
+	}
+	if (CVarAutosave.GetValueOnGameThread() && InWorld.IsGameWorld() && InWorld.GetNetMode() != NM_Client)
+	{
+		StartAutosave();
+	}
+}
+
+void UPlaceablesSubsystem::StartAutosave()
+{
+	const FString Directory = FPaths::ProjectSavedDir() / TEXT("Placements") / GetWorld()->GetMapName();
+	IFileManager::Get().MakeDirectory(*Directory, true);
+
+	// An operator has to look at the quarantined files first, journaling now would bury what they hold.
+	const FString QuarantineDirectory = FPlacementJournal::GetQuarantineDirectory(Directory);
+	if (IFileManager::Get().DirectoryExists(*QuarantineDirectory))
+	{
+		UE_LOG(LogTemp, Error,
+		       TEXT("UPlaceablesSubsystem::StartAutosave | Autosave is off until %s is dealt with and removed!"),
+		       *QuarantineDirectory);
+		return;
+	}
+
+	// Whatever the last session left behind, snapshot plus journal, comes back first.
+	TArray<FPlacementRecord> Records;
+	int64 JournalValidSize = 0;
+	if (!FPlacementJournal::Recover(Directory, Records, &JournalValidSize))
+	{
+		FPlacementJournal::Quarantine(Directory);
+		UE_LOG(LogTemp, Error,
+		       TEXT("UPlaceablesSubsystem::StartAutosave | Saved placements could not be recovered and were moved to %s, ")
+		       TEXT("autosave is off!"), *QuarantineDirectory);
+		return;
+	}
+	if (Records.Num() > 0)
+	{
+		TArray<FSavedPlacement> Placements;
+		Placements.Reserve(Records.Num());
+		for (const FPlacementRecord& Record : Records)
+		{
+			NextPlacementId = FMath::Max(NextPlacementId, Record.Id + 1);
+			UClass* PlacedActorClass = LoadClass<AActor>(nullptr, *Record.ClassPath);
+			// Stays in the autosave, the class may come back with its plugin or content.
+			if (!PlacedActorClass)
+			{
+				UE_LOG(LogTemp, Warning,
+				       TEXT("UPlaceablesSubsystem::StartAutosave | Placement %u of missing class %s is not restored!"),
+				       Record.Id, *Record.ClassPath);
+				continue;
+			}
+			FSavedPlacement& Placement = Placements.AddDefaulted_GetRef();
+			Placement.PlacedActorClass = PlacedActorClass;
+			Placement.Transform = Record.Transform;
+			Placement.PlacementId = Record.Id;
+			Placement.OwnerId = Record.OwnerId;
+		}
+		StartRestore(Placements);
+	}
+
+	Journal = MakeUnique<FPlacementJournal>(Directory);
+	Journal->Start(MoveTemp(Records), JournalValidSize);
+}
+
+void UPlaceablesSubsystem::Deinitialize()
+{
+	if (Journal)
+	{
+		FlushDirtyPlacements();
+		Journal->Shutdown();
+		Journal.Reset();
+	}
+	Super::Deinitialize();
+}
+
+bool UPlaceablesSubsystem::FindSnapTransform(TSubclassOf<AActor> PlacedActorClass, const FTransform& Transform,
+                                             float SnapDistance, FTransform& OutTransform) const
+{
+	const APlacedActor* PlacedCDO = PlacedActorClass ? Cast<APlacedActor>(PlacedActorClass->GetDefaultObject()) : nullptr;
+	if (!PlacedCDO)
+	{
+		return false;
+	}
+	// Pick the socket pair that needs the smallest move.
+	int32 BestEntry = INDEX_NONE;
+	const FPlaceableSnapPoint* BestPoint = nullptr;
+	float BestDistance = SnapDistance;
+	for (const FPlaceableSnapPoint& Point : PlacedCDO->SnapPoints)
+	{
+		const FVector PointLocation = Transform.TransformPosition(Point.LocalOffset);
+		const int32 EntryIndex = SnapIndex.FindNearest(PointLocation, BestDistance, Point);
+		if (EntryIndex != INDEX_NONE)
+		{
+			BestEntry = EntryIndex;
+			BestPoint = &Point;
+			BestDistance = FVector::Dist(SnapIndex.GetEntry(EntryIndex).Location, PointLocation);
+		}
+	}
+	if (BestEntry == INDEX_NONE)
+	{
+		return false;
+	}
+	// Mating sockets face each other, so ours ends up turned half way round from the one we snap to.
+	const FPlaceableSnapIndex::FEntry& Target = SnapIndex.GetEntry(BestEntry);
+	const FQuat PointRotation(FVector::UpVector, FMath::DegreesToRadians(BestPoint->LocalYaw));
+	const FQuat Rotation = Target.Rotation * FQuat(FVector::UpVector, PI) * PointRotation.Inverse();
+	OutTransform = FTransform(Rotation, Target.Location - Rotation.RotateVector(BestPoint->LocalOffset),
+	                          Transform.GetScale3D());
+	return true;
+}
+
+bool UPlaceablesSubsystem::SavePlacements(const FString& SlotName)
+{
+	UPlacementsSaveGame* SaveGame = Cast<UPlacementsSaveGame>(
+		UGameplayStatics::CreateSaveGameObject(UPlacementsSaveGame::StaticClass()));
+	SaveGame->Placements.Reserve(PlacementIds.Num());
+	for (const TPair<TObjectKey<AActor>, uint32>& Pair : PlacementIds)
+	{
+		const AActor* PlacedActor = Pair.Key.ResolveObjectPtr();
+		if (!PlacedActor)
+		{
+			continue;
+		}
+		const FPlacementSpatialIndex::FEntry* Entry = PlacementIndex.Find(PlacedActor);
+		SaveGame->Placements.Add({PlacedActor->GetClass(), PlacedActor->GetActorTransform(), 0, Entry ? Entry->OwnerId : 0});
+	}
+	return UGameplayStatics::SaveGameToSlot(SaveGame, SlotName, 0);
+}
+
+bool UPlaceablesSubsystem::RestorePlacements(const FString& SlotName)
+{
+	// Only the server spawns placements, clients receive them through replication.
+	if (GetWorld()->GetNetMode() == NM_Client)
+	{
+		return false;
+	}
+	const UPlacementsSaveGame* SaveGame = Cast<UPlacementsSaveGame>(UGameplayStatics::LoadGameFromSlot(SlotName, 0));
+	if (!SaveGame)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlaceablesSubsystem::RestorePlacements | Could not load slot %s!"), *SlotName);
+		return false;
+	}
+	StartRestore(SaveGame->Placements);
+	return true;
+}
+
+void UPlaceablesSubsystem::StartRestore(const TArray<FSavedPlacement>& Placements)
+{
+	TArray<FVector> PlayerLocations;
+	for (TActorIterator<APawn> It(GetWorld()); It; ++It)
+	{
+		if (It->IsPlayerControlled())
+		{
+			PlayerLocations.Add(It->GetActorLocation());
+		}
+	}
+	if (PlayerLocations.Num() == 0)
+	{
+		PlayerLocations.Add(FVector::ZeroVector);
+	}
+	auto DistanceToPlayers = [&PlayerLocations](const FSavedPlacement& Placement)
+	{
+		double Closest = TNumericLimits<double>::Max();
+		for (const FVector& PlayerLocation : PlayerLocations)
+		{
+			Closest = FMath::Min(Closest, FVector::DistSquared(PlayerLocation, Placement.Transform.GetLocation()));
+		}
+		return Closest;
+	};
+
+	// A restore that is already running keeps going, its remaining placements are sorted in with the new ones.
+	const bool bWasRestoring = IsRestoring();
+	TArray<FSavedPlacement> Queued = MoveTemp(PendingRestore);
+	Queued.Append(Placements);
+
+	// Compute the distances once instead of in every comparison.
+	TArray<TPair<double, int32>> Order;
+	Order.Reserve(Queued.Num());
+	for (int32 Index = 0; Index < Queued.Num(); Index++)
+	{
+		Order.Emplace(DistanceToPlayers(Queued[Index]), Index);
+	}
+	Order.Sort([](const TPair<double, int32>& A, const TPair<double, int32>& B) { return A.Key > B.Key; });
+
+	PendingRestore.Reset(Order.Num());
+	for (const TPair<double, int32>& Entry : Order)
+	{
+		PendingRestore.Add(MoveTemp(Queued[Entry.Value]));
+	}
+	if (bWasRestoring)
+	{
+		RestoreTotal += Placements.Num();
+	}
+	else
+	{
+		RestoreTotal = PendingRestore.Num();
+		RestoredCount = 0;
+		RestoreFailedCount = 0;
+		RestoreFrames = 0;
+		RestoreSpawnSeconds = 0.0;
+		RestoreStartTime = FPlatformTime::Seconds();
+	}
+	UE_LOG(LogTemp, Display, TEXT("UPlaceablesSubsystem::StartRestore | Restoring %d placements, %d queued"),
+	       Placements.Num(), PendingRestore.Num());
+}
+
+float UPlaceablesSubsystem::GetRestoreProgress() const
+{
+	return RestoreTotal > 0 ? static_cast<float>(RestoredCount) / RestoreTotal : 1.0f;
+}
+
+void UPlaceablesSubsystem::Tick(float DeltaTime)
+{
+	if (IsRestoring())
+	{
+		TickRestore();
+	}
+	if (Journal)
+	{
+		AutosaveTimer += DeltaTime;
+		if (AutosaveTimer >= CVarAutosaveInterval.GetValueOnGameThread())
+		{
+			AutosaveTimer = 0.0f;
+			FlushDirtyPlacements();
+		}
+	}
+}
+
+void UPlaceablesSubsystem::TickRestore()
+{
+	const double BudgetSeconds = CVarRestoreBudgetMs.GetValueOnGameThread() / 1000.0;
+	const double SliceStart = FPlatformTime::Seconds();
+	double Now = SliceStart;
+	// Always spawn at least one, so a tiny budget still makes progress.
+	do
+	{
+		const FSavedPlacement Placement = PendingRestore.Pop(false);
+		if (SpawnPlacedActor(Placement.PlacedActorClass, Placement.Transform, Placement.OwnerId, Placement.PlacementId))
+		{
+			RestoredCount++;
+		}
+		else
+		{
+			// Leaves the total, so the progress still ends at one.
+			RestoreFailedCount++;
+			RestoreTotal--;
+		}
+		Now = FPlatformTime::Seconds();
+	}
+	while (PendingRestore.Num() > 0 && Now - SliceStart < BudgetSeconds);
+	RestoreSpawnSeconds += Now - SliceStart;
+	RestoreFrames++;
+
+	OnRestoreProgress.Broadcast(RestoredCount, RestoreTotal);
+	if (PendingRestore.Num() == 0)
+	{
+		FinishRestore();
+	}
+}
+
+TStatId UPlaceablesSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPlaceablesSubsystem, STATGROUP_Tickables);
+}
+
+void UPlaceablesSubsystem::FinishRestore()
+{
+	const double SpawnMs = RestoreSpawnSeconds * 1000.0;
+	UE_LOG(LogTemp, Display,
+	       TEXT("UPlaceablesSubsystem::FinishRestore | %d placements in %d frames, %.1f ms spawning (%.2f spawns/ms), %.2f s wall time"),
+	       RestoredCount, RestoreFrames, SpawnMs, SpawnMs > 0.0 ? RestoredCount / SpawnMs : 0.0,
+	       FPlatformTime::Seconds() - RestoreStartTime);
+	if (RestoreFailedCount > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPlaceablesSubsystem::FinishRestore | %d placements failed to spawn!"),
+		       RestoreFailedCount);
+	}
+	PendingRestore.Empty();
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice AutosaveStatsCommand(
+	TEXT("Monaty.Placeables.AutosaveStats"),
+	TEXT("Prints the game thread cost of the placement autosave. Pass flush to flush the dirty placements first."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+		[](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			if (UPlaceablesSubsystem* Placeables = World ? World->GetSubsystem<UPlaceablesSubsystem>() : nullptr)
+			{
+				if (Args.Contains(TEXT("flush")))
+				{
+					Placeables->FlushDirtyPlacements();
+				}
+				Placeables->PrintAutosaveStats(Ar);
+			}
+		}));
+
+static FAutoConsoleCommandWithWorldAndArgs SavePlacementsCommand(
+	TEXT("Monaty.Placeables.Save"),
+	TEXT("Saves every placed structure. Usage: Monaty.Placeables.Save [Slot]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UPlaceablesSubsystem* Placeables = World ? World->GetSubsystem<UPlaceablesSubsystem>() : nullptr)
+		{
+			Placeables->SavePlacements(Args.Num() > 0 ? Args[0] : TEXT("Placements"));
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs RestorePlacementsCommand(
+	TEXT("Monaty.Placeables.Restore"),
+	TEXT("Restores saved placed structures over several frames. Usage: Monaty.Placeables.Restore [Slot]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UPlaceablesSubsystem* Placeables = World ? World->GetSubsystem<UPlaceablesSubsystem>() : nullptr)
+		{
+			Placeables->RestorePlacements(Args.Num() > 0 ? Args[0] : TEXT("Placements"));
+		}
+	}));
+
+// Reads [box X Y Z X Y Z | sphere X Y Z Radius] [owner=Id]... from console arguments, everywhere by default.
+static FPlacementQuery ParsePlacementQuery(const TArray<FString>& Args)
+{
+	FPlacementQuery Query;
+	for (int32 Index = 0; Index < Args.Num(); Index++)
+	{
+		const auto Number = [&Args](int32 ArgIndex)
+		{
+			return Args.IsValidIndex(ArgIndex) ? FCString::Atof(*Args[ArgIndex]) : 0.0f;
+		};
+		if (Args[Index] == TEXT("box"))
+		{
+			const FVector Min(Number(Index + 1), Number(Index + 2), Number(Index + 3));
+			const FVector Max(Number(Index + 4), Number(Index + 5), Number(Index + 6));
+			Query.Shape = FPlacementQuery::EShape::Box;
+			Query.Box = FBox(Min.ComponentMin(Max), Min.ComponentMax(Max));
+			Index += 6;
+		}
+		else if (Args[Index] == TEXT("sphere"))
+		{
+			Query.Shape = FPlacementQuery::EShape::Sphere;
+			Query.Center = FVector(Number(Index + 1), Number(Index + 2), Number(Index + 3));
+			Query.Radius = Number(Index + 4);
+			Index += 4;
+		}
+		else if (Args[Index].StartsWith(TEXT("owner=")))
+		{
+			Query.Owners.Add(static_cast<uint32>(FCString::Strtoui64(*Args[Index].Mid(6), nullptr, 10)));
+		}
+	}
+	return Query;
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice QueryPlacementsCommand(
+	TEXT("Monaty.Placeables.Query"),
+	TEXT("Counts placed structures. Usage: Monaty.Placeables.Query [box X Y Z X Y Z | sphere X Y Z Radius] [owner=Id]..."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+		[](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			if (UPlaceablesSubsystem* Placeables = World ? World->GetSubsystem<UPlaceablesSubsystem>() : nullptr)
+			{
+				TArray<AActor*> Actors;
+				const double StartTime = FPlatformTime::Seconds();
+				Placeables->QueryPlacements(ParsePlacementQuery(Args), Actors);
+				Ar.Logf(TEXT("%d of %d placements match, %.3f ms"), Actors.Num(), Placeables->GetPlacementIndex().Num(),
+				        (FPlatformTime::Seconds() - StartTime) * 1000.0);
+			}
+		}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice DemolishPlacementsCommand(
+	TEXT("Monaty.Placeables.Demolish"),
+	TEXT("Removes placed structures, or damages them when given damage=N. ")
+	TEXT("Usage: Monaty.Placeables.Demolish [box X Y Z X Y Z | sphere X Y Z Radius] [owner=Id]... [damage=N]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+		[](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			UPlaceablesSubsystem* Placeables = World ? World->GetSubsystem<UPlaceablesSubsystem>() : nullptr;
+			if (!Placeables || World->GetNetMode() == NM_Client)
+			{
+				Ar.Log(TEXT("Placements can only be demolished on the server"));
+				return;
+			}
+			float Damage = 0.0f;
+			for (const FString& Arg : Args)
+			{
+				FParse::Value(*Arg, TEXT("damage="), Damage);
+			}
+			const FPlacementQuery Query = ParsePlacementQuery(Args);
+			const double StartTime = FPlatformTime::Seconds();
+			const int32 Removed = Damage > 0.0f
+				                      ? Placeables->DamagePlacements(Query, Damage)
+				                      : Placeables->RemovePlacements(Query);
+			Ar.Logf(TEXT("Removed %d placements in %.3f ms, %d left"), Removed,
+			        (FPlatformTime::Seconds() - StartTime) * 1000.0, Placeables->GetPlacementIndex().Num());
+		}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice DemolishBenchmarkCommand(
+	TEXT("Monaty.Bench.Demolish"),
+	TEXT("Places a grid of structures far above the level and clears it in one call. ")
+	TEXT("Usage: Monaty.Bench.Demolish [Count=10000]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+		[](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			UPlaceablesSubsystem* Placeables = World ? World->GetSubsystem<UPlaceablesSubsystem>() : nullptr;
+			if (!Placeables || World->GetNetMode() == NM_Client)
+			{
+				return;
+			}
+			const int32 Count = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10000;
+			const int32 Columns = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count)));
+			const FVector Origin(0.0f, 0.0f, 100000.0f);
+			const float Spacing = 200.0f;
+
+			double StartTime = FPlatformTime::Seconds();
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				const FVector Location = Origin + FVector(Index % Columns, Index / Columns, 0.0f) * Spacing;
+				Placeables->SpawnPlacedActor(APlacedActor::StaticClass(), FTransform(Location));
+			}
+			const double SpawnMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+			const FPlacementQuery Query = FPlacementQuery::InBox(
+				FBox(Origin - FVector(Spacing), Origin + FVector(Columns * Spacing, Columns * Spacing, Spacing)));
+			StartTime = FPlatformTime::Seconds();
+			TArray<AActor*> Actors;
+			Placeables->QueryPlacements(Query, Actors);
+			const double QueryMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+			StartTime = FPlatformTime::Seconds();
+			Placeables->RemovePlacedActors(Actors);
+			const double RemoveMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+			Ar.Logf(TEXT("Demolish %d placements: spawn %.1f ms, query %.3f ms (%d found), remove %.1f ms (%.2f us each), %d left"),
+			        Count, SpawnMs, QueryMs, Actors.Num(), RemoveMs, Actors.Num() > 0 ? RemoveMs * 1000.0 / Actors.Num() : 0.0,
+			        Placeables->GetPlacementIndex().Num());
+		}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice PlacementRulesCommand(
+	TEXT("Monaty.Placeables.Rules"),
+	TEXT("Prints how many placements the server rejected per rule. Usage: Monaty.Placeables.Rules [reset]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+		[](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			if (UPlaceablesSubsystem* Placeables = World ? World->GetSubsystem<UPlaceablesSubsystem>() : nullptr)
+			{
+				Placeables->PrintRuleStats(Ar);
+				if (Args.Contains(TEXT("reset")))
+				{
+					Placeables->ResetRuleStats();
+				}
+			}
+		}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice PlacementZoneCommand(
+	TEXT("Monaty.Placeables.Zone"),
+	TEXT("Adds a no build zone in this world only or an owned region the server replicates, or removes one. ")
+	TEXT("Usage: Monaty.Placeables.Zone [nobuild | owned=Id] X Y Z Extent, or Monaty.Placeables.Zone remove Id"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+		[](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			UPlaceablesSubsystem* Placeables = World ? World->GetSubsystem<UPlaceablesSubsystem>() : nullptr;
+			if (!Placeables || Args.Num() < 2)
+			{
+				return;
+			}
+			if (Args[0] == TEXT("remove"))
+			{
+				const int32 ZoneId = FCString::Atoi(*Args[1]);
+				for (TActorIterator<APlacementOwnedRegion> It(World); It; ++It)
+				{
+					if (It->GetZoneId() == ZoneId && It->HasAuthority())
+					{
+						It->Destroy();
+						return;
+					}
+				}
+				Placeables->RemovePlacementZone(ZoneId);
+				return;
+			}
+			if (Args.Num() < 5)
+			{
+				return;
+			}
+			FPlacementZone Zone;
+			if (Args[0].StartsWith(TEXT("owned=")))
+			{
+				Zone.Type = EPlacementZoneType::Owned;
+				Zone.OwnerId = static_cast<uint32>(FCString::Strtoui64(*Args[0].Mid(6), nullptr, 10));
+			}
+			const FVector Center(FCString::Atof(*Args[1]), FCString::Atof(*Args[2]), FCString::Atof(*Args[3]));
+			Zone.Bounds = FBox::BuildAABB(Center, FVector(FCString::Atof(*Args[4])));
+			// Owned regions the server hands out reach its clients through a region actor.
+			if (Zone.Type == EPlacementZoneType::Owned && World->GetNetMode() != NM_Client)
+			{
+				if (APlacementOwnedRegion* Region = World->SpawnActor<APlacementOwnedRegion>())
+				{
+					Region->SetRegion(Zone.Bounds, Zone.OwnerId);
+					Ar.Logf(TEXT("Added zone %d"), Region->GetZoneId());
+				}
+				return;
+			}
+			Ar.Logf(TEXT("Added zone %d"), Placeables->AddPlacementZone(Zone));
+		}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice PlacementRulesBenchmarkCommand(
+	TEXT("Monaty.Bench.PlacementRules"),
+	TEXT("Checks random candidates against every rule with random zones, in one batch and one at a time. ")
+	TEXT("The counters of Monaty.Placeables.Rules include them. Usage: Monaty.Bench.PlacementRules [Candidates=10000] ")
+	TEXT("[Zones=1000]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+		[](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			UPlaceablesSubsystem* Placeables = World ? World->GetSubsystem<UPlaceablesSubsystem>() : nullptr;
+			if (!Placeables)
+			{
+				return;
+			}
+			const int32 NumCandidates = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10000;
+			const int32 NumZones = Args.Num() > 1 ? FMath::Max(0, FCString::Atoi(*Args[1])) : 1000;
+			const float HalfSize = 50000.0f;
+			const FRandomStream Random(1);
+
+			// Half no build zones, half regions of eight owners, placed on top of whatever the world has.
+			TArray<int32> ZoneIds;
+			for (int32 Index = 0; Index < NumZones; Index++)
+			{
+				FPlacementZone Zone;
+				Zone.Type = Index % 2 == 0 ? EPlacementZoneType::NoBuild : EPlacementZoneType::Owned;
+				Zone.OwnerId = Index % 8 + 1;
+				const FVector Center(Random.FRandRange(-HalfSize, HalfSize), Random.FRandRange(-HalfSize, HalfSize),
+				                     0.0f);
+				const FVector Extent(Random.FRandRange(250.0f, 1500.0f), Random.FRandRange(250.0f, 1500.0f), 5000.0f);
+				Zone.Bounds = FBox::BuildAABB(Center, Extent);
+				ZoneIds.Add(Placeables->AddPlacementZone(Zone));
+			}
+
+			TArray<FPlacementCandidate> Candidates;
+			Candidates.SetNum(NumCandidates);
+			for (FPlacementCandidate& Candidate : Candidates)
+			{
+				Candidate.Location = FVector(Random.FRandRange(-HalfSize, HalfSize),
+				                             Random.FRandRange(-HalfSize, HalfSize), 0.0f);
+				Candidate.SurfaceNormal = FRotator(Random.FRandRange(-40.0f, 40.0f), Random.FRandRange(0.0f, 360.0f),
+				                                   0.0f).RotateVector(FVector::UpVector);
+				Candidate.bSnapped = Random.FRand() < 0.1f;
+			}
+
+			FPlacementRules Rules;
+			Rules.MinSpacing = 300.0f;
+			Rules.MaxSurfaceAngle = 30.0f;
+			Rules.MaxPerPlayer = 1000;
+			const FPlacementRuleProgram Program = FPlacementRuleProgram::Compile(Rules, APlacedActor::StaticClass());
+
+			FMonatyBenchmarkReport Report;
+			Report.Name = FString::Printf(TEXT("PlacementRules-%d-%d"), NumCandidates, NumZones);
+			Report.AddSeries(TEXT("BatchUsPerCandidate"));
+			Report.AddSeries(TEXT("SingleUsPerCandidate"));
+			FMonatyBenchmarkSeries& BatchUs = Report.Series[0];
+			FMonatyBenchmarkSeries& SingleUs = Report.Series[1];
+			TArray<EPlacementRule> Results;
+			Results.SetNum(NumCandidates);
+			const int32 Iterations = 10;
+			for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+			{
+				double StartTime = FPlatformTime::Seconds();
+				Placeables->EvaluatePlacementRules(Program, 1, Candidates, Results);
+				BatchUs.Samples.Add((FPlatformTime::Seconds() - StartTime) * 1000000.0 / NumCandidates);
+
+				StartTime = FPlatformTime::Seconds();
+				for (int32 Index = 0; Index < NumCandidates; Index++)
+				{
+					Placeables->EvaluatePlacementRules(Program, 1, MakeArrayView(&Candidates[Index], 1),
+					                                   MakeArrayView(&Results[Index], 1));
+				}
+				SingleUs.Samples.Add((FPlatformTime::Seconds() - StartTime) * 1000000.0 / NumCandidates);
+			}
+			for (const int32 ZoneId : ZoneIds)
+			{
+				Placeables->RemovePlacementZone(ZoneId);
+			}
+
+			int32 Counts[static_cast<int32>(EPlacementRule::Count)] = {};
+			for (const EPlacementRule Result : Results)
+			{
+				Counts[static_cast<int32>(Result)]++;
+			}
+			Ar.Logf(TEXT("%d candidates, %d zones, %d placements: batch %.3f us, single %.3f us per candidate (median)"),
+			        NumCandidates, NumZones, Placeables->GetPlacementIndex().Num(), BatchUs.GetPercentile(50.0),
+			        SingleUs.GetPercentile(50.0));
+			for (int32 RuleIndex = 0; RuleIndex < static_cast<int32>(EPlacementRule::Count); RuleIndex++)
+			{
+				const EPlacementRule Rule = static_cast<EPlacementRule>(RuleIndex);
+				Ar.Logf(TEXT("  %s: %d"), Rule == EPlacementRule::None ? TEXT("Passed") : GetPlacementRuleName(Rule),
+				        Counts[RuleIndex]);
+			}
+			Report.SaveCsv();
+		}));
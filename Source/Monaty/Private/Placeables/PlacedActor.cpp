@@ -0,0 +1,95 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Placeables/PlacedActor.h"
+
+#include "Engine/ActorChannel.h"
+#include "Net/DataBunch.h"
+#include "Net/MonatyNetStats.h"
+#include "Net/UnrealNetwork.h"
+#include "Placeables/PlaceablesSubsystem.h"
+#include "Placeables/PlacedLogicManager.h"
+
+APlacedActor::APlacedActor()
+{
+	// Placed structures never move, not even when their placement changes, so the root is static and the logic
+	// manager keeps their location from registration. Their logic is ticked in batches by UPlacedLogicManager.
+	PrimaryActorTick.bCanEverTick = false;
+
+	bReplicates = true;
+	SetReplicatingMovement(false);
+	NetDormancy = DORM_Initial;
+	NetUpdateFrequency = 10.0f;
+
+	PlacedRootComponent = CreateDefaultSubobject<USceneComponent>("RootComponent");
+	PlacedRootComponent->SetMobility(EComponentMobility::Static);
+	SetRootComponent(PlacedRootComponent);
+
+	PlacedMeshComponent = CreateDefaultSubobject<UStaticMeshComponent>("PlacedMeshComponent");
+	PlacedMeshComponent->SetupAttachment(GetRootComponent());
+}
+
+void APlacedActor::BeginPlay()
+{
+	Super::BeginPlay();
+	if (HasAuthority())
+	{
+		Health = MaxHealth;
+	}
+	// On every net mode, clients snap and check the rules against the same indices as the server.
+	if (UPlaceablesSubsystem* Placeables = GetWorld()->GetSubsystem<UPlaceablesSubsystem>())
+	{
+		Placeables->RegisterPlacedActor(this);
+	}
+	if (UPlacedLogicManager* LogicManager = bHasPlacedLogic ? GetWorld()->GetSubsystem<UPlacedLogicManager>() : nullptr)
+	{
+		LogicManager->RegisterActor(this);
+	}
+}
+
+void APlacedActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UPlacedLogicManager* LogicManager = GetWorld()->GetSubsystem<UPlacedLogicManager>())
+	{
+		LogicManager->UnregisterActor(this);
+	}
+	if (UPlaceablesSubsystem* Placeables = GetWorld()->GetSubsystem<UPlaceablesSubsystem>())
+	{
+		Placeables->UnregisterPlacedActor(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void APlacedActor::NotifyPlacementChanged()
+{
+	if (!HasAuthority())
+	{
+		return;
+	}
+	PlacementRevision++;
+	FlushNetDormancy();
+	if (UPlaceablesSubsystem* Placeables = GetWorld()->GetSubsystem<UPlaceablesSubsystem>())
+	{
+		Placeables->MarkPlacementDirty(this);
+	}
+}
+
+void APlacedActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(APlacedActor, PlacementRevision);
+	DOREPLIFETIME(APlacedActor, Health);
+	DOREPLIFETIME_CONDITION(APlacedActor, PlacementOwnerId, COND_InitialOnly);
+}
+
+bool APlacedActor::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
+{
+	// The bunch holds just the actor's own properties at this point.
+	if (FMonatyNetStats::IsEnabled() && Bunch->GetNumBits() > 0)
+	{
+		FMonatyNetStats::Get().Record(EMonatyNetStatKind::Actor, GetClass()->GetFName(), Channel->Connection,
+		                              Bunch->GetNumBits());
+		FMonatyNetStats::Get().RecordProperties(this, Channel, *RepFlags);
+	}
+	return Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
+}
@@ -0,0 +1,206 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Placeables/PlacedLogicManager.h"
+
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Placeables/PlacedActor.h"
+#include "Profiling/MonatyBenchmark.h"
+#include "Profiling/MonatyStats.h"
+
+static TAutoConsoleVariable<float> CVarPlacedLogicBudgetMs(
+	TEXT("monaty.PlacedLogic.BudgetMs"),
+	0.0f,
+	TEXT("Milliseconds per frame spent ticking placed actor logic, 0 for no limit. The rest waits for the next frame."));
+
+static TAutoConsoleVariable<float> CVarPlacedLogicFarDistance(
+	TEXT("monaty.PlacedLogic.FarDistance"),
+	5000.0f,
+	TEXT("Placed actors further than this from every player tick at the reduced rate."));
+
+static TAutoConsoleVariable<float> CVarPlacedLogicFarInterval(
+	TEXT("monaty.PlacedLogic.FarInterval"),
+	0.5f,
+	TEXT("Seconds between ticks of far away placed actors."));
+
+// Checking the clock every actor would cost more than the small logic it times.
+static constexpr int32 BudgetCheckInterval = 64;
+
+TStatId UPlacedLogicManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPlacedLogicManager, STATGROUP_Tickables);
+}
+
+void UPlacedLogicManager::RegisterActor(APlacedActor* Actor)
+{
+	if (!Actor || Actor->PlacedLogicBucket != INDEX_NONE)
+	{
+		return;
+	}
+	UClass* Class = Actor->GetClass();
+	int32* BucketIndex = BucketIndices.Find(Class);
+	if (!BucketIndex)
+	{
+		FPlacedLogicBucket& NewBucket = Buckets.AddDefaulted_GetRef();
+		NewBucket.Class = Class;
+		NewBucket.bScriptTick = Class->IsFunctionImplementedInScript(
+			GET_FUNCTION_NAME_CHECKED(APlacedActor, ReceiveTickPlacedLogic));
+		BucketIndex = &BucketIndices.Add(Class, Buckets.Num() - 1);
+	}
+	FPlacedLogicBucket& Bucket = Buckets[*BucketIndex];
+	Actor->PlacedLogicBucket = *BucketIndex;
+	Actor->PlacedLogicIndex = Bucket.Actors.Add(Actor);
+	Bucket.Locations.Add(FVector3f(Actor->GetActorLocation()));
+	Bucket.LastTickTimes.Add(GetWorld()->GetTimeSeconds());
+}
+
+void UPlacedLogicManager::UnregisterActor(APlacedActor* Actor)
+{
+	if (!Actor || !Buckets.IsValidIndex(Actor->PlacedLogicBucket))
+	{
+		return;
+	}
+	FPlacedLogicBucket& Bucket = Buckets[Actor->PlacedLogicBucket];
+	const int32 Index = Actor->PlacedLogicIndex;
+	check(Bucket.Actors[Index] == Actor);
+	if (bTickingBatch)
+	{
+		Bucket.Actors[Index] = nullptr;
+		PendingRemovals.Emplace(Actor->PlacedLogicBucket, Index);
+	}
+	else
+	{
+		RemoveFromBucket(Actor->PlacedLogicBucket, Index);
+	}
+	Actor->PlacedLogicBucket = INDEX_NONE;
+	Actor->PlacedLogicIndex = INDEX_NONE;
+}
+
+void UPlacedLogicManager::RemoveFromBucket(int32 BucketIndex, int32 Index)
+{
+	FPlacedLogicBucket& Bucket = Buckets[BucketIndex];
+	// Swap the last actor into the hole, it keeps its place in the batch order otherwise.
+	const int32 LastIndex = Bucket.Actors.Num() - 1;
+	Bucket.Actors.RemoveAtSwap(Index, 1, false);
+	Bucket.Locations.RemoveAtSwap(Index, 1, false);
+	Bucket.LastTickTimes.RemoveAtSwap(Index, 1, false);
+	if (Bucket.Actors.IsValidIndex(Index))
+	{
+		if (Bucket.Actors[Index])
+		{
+			Bucket.Actors[Index]->PlacedLogicIndex = Index;
+		}
+		// The swapped in actor wasn't reached yet by a budgeted batch, resume from its new slot.
+		if (BucketIndex == BucketCursor && Index < ActorCursor && LastIndex >= ActorCursor)
+		{
+			ActorCursor = Index;
+		}
+	}
+}
+
+int32 UPlacedLogicManager::GetNumActors() const
+{
+	int32 Count = 0;
+	for (const FPlacedLogicBucket& Bucket : Buckets)
+	{
+		Count += Bucket.Actors.Num();
+	}
+	return Count;
+}
+
+void UPlacedLogicManager::GatherViewLocations()
+{
+	ViewLocations.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* Controller = It->Get())
+		{
+			FVector Location;
+			FRotator Rotation;
+			Controller->GetPlayerViewPoint(Location, Rotation);
+			ViewLocations.Add(FVector3f(Location));
+		}
+	}
+}
+
+float UPlacedLogicManager::GetDistanceSquaredToViewers(const FVector3f& Location) const
+{
+	// Without players, like on an empty server, everything is far away.
+	float DistanceSquared = TNumericLimits<float>::Max();
+	for (const FVector3f& ViewLocation : ViewLocations)
+	{
+		DistanceSquared = FMath::Min(DistanceSquared, FVector3f::DistSquared(ViewLocation, Location));
+	}
+	return DistanceSquared;
+}
+
+void UPlacedLogicManager::Tick(float DeltaTime)
+{
+	MONATY_SCOPED_STAT(STAT_MonatyPlacedLogicTick);
+	MONATY_BENCHMARK_SCOPE(PlacedLogicTick);
+
+	GatherViewLocations();
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float FarDistanceSquared = FMath::Square(CVarPlacedLogicFarDistance.GetValueOnGameThread());
+	const double FarInterval = CVarPlacedLogicFarInterval.GetValueOnGameThread();
+	const double BudgetSeconds = CVarPlacedLogicBudgetMs.GetValueOnGameThread() / 1000.0;
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Walks every bucket once, starting where the last budgeted frame stopped, and the start of that bucket again.
+	// Actors already ticked this frame are skipped, so none ticks twice.
+	const int32 NumBuckets = Buckets.Num();
+	if (!Buckets.IsValidIndex(BucketCursor))
+	{
+		BucketCursor = 0;
+		ActorCursor = 0;
+	}
+	bTickingBatch = true;
+	int32 Visited = 0;
+	bool bOutOfBudget = false;
+	for (int32 Pass = 0; Pass <= NumBuckets && !bOutOfBudget; Pass++)
+	{
+		// Re-read every actor, the logic may register new classes, which moves the buckets.
+		while (ActorCursor < Buckets[BucketCursor].Actors.Num())
+		{
+			FPlacedLogicBucket& Bucket = Buckets[BucketCursor];
+			const int32 Index = ActorCursor++;
+			APlacedActor* Actor = Bucket.Actors[Index];
+			const double ActorDeltaTime = Now - Bucket.LastTickTimes[Index];
+			if (!Actor || ActorDeltaTime <= 0.0 ||
+				(ActorDeltaTime < FarInterval &&
+					GetDistanceSquaredToViewers(Bucket.Locations[Index]) > FarDistanceSquared))
+			{
+				continue;
+			}
+			Bucket.LastTickTimes[Index] = Now;
+			const bool bScriptTick = Bucket.bScriptTick;
+			Actor->TickPlacedLogic(ActorDeltaTime);
+			if (bScriptTick)
+			{
+				Actor->ReceiveTickPlacedLogic(ActorDeltaTime);
+			}
+
+			Visited++;
+			if (BudgetSeconds > 0.0 && Visited % BudgetCheckInterval == 0 &&
+				FPlatformTime::Seconds() - StartTime > BudgetSeconds)
+			{
+				bOutOfBudget = true;
+				break;
+			}
+		}
+		if (!bOutOfBudget)
+		{
+			BucketCursor = (BucketCursor + 1) % NumBuckets;
+			ActorCursor = 0;
+		}
+	}
+	bTickingBatch = false;
+
+	// Highest slots first, so no pending slot is swapped into an earlier one.
+	PendingRemovals.Sort([](const FIntPoint& A, const FIntPoint& B) { return A.Y > B.Y; });
+	for (const FIntPoint& Removal : PendingRemovals)
+	{
+		RemoveFromBucket(Removal.X, Removal.Y);
+	}
+	PendingRemovals.Reset();
+}
@@ -0,0 +1,300 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Placeables/PlacementGenerator.h"
+
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+#include "Components/PlaceablesComponent.h"
+#include "Placeables/PlaceablesSubsystem.h"
+#include "Profiling/MonatyStats.h"
+
+uint32 FPlacementGeneratorResult::GetChecksum() const
+{
+	uint32 Crc = 0;
+	for (const FSavedPlacement& Placement : Placements)
+	{
+		Crc = FCrc::StrCrc32(*GetPathNameSafe(Placement.PlacedActorClass), Crc);
+		const FVector3f Location(Placement.Transform.GetLocation());
+		const FQuat4f Rotation(Placement.Transform.GetRotation());
+		Crc = FCrc::MemCrc32(&Location, sizeof(Location), Crc);
+		Crc = FCrc::MemCrc32(&Rotation, sizeof(Rotation), Crc);
+	}
+	return Crc;
+}
+
+double FPlacementGeneratorResult::GetPlacementsPerSecond() const
+{
+	const double Seconds = ExpandSeconds + ProbeSeconds + ValidateSeconds;
+	return Seconds > 0.0 ? Placements.Num() / Seconds : 0.0;
+}
+
+FPlacementGenerator::FPlacementGenerator(UWorld* InWorld, const UDataTable* TemplateTable) : World(InWorld)
+{
+	if (!TemplateTable)
+	{
+		return;
+	}
+	float TotalWeight = 0.0f;
+	TemplateTable->ForeachRow<FPlacementTemplate>(
+		TEXT("FPlacementGenerator"), [this, &TotalWeight](const FName& RowName, const FPlacementTemplate& Row)
+		{
+			FTemplate Template;
+			Template.Radius = Row.Radius;
+			for (const FPlacementTemplatePiece& Piece : Row.Pieces)
+			{
+				const FPlaceableData* Data = Piece.Placeable.GetRow<FPlaceableData>(TEXT("FPlacementGenerator"));
+				if (!Data || !Data->PlacedActorClass)
+				{
+					UE_LOG(LogTemp, Warning,
+					       TEXT("FPlacementGenerator::FPlacementGenerator | Template %s has a piece without a placeable!"),
+					       *RowName.ToString());
+					continue;
+				}
+				Template.Pieces.Add({Data, Piece.Transform});
+			}
+			if (Template.Pieces.Num() == 0 || Row.Weight <= 0.0f)
+			{
+				return;
+			}
+			TotalWeight += Row.Weight;
+			CumulativeWeights.Add(TotalWeight);
+			MaxRadius = FMath::Max(MaxRadius, Row.Radius);
+			Templates.Add(MoveTemp(Template));
+		});
+}
+
+int32 FPlacementGenerator::PickTemplate(float Roll) const
+{
+	return FMath::Min(Algo::UpperBound(CumulativeWeights, Roll), Templates.Num() - 1);
+}
+
+void FPlacementGenerator::Generate(const FPlacementGeneratorSettings& Settings,
+                                   FPlacementGeneratorResult& OutResult) const
+{
+	MONATY_SCOPED_STAT(STAT_MonatyPlacementGenerate);
+	OutResult = {};
+	if (!World || Templates.Num() == 0 || Settings.SiteCount <= 0)
+	{
+		return;
+	}
+	const EParallelForFlags Flags = Settings.bSingleThreaded
+		                                ? EParallelForFlags::ForceSingleThread
+		                                : EParallelForFlags::None;
+	const int32 SiteCount = Settings.SiteCount;
+
+	// Every site rolls its template, location and yaw from its own stream.
+	double StartTime = FPlatformTime::Seconds();
+	TArray<int32> SiteTemplates;
+	TArray<FTransform> SiteTransforms;
+	SiteTemplates.SetNumUninitialized(SiteCount);
+	SiteTransforms.SetNum(SiteCount);
+	ParallelFor(SiteCount, [&](int32 Site)
+	{
+		const uint32 SiteSeed = HashCombine(static_cast<uint32>(Settings.Seed), static_cast<uint32>(Site));
+		FRandomStream Random(static_cast<int32>(SiteSeed));
+		SiteTemplates[Site] = PickTemplate(Random.FRand() * CumulativeWeights.Last());
+		const FVector Location(Random.FRandRange(Settings.Area.Min.X, Settings.Area.Max.X),
+		                       Random.FRandRange(Settings.Area.Min.Y, Settings.Area.Max.Y), 0.0f);
+		SiteTransforms[Site] = FTransform(FRotator(0.0f, Random.FRandRange(0.0f, 360.0f), 0.0f), Location);
+	}, Flags);
+
+	// Every piece gets a fixed slot, the pieces of a site are next to each other.
+	TArray<int32> FirstCandidates;
+	FirstCandidates.SetNumUninitialized(SiteCount + 1);
+	int32 CandidateCount = 0;
+	for (int32 Site = 0; Site < SiteCount; Site++)
+	{
+		FirstCandidates[Site] = CandidateCount;
+		CandidateCount += Templates[SiteTemplates[Site]].Pieces.Num();
+	}
+	FirstCandidates[SiteCount] = CandidateCount;
+	TArray<FCandidate> Candidates;
+	Candidates.SetNum(CandidateCount);
+	ParallelFor(SiteCount, [&](int32 Site)
+	{
+		const TArray<FPiece>& Pieces = Templates[SiteTemplates[Site]].Pieces;
+		for (int32 PieceIndex = 0; PieceIndex < Pieces.Num(); PieceIndex++)
+		{
+			FCandidate& Candidate = Candidates[FirstCandidates[Site] + PieceIndex];
+			Candidate.Site = Site;
+			Candidate.Data = Pieces[PieceIndex].Data;
+			Candidate.Transform = Pieces[PieceIndex].Transform * SiteTransforms[Site];
+		}
+	}, Flags);
+	double Now = FPlatformTime::Seconds();
+	OutResult.ExpandSeconds = Now - StartTime;
+
+	StartTime = Now;
+	ParallelFor(CandidateCount, [&](int32 Index)
+	{
+		ProbeCandidate(Candidates[Index], Settings);
+	}, Flags);
+	Now = FPlatformTime::Seconds();
+	OutResult.ProbeSeconds = Now - StartTime;
+
+	// Accept in site order, so earlier sites win over later ones whatever thread probed them.
+	StartTime = Now;
+	UPlaceablesSubsystem* Placeables = World->GetSubsystem<UPlaceablesSubsystem>();
+	const float CellSize = FMath::Max(MaxRadius * 2.0f, 100.0f);
+	TMap<FIntPoint, TArray<int32>> AcceptedCells;
+	TArray<AActor*> Existing;
+	for (int32 Site = 0; Site < SiteCount; Site++)
+	{
+		bool bAccepted = true;
+		for (int32 Index = FirstCandidates[Site]; Index < FirstCandidates[Site + 1] && bAccepted; Index++)
+		{
+			bAccepted = Candidates[Index].bGrounded;
+		}
+
+		// Clear of the sites accepted so far, the radii are at most half a cell so neighbours are enough.
+		const float Radius = Templates[SiteTemplates[Site]].Radius;
+		const FVector2D Center(SiteTransforms[Site].GetLocation());
+		const FIntPoint Cell(FMath::FloorToInt(Center.X / CellSize), FMath::FloorToInt(Center.Y / CellSize));
+		for (int32 X = -1; X <= 1 && bAccepted; X++)
+		{
+			for (int32 Y = -1; Y <= 1 && bAccepted; Y++)
+			{
+				const TArray<int32>* Others = AcceptedCells.Find(Cell + FIntPoint(X, Y));
+				for (int32 OtherIndex = 0; Others && OtherIndex < Others->Num() && bAccepted; OtherIndex++)
+				{
+					const int32 Other = (*Others)[OtherIndex];
+					const float Clearance = Radius + Templates[SiteTemplates[Other]].Radius;
+					bAccepted = FVector2D::DistSquared(Center, FVector2D(SiteTransforms[Other].GetLocation())) >
+						FMath::Square(Clearance);
+				}
+			}
+		}
+
+		// And of what is already built.
+		if (bAccepted && Placeables)
+		{
+			Existing.Reset();
+			const FBox Bounds(FVector(Center - FVector2D(Radius), Settings.ProbeBottom),
+			                  FVector(Center + FVector2D(Radius), Settings.ProbeTop));
+			bAccepted = Placeables->QueryPlacements(FPlacementQuery::InBox(Bounds), Existing) == 0;
+		}
+
+		if (!bAccepted)
+		{
+			OutResult.SitesRejected++;
+			continue;
+		}
+		OutResult.SitesAccepted++;
+		AcceptedCells.FindOrAdd(Cell).Add(Site);
+		for (int32 Index = FirstCandidates[Site]; Index < FirstCandidates[Site + 1]; Index++)
+		{
+			OutResult.Placements.Add({Candidates[Index].Data->PlacedActorClass, Candidates[Index].Transform});
+		}
+	}
+	OutResult.ValidateSeconds = FPlatformTime::Seconds() - StartTime;
+}
+
+void FPlacementGenerator::ProbeCandidate(FCandidate& Candidate, const FPlacementGeneratorSettings& Settings) const
+{
+	constexpr int32 NumProbes = UPlaceablesComponent::NumFootprintProbes;
+	const FPlaceableData& Data = *Candidate.Data;
+	const FVector2D Extent = Data.bConformToSurface ? Data.FootprintExtent : FVector2D::ZeroVector;
+	FVector LocalPoints[NumProbes];
+	UPlaceablesComponent::GetFootprintProbePoints(Extent, LocalPoints);
+	// Upright placeables only probe the center, the last point.
+	const bool bUpright = Extent.IsZero();
+	const int32 FirstProbe = bUpright ? NumProbes - 1 : 0;
+
+	// The piece keeps its height over the ground from the template, so stacked pieces stay stacked.
+	const FVector Location = Candidate.Transform.GetLocation();
+	const FTransform Upright(FRotator(0.0f, Candidate.Transform.Rotator().Yaw, 0.0f), Location);
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(PlacementGenerator), true);
+	FVector Points[NumProbes];
+	FHitResult Hit;
+	for (int32 Index = FirstProbe; Index < NumProbes; Index++)
+	{
+		const FVector Point = Upright.TransformPosition(LocalPoints[Index]);
+		if (!World->LineTraceSingleByChannel(Hit, FVector(Point.X, Point.Y, Settings.ProbeTop),
+		                                     FVector(Point.X, Point.Y, Settings.ProbeBottom), ECC_Visibility,
+		                                     QueryParams))
+		{
+			return;
+		}
+		Points[Index] = Hit.ImpactPoint;
+	}
+
+	if (bUpright)
+	{
+		const float SlopeAngle = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(Hit.ImpactNormal.Z, -1.0, 1.0)));
+		Candidate.bGrounded = SlopeAngle <= Data.MaxSlopeAngle;
+		Candidate.Transform.SetLocation(Hit.ImpactPoint + FVector(0.0f, 0.0f, Location.Z));
+		return;
+	}
+
+	// Same fit as a player placing it.
+	FVector Normal;
+	FVector Centroid;
+	float SlopeAngle;
+	float Gap;
+	UPlaceablesComponent::FitFootprintPlane(Points, Normal, Centroid, SlopeAngle, Gap);
+	if (SlopeAngle > Data.MaxSlopeAngle || Gap > Data.MaxGap)
+	{
+		return;
+	}
+	const float PlaneZ = Centroid.Z - (Normal.X * (Location.X - Centroid.X) + Normal.Y * (Location.Y - Centroid.Y)) /
+		Normal.Z;
+	Candidate.Transform.SetRotation(FQuat::FindBetweenNormals(FVector::UpVector, Normal) *
+		Candidate.Transform.GetRotation());
+	Candidate.Transform.SetLocation(FVector(Location.X, Location.Y, PlaneZ + Location.Z));
+	Candidate.bGrounded = true;
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice GeneratePlacementsCommand(
+	TEXT("Monaty.Placeables.Generate"),
+	TEXT("Seeds the world with placement templates. ")
+	TEXT("Usage: Monaty.Placeables.Generate Templates=/Game/Path.Table [Seed=0] [Sites=1000] [Size=100000] [verify] [preview]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+		[](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			UPlaceablesSubsystem* Placeables = World ? World->GetSubsystem<UPlaceablesSubsystem>() : nullptr;
+			if (!Placeables || World->GetNetMode() == NM_Client)
+			{
+				Ar.Log(TEXT("Placements can only be generated on the server"));
+				return;
+			}
+			const FString Joined = FString::Join(Args, TEXT(" "));
+			FString TemplatesPath;
+			FParse::Value(*Joined, TEXT("Templates="), TemplatesPath);
+			const FPlacementGenerator Generator(World, LoadObject<UDataTable>(nullptr, *TemplatesPath));
+			if (!Generator.HasTemplates())
+			{
+				Ar.Logf(TEXT("No usable templates in %s"), *TemplatesPath);
+				return;
+			}
+			FPlacementGeneratorSettings Settings;
+			float Size = 100000.0f;
+			FParse::Value(*Joined, TEXT("Seed="), Settings.Seed);
+			FParse::Value(*Joined, TEXT("Sites="), Settings.SiteCount);
+			FParse::Value(*Joined, TEXT("Size="), Size);
+			Settings.Area = FBox2D(FVector2D(-Size / 2.0f), FVector2D(Size / 2.0f));
+
+			FPlacementGeneratorResult Result;
+			Generator.Generate(Settings, Result);
+			Ar.Logf(TEXT("Seed %d: %d sites accepted, %d rejected, %d placements. Expand %.1f ms, probe %.1f ms, ")
+			        TEXT("validate %.1f ms, %.0f placements/s, checksum %08x"),
+			        Settings.Seed, Result.SitesAccepted, Result.SitesRejected, Result.Placements.Num(),
+			        Result.ExpandSeconds * 1000.0, Result.ProbeSeconds * 1000.0, Result.ValidateSeconds * 1000.0,
+			        Result.GetPlacementsPerSecond(), Result.GetChecksum());
+
+			if (Args.Contains(TEXT("verify")))
+			{
+				FPlacementGeneratorResult SingleThreaded;
+				Settings.bSingleThreaded = true;
+				Generator.Generate(Settings, SingleThreaded);
+				Ar.Logf(TEXT("Single threaded: %.0f placements/s, checksum %08x, %s"),
+				        SingleThreaded.GetPlacementsPerSecond(), SingleThreaded.GetChecksum(),
+				        SingleThreaded.GetChecksum() == Result.GetChecksum() ? TEXT("Match") : TEXT("Mismatch"));
+			}
+			if (!Args.Contains(TEXT("preview")))
+			{
+				const double StartTime = FPlatformTime::Seconds();
+				const int32 Spawned = Placeables->SpawnPlacedActors(Result.Placements);
+				Ar.Logf(TEXT("Committed %d placements in %.1f ms"), Spawned,
+				        (FPlatformTime::Seconds() - StartTime) * 1000.0);
+			}
+		}));
@@ -0,0 +1,287 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Placeables/PlacementJournal.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+void FPlacementRecord::Serialize(FArchive& Ar, uint32 Version)
+{
+	Ar << Id;
+	Ar << bRemoved;
+	if (!bRemoved)
+	{
+		Ar << ClassPath;
+		Ar << Transform;
+		// Journal entries from before version 2 end here, their payload tells.
+		if (Version >= 2 && (!Ar.IsLoading() || !Ar.AtEnd()))
+		{
+			Ar << OwnerId;
+		}
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FPlacementRecord& Record)
+{
+	Record.Serialize(Ar, FPlacementJournal::SnapshotVersion);
+	return Ar;
+}
+
+FPlacementJournal::FPlacementJournal(const FString& InDirectory)
+	: SnapshotPath(InDirectory / TEXT("Snapshot.bin")), JournalPath(InDirectory / TEXT("Journal.bin"))
+{
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+FPlacementJournal::~FPlacementJournal()
+{
+	Shutdown();
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+}
+
+bool FPlacementJournal::Recover(const FString& Directory, TArray<FPlacementRecord>& OutRecords,
+                                int64* OutJournalValidSize)
+{
+	TMap<uint32, FPlacementRecord> Records;
+	TArray<uint8> Bytes;
+	if (FFileHelper::LoadFileToArray(Bytes, *(Directory / TEXT("Snapshot.bin")), FILEREAD_Silent))
+	{
+		FMemoryReader Reader(Bytes);
+		uint32 Magic = 0;
+		uint32 Version = 0;
+		int32 Count = 0;
+		Reader << Magic << Version << Count;
+		if (Magic != SnapshotMagic || Version < 1 || Version > SnapshotVersion)
+		{
+			UE_LOG(LogTemp, Error, TEXT("FPlacementJournal::Recover | Snapshot in %s is not readable!"), *Directory);
+			return false;
+		}
+		for (int32 Index = 0; Index < Count && !Reader.IsError(); Index++)
+		{
+			FPlacementRecord Record;
+			Record.Serialize(Reader, Version);
+			Records.Add(Record.Id, MoveTemp(Record));
+		}
+		// Snapshots are swapped in whole, a short one is damaged rather than torn.
+		if (Reader.IsError())
+		{
+			UE_LOG(LogTemp, Error, TEXT("FPlacementJournal::Recover | Snapshot in %s is truncated!"), *Directory);
+			return false;
+		}
+	}
+
+	int32 ReplayedCount = 0;
+	int64 ValidSize = 0;
+	if (FFileHelper::LoadFileToArray(Bytes, *(Directory / TEXT("Journal.bin")), FILEREAD_Silent))
+	{
+		FMemoryReader Reader(Bytes);
+		// Each entry is size, payload and checksum. A crash can leave the last one incomplete.
+		while (Reader.Tell() + 8 <= Reader.TotalSize())
+		{
+			uint32 Size = 0;
+			Reader << Size;
+			if (Reader.Tell() + Size + 4 > Reader.TotalSize())
+			{
+				break;
+			}
+			const uint8* Payload = Bytes.GetData() + Reader.Tell();
+			Reader.Seek(Reader.Tell() + Size);
+			uint32 Checksum = 0;
+			Reader << Checksum;
+			if (Checksum != FCrc::MemCrc32(Payload, Size))
+			{
+				break;
+			}
+			TArray<uint8> PayloadBytes(Payload, Size);
+			FMemoryReader PayloadReader(PayloadBytes);
+			FPlacementRecord Record;
+			PayloadReader << Record;
+			if (Record.bRemoved)
+			{
+				Records.Remove(Record.Id);
+			}
+			else
+			{
+				Records.Add(Record.Id, MoveTemp(Record));
+			}
+			ReplayedCount++;
+			ValidSize = Reader.Tell();
+		}
+		if (ValidSize < Bytes.Num())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("FPlacementJournal::Recover | Journal in %s ends in %lld torn bytes"),
+			       *Directory, Bytes.Num() - ValidSize);
+		}
+	}
+	if (OutJournalValidSize)
+	{
+		*OutJournalValidSize = ValidSize;
+	}
+
+	Records.GenerateValueArray(OutRecords);
+	UE_LOG(LogTemp, Display, TEXT("FPlacementJournal::Recover | %d placements, %d journal records replayed"),
+	       OutRecords.Num(), ReplayedCount);
+	return true;
+}
+
+void FPlacementJournal::Quarantine(const FString& Directory)
+{
+	const FString Destination = GetQuarantineDirectory(Directory) / FDateTime::Now().ToString();
+	IFileManager::Get().MakeDirectory(*Destination, true);
+	for (const TCHAR* FileName : {TEXT("Snapshot.bin"), TEXT("Journal.bin")})
+	{
+		const FString Source = Directory / FileName;
+		if (IFileManager::Get().FileExists(*Source) && !IFileManager::Get().Move(*(Destination / FileName), *Source))
+		{
+			UE_LOG(LogTemp, Error, TEXT("FPlacementJournal::Quarantine | Could not move %s to %s!"), *Source,
+			       *Destination);
+		}
+	}
+}
+
+void FPlacementJournal::Start(TArray<FPlacementRecord>&& Recovered, int64 JournalValidSize)
+{
+	if (!Thread)
+	{
+		// The writer thread owns these once it runs.
+		for (FPlacementRecord& Record : Recovered)
+		{
+			LiveRecords.Add(Record.Id, MoveTemp(Record));
+		}
+		RecoveredJournalSize = JournalValidSize;
+		Thread = FRunnableThread::Create(this, TEXT("MonatyPlacementJournal"), 0, TPri_BelowNormal);
+	}
+}
+
+void FPlacementJournal::Shutdown()
+{
+	if (Thread)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+void FPlacementJournal::Stop()
+{
+	bStopping = true;
+	WakeEvent->Trigger();
+}
+
+uint32 FPlacementJournal::Run()
+{
+	// LiveRecords starts from what is on disk, so compaction keeps placements from earlier sessions. Folding the
+	// recovered journal into the snapshot drops a torn tail and starts the record count at an empty journal. Without a
+	// new snapshot the tail is cut off instead, appending after it would hide the new records.
+	if (!Compact())
+	{
+		TruncateJournal(RecoveredJournalSize);
+		OpenJournal();
+	}
+
+	while (!bStopping)
+	{
+		WakeEvent->Wait(1000);
+		WriteQueuedRecords();
+	}
+	// Whatever was queued before the stop still goes out.
+	WriteQueuedRecords();
+	JournalWriter.Reset();
+	return 0;
+}
+
+void FPlacementJournal::OpenJournal()
+{
+	JournalWriter.Reset(IFileManager::Get().CreateFileWriter(*JournalPath, FILEWRITE_Append));
+	JournalRecordCount = 0;
+}
+
+void FPlacementJournal::TruncateJournal(int64 ValidSize)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *JournalPath, FILEREAD_Silent) || Bytes.Num() <= ValidSize)
+	{
+		return;
+	}
+	Bytes.SetNum(ValidSize);
+	if (!FFileHelper::SaveArrayToFile(Bytes, *JournalPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("FPlacementJournal::TruncateJournal | Could not truncate %s!"), *JournalPath);
+	}
+}
+
+void FPlacementJournal::WriteQueuedRecords()
+{
+	FPlacementRecord Record;
+	TArray<uint8> Payload;
+	bool bWroteAny = false;
+	while (Queue.Dequeue(Record))
+	{
+		Payload.Reset();
+		FMemoryWriter PayloadWriter(Payload);
+		PayloadWriter << Record;
+		if (JournalWriter)
+		{
+			uint32 Size = Payload.Num();
+			uint32 Checksum = FCrc::MemCrc32(Payload.GetData(), Payload.Num());
+			*JournalWriter << Size;
+			JournalWriter->Serialize(Payload.GetData(), Payload.Num());
+			*JournalWriter << Checksum;
+			JournalRecordCount++;
+			bWroteAny = true;
+		}
+		if (Record.bRemoved)
+		{
+			LiveRecords.Remove(Record.Id);
+		}
+		else
+		{
+			LiveRecords.Add(Record.Id, MoveTemp(Record));
+		}
+	}
+	if (bWroteAny)
+	{
+		JournalWriter->Flush();
+	}
+	if (JournalRecordCount >= CompactAfterRecords)
+	{
+		Compact();
+	}
+}
+
+bool FPlacementJournal::Compact()
+{
+	// Write the snapshot beside the old one and swap it in, so a crash never leaves a half written snapshot.
+	const FString TempPath = SnapshotPath + TEXT(".tmp");
+	{
+		TUniquePtr<FArchive> SnapshotWriter(IFileManager::Get().CreateFileWriter(*TempPath));
+		if (!SnapshotWriter)
+		{
+			return false;
+		}
+		uint32 Magic = SnapshotMagic;
+		uint32 Version = SnapshotVersion;
+		int32 Count = LiveRecords.Num();
+		*SnapshotWriter << Magic << Version << Count;
+		for (TPair<uint32, FPlacementRecord>& Pair : LiveRecords)
+		{
+			*SnapshotWriter << Pair.Value;
+		}
+	}
+	if (!IFileManager::Get().Move(*SnapshotPath, *TempPath, true))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FPlacementJournal::Compact | Could not replace %s"), *SnapshotPath);
+		return false;
+	}
+	// Everything in the journal is in the snapshot now. Replaying it again would be harmless, so the order is safe.
+	JournalWriter.Reset();
+	IFileManager::Get().Delete(*JournalPath);
+	OpenJournal();
+	return true;
+}
@@ -0,0 +1,27 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Placeables/PlacementNoBuildVolume.h"
+
+#include "Placeables/PlaceablesSubsystem.h"
+
+void APlacementNoBuildVolume::BeginPlay()
+{
+	Super::BeginPlay();
+	if (UPlaceablesSubsystem* Placeables = GetWorld()->GetSubsystem<UPlaceablesSubsystem>())
+	{
+		FPlacementZone Zone;
+		Zone.Bounds = GetComponentsBoundingBox(true);
+		Zone.Type = EPlacementZoneType::NoBuild;
+		ZoneId = Placeables->AddPlacementZone(Zone);
+	}
+}
+
+void APlacementNoBuildVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UPlaceablesSubsystem* Placeables = GetWorld()->GetSubsystem<UPlaceablesSubsystem>())
+	{
+		Placeables->RemovePlacementZone(ZoneId);
+	}
+	ZoneId = INDEX_NONE;
+	Super::EndPlay(EndPlayReason);
+}
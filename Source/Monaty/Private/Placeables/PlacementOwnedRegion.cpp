@@ -0,0 +1,75 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Placeables/PlacementOwnedRegion.h"
+
+#include "Net/UnrealNetwork.h"
+#include "Placeables/PlaceablesSubsystem.h"
+
+APlacementOwnedRegion::APlacementOwnedRegion()
+{
+	// Only changes when a region is handed out, always relevant through the AInfo route of the replication graph.
+	bReplicates = true;
+	NetUpdateFrequency = 1.0f;
+}
+
+void APlacementOwnedRegion::SetRegion(const FBox& Bounds, uint32 InOwnerId)
+{
+	if (!HasAuthority() || !Bounds.IsValid)
+	{
+		return;
+	}
+	RegionBounds = Bounds;
+	RegionOwnerId = InOwnerId;
+	ForceNetUpdate();
+	if (HasActorBegunPlay())
+	{
+		UpdateZone();
+	}
+}
+
+void APlacementOwnedRegion::BeginPlay()
+{
+	Super::BeginPlay();
+	UpdateZone();
+}
+
+void APlacementOwnedRegion::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UPlaceablesSubsystem* Placeables = GetWorld()->GetSubsystem<UPlaceablesSubsystem>())
+	{
+		Placeables->RemovePlacementZone(ZoneId);
+	}
+	ZoneId = INDEX_NONE;
+	Super::EndPlay(EndPlayReason);
+}
+
+void APlacementOwnedRegion::OnRep_Region()
+{
+	if (HasActorBegunPlay())
+	{
+		UpdateZone();
+	}
+}
+
+void APlacementOwnedRegion::UpdateZone()
+{
+	UPlaceablesSubsystem* Placeables = GetWorld()->GetSubsystem<UPlaceablesSubsystem>();
+	if (!Placeables)
+	{
+		return;
+	}
+	Placeables->RemovePlacementZone(ZoneId);
+	FPlacementZone Zone;
+	Zone.Bounds = RegionBounds;
+	Zone.Type = EPlacementZoneType::Owned;
+	Zone.OwnerId = RegionOwnerId;
+	ZoneId = Placeables->AddPlacementZone(Zone);
+}
+
+void APlacementOwnedRegion::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(APlacementOwnedRegion, RegionBounds);
+	DOREPLIFETIME(APlacementOwnedRegion, RegionOwnerId);
+}
@@ -0,0 +1,29 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Placeables/PlacementRemovals.h"
+
+#include "AI/NavigationSystemBase.h"
+
+APlacementRemovals::APlacementRemovals()
+{
+	// Only sends multicasts, always relevant through the AInfo route of the replication graph.
+	bReplicates = true;
+	NetUpdateFrequency = 1.0f;
+}
+
+void APlacementRemovals::Multicast_RemovePlacements_Implementation(const TArray<AActor*>& Placements)
+{
+	// The server destroys its own after sending this.
+	if (HasAuthority())
+	{
+		return;
+	}
+	FNavigationLockContext NavigationLock(GetWorld(), ENavigationLockReason::Unknown);
+	for (AActor* Placement : Placements)
+	{
+		if (IsValid(Placement))
+		{
+			Placement->Destroy(true);
+		}
+	}
+}
@@ -0,0 +1,114 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Placeables/PlacementRules.h"
+
+const TCHAR* GetPlacementRuleName(EPlacementRule Rule)
+{
+	switch (Rule)
+	{
+	case EPlacementRule::None:
+		return TEXT("None");
+	case EPlacementRule::PlayerCap:
+		return TEXT("PlayerCap");
+	case EPlacementRule::Slope:
+		return TEXT("Slope");
+	case EPlacementRule::NoBuildZone:
+		return TEXT("NoBuildZone");
+	case EPlacementRule::OthersRegion:
+		return TEXT("OthersRegion");
+	case EPlacementRule::OutsideOwnRegion:
+		return TEXT("OutsideOwnRegion");
+	case EPlacementRule::Spacing:
+		return TEXT("Spacing");
+	default:
+		return TEXT("Unknown");
+	}
+}
+
+/* Program */
+
+FPlacementRuleProgram FPlacementRuleProgram::Compile(const FPlacementRules& Rules, const UClass* InPlacedActorClass)
+{
+	FPlacementRuleProgram Program;
+	Program.PlacedActorClass = InPlacedActorClass;
+	// Same for every candidate of a batch, so it goes first and usually rejects all or none.
+	if (Rules.MaxPerPlayer > 0)
+	{
+		Program.Ops.Add({EPlacementRule::PlayerCap, static_cast<float>(Rules.MaxPerPlayer)});
+	}
+	if (Rules.MaxSurfaceAngle < 90.0f)
+	{
+		Program.Ops.Add({EPlacementRule::Slope, FMath::Cos(FMath::DegreesToRadians(Rules.MaxSurfaceAngle))});
+	}
+	if (Rules.bBlockedByNoBuildZones)
+	{
+		Program.Ops.Add({EPlacementRule::NoBuildZone});
+	}
+	if (Rules.Ownership == EPlacementOwnershipRule::NotInOthersRegions)
+	{
+		Program.Ops.Add({EPlacementRule::OthersRegion});
+	}
+	else if (Rules.Ownership == EPlacementOwnershipRule::InOwnRegion)
+	{
+		Program.Ops.Add({EPlacementRule::OutsideOwnRegion});
+	}
+	// Looks at the placements around the candidate, the most expensive.
+	if (Rules.MinSpacing > 0.0f)
+	{
+		Program.Ops.Add({EPlacementRule::Spacing, Rules.MinSpacing});
+	}
+	return Program;
+}
+
+/* Zones */
+
+FIntPoint FPlacementZoneIndex::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+int32 FPlacementZoneIndex::Add(const FPlacementZone& Zone)
+{
+	if (!Zone.Bounds.IsValid)
+	{
+		return INDEX_NONE;
+	}
+	const int32 ZoneId = Zones.Add(Zone);
+	const FIntPoint MinCell = GetCell(Zone.Bounds.Min);
+	const FIntPoint MaxCell = GetCell(Zone.Bounds.Max);
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			Cells.FindOrAdd(FIntPoint(X, Y)).Add(ZoneId);
+		}
+	}
+	return ZoneId;
+}
+
+void FPlacementZoneIndex::Remove(int32 ZoneId)
+{
+	if (!Zones.IsValidIndex(ZoneId))
+	{
+		return;
+	}
+	const FBox& Bounds = Zones[ZoneId].Bounds;
+	const FIntPoint MinCell = GetCell(Bounds.Min);
+	const FIntPoint MaxCell = GetCell(Bounds.Max);
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			const FIntPoint Cell(X, Y);
+			if (TArray<int32>* CellZones = Cells.Find(Cell))
+			{
+				CellZones->RemoveSingleSwap(ZoneId, false);
+				if (CellZones->Num() == 0)
+				{
+					Cells.Remove(Cell);
+				}
+			}
+		}
+	}
+	Zones.RemoveAt(ZoneId);
+}
@@ -0,0 +1,168 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Placeables/PlacementSpatialIndex.h"
+
+#include "GameFramework/Actor.h"
+
+/* Query */
+
+FPlacementQuery FPlacementQuery::InBox(const FBox& InBox)
+{
+	FPlacementQuery Query;
+	Query.Shape = EShape::Box;
+	Query.Box = InBox;
+	return Query;
+}
+
+FPlacementQuery FPlacementQuery::InSphere(const FVector& InCenter, float InRadius)
+{
+	FPlacementQuery Query;
+	Query.Shape = EShape::Sphere;
+	Query.Center = InCenter;
+	Query.Radius = InRadius;
+	return Query;
+}
+
+FPlacementQuery FPlacementQuery::OwnedBy(const TSet<uint32>& InOwners)
+{
+	FPlacementQuery Query;
+	Query.Owners = InOwners;
+	return Query;
+}
+
+FBox FPlacementQuery::GetBounds() const
+{
+	switch (Shape)
+	{
+	case EShape::Box:
+		return Box;
+	case EShape::Sphere:
+		return FBox(Center - FVector(Radius), Center + FVector(Radius));
+	default:
+		return FBox(ForceInit);
+	}
+}
+
+bool FPlacementQuery::Matches(const FVector& Location, uint32 OwnerId) const
+{
+	if (Owners.Num() > 0 && !Owners.Contains(OwnerId))
+	{
+		return false;
+	}
+	switch (Shape)
+	{
+	case EShape::Box:
+		return Box.IsInsideOrOn(Location);
+	case EShape::Sphere:
+		return FVector::DistSquared(Location, Center) <= FMath::Square(Radius);
+	default:
+		return true;
+	}
+}
+
+/* Index */
+
+FIntPoint FPlacementSpatialIndex::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void FPlacementSpatialIndex::Add(AActor* Actor, uint32 OwnerId)
+{
+	if (!Actor || ActorEntries.Contains(Actor))
+	{
+		return;
+	}
+	FEntry Entry;
+	Entry.Actor = Actor;
+	Entry.Location = Actor->GetActorLocation();
+	Entry.OwnerId = OwnerId;
+	const int32 EntryIndex = Entries.Add(Entry);
+	Entries[EntryIndex].CellSlot = Cells.FindOrAdd(GetCell(Entry.Location)).Add(EntryIndex);
+	Entries[EntryIndex].OwnerSlot = OwnerEntries.FindOrAdd(OwnerId).Add(EntryIndex);
+	ActorEntries.Add(Actor, EntryIndex);
+}
+
+void FPlacementSpatialIndex::Remove(const AActor* Actor)
+{
+	int32 EntryIndex = INDEX_NONE;
+	if (!ActorEntries.RemoveAndCopyValue(Actor, EntryIndex))
+	{
+		return;
+	}
+	const FEntry& Entry = Entries[EntryIndex];
+	const FIntPoint Cell = GetCell(Entry.Location);
+	if (TArray<int32>* CellEntries = Cells.Find(Cell))
+	{
+		CellEntries->RemoveAtSwap(Entry.CellSlot, 1, false);
+		if (CellEntries->IsValidIndex(Entry.CellSlot))
+		{
+			Entries[(*CellEntries)[Entry.CellSlot]].CellSlot = Entry.CellSlot;
+		}
+		else if (CellEntries->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+	if (TArray<int32>* Owned = OwnerEntries.Find(Entry.OwnerId))
+	{
+		Owned->RemoveAtSwap(Entry.OwnerSlot, 1, false);
+		if (Owned->IsValidIndex(Entry.OwnerSlot))
+		{
+			Entries[(*Owned)[Entry.OwnerSlot]].OwnerSlot = Entry.OwnerSlot;
+		}
+		else if (Owned->Num() == 0)
+		{
+			OwnerEntries.Remove(Entry.OwnerId);
+		}
+	}
+	Entries.RemoveAt(EntryIndex);
+}
+
+FPlacementSpatialIndex::FEntry* FPlacementSpatialIndex::Find(const AActor* Actor)
+{
+	const int32* EntryIndex = ActorEntries.Find(Actor);
+	return EntryIndex ? &Entries[*EntryIndex] : nullptr;
+}
+
+bool FPlacementSpatialIndex::AnyWithin(const FVector& Location, float Radius) const
+{
+	const FIntPoint MinCell = GetCell(Location - FVector(Radius));
+	const FIntPoint MaxCell = GetCell(Location + FVector(Radius));
+	const float RadiusSquared = FMath::Square(Radius);
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			const TArray<int32>* EntryIndices = Cells.Find(FIntPoint(X, Y));
+			if (!EntryIndices)
+			{
+				continue;
+			}
+			for (const int32 EntryIndex : *EntryIndices)
+			{
+				if (FVector::DistSquared(Entries[EntryIndex].Location, Location) <= RadiusSquared)
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+int32 FPlacementSpatialIndex::CountOwned(uint32 OwnerId, const UClass* Class) const
+{
+	const TArray<int32>* Owned = OwnerEntries.Find(OwnerId);
+	if (!Owned || !Class)
+	{
+		return Owned ? Owned->Num() : 0;
+	}
+	int32 Count = 0;
+	for (const int32 EntryIndex : *Owned)
+	{
+		const AActor* Actor = Entries[EntryIndex].Actor.Get();
+		Count += Actor && Actor->IsA(Class);
+	}
+	return Count;
+}
@@ -0,0 +1,544 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Profiling/MonatyBenchmark.h"
+
+#include "EngineUtils.h"
+#include "Character/MonatyCharacter.h"
+#include "Curves/CurveFloat.h"
+#include "Curves/CurveVector.h"
+#include "Engine/DataTable.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerStart.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+bool FMonatyBenchmarkTimers::bEnabled = false;
+uint64 FMonatyBenchmarkTimers::FrameCycles[static_cast<int32>(EMonatyBenchmarkScope::Count)] = {};
+
+const TCHAR* FMonatyBenchmarkTimers::GetScopeName(EMonatyBenchmarkScope Scope)
+{
+	switch (Scope)
+	{
+	case EMonatyBenchmarkScope::CharacterTick:
+		return TEXT("CharacterTick");
+	case EMonatyBenchmarkScope::PhysWalking:
+		return TEXT("PhysWalking");
+	case EMonatyBenchmarkScope::GetMaxAcceleration:
+		return TEXT("GetMaxAcceleration");
+	case EMonatyBenchmarkScope::GetMaxBrakingDeceleration:
+		return TEXT("GetMaxBrakingDeceleration");
+	case EMonatyBenchmarkScope::OnMovementUpdated:
+		return TEXT("OnMovementUpdated");
+	case EMonatyBenchmarkScope::ServerReplicateActors:
+		return TEXT("ServerReplicateActors");
+	case EMonatyBenchmarkScope::PlacedLogicTick:
+		return TEXT("PlacedLogicTick");
+	default:
+		return TEXT("Unknown");
+	}
+}
+
+void FMonatyBenchmarkTimers::ResetFrame()
+{
+	FMemory::Memzero(FrameCycles);
+}
+
+double FMonatyBenchmarkSeries::GetPercentile(double Percentile) const
+{
+	if (Samples.Num() == 0)
+	{
+		return 0.0;
+	}
+	TArray<double> Sorted = Samples;
+	Sorted.Sort();
+	// Nearest rank.
+	const int32 Rank = FMath::CeilToInt(Percentile / 100.0 * Sorted.Num()) - 1;
+	return Sorted[FMath::Clamp(Rank, 0, Sorted.Num() - 1)];
+}
+
+double FMonatyBenchmarkSeries::GetMean() const
+{
+	if (Samples.Num() == 0)
+	{
+		return 0.0;
+	}
+	double Sum = 0.0;
+	for (const double Sample : Samples)
+	{
+		Sum += Sample;
+	}
+	return Sum / Samples.Num();
+}
+
+FMonatyBenchmarkSeries& FMonatyBenchmarkReport::AddSeries(const FString& SeriesName)
+{
+	FMonatyBenchmarkSeries& NewSeries = Series.AddDefaulted_GetRef();
+	NewSeries.Name = SeriesName;
+	return NewSeries;
+}
+
+bool FMonatyBenchmarkReport::SaveCsv() const
+{
+	FString Csv = TEXT("Series,Samples,Mean,P50,P90,P99,Max\n");
+	for (const FMonatyBenchmarkSeries& Entry : Series)
+	{
+		const FString Row = FString::Printf(TEXT("%s,%d,%.4f,%.4f,%.4f,%.4f,%.4f"), *Entry.Name, Entry.Samples.Num(),
+		                                    Entry.GetMean(), Entry.GetPercentile(50.0), Entry.GetPercentile(90.0),
+		                                    Entry.GetPercentile(99.0), Entry.GetPercentile(100.0));
+		UE_LOG(LogTemp, Display, TEXT("%s | %s"), *Name, *Row);
+		Csv += Row + TEXT("\n");
+	}
+	const FString FilePath = FPaths::ProfilingDir() / TEXT("Monaty") /
+		FString::Printf(TEXT("%s-%s.csv"), *Name, *FDateTime::Now().ToString());
+	return FFileHelper::SaveStringToFile(Csv, *FilePath);
+}
+
+void UMonatyLocomotionBenchmark::StartBenchmark(const TArray<int32>& InCharacterCounts, int32 InMeasuredFrames,
+                                                bool bInExitWhenDone, bool bInSimulatedProxies,
+                                                bool bLightweightProxies)
+{
+	if (IsRunning() || InCharacterCounts.Num() == 0)
+	{
+		return;
+	}
+	if (bLightweightProxies)
+	{
+		OverrideConsoleVariable(TEXT("monaty.Proxy.Lightweight"), true);
+	}
+	CharacterCounts = InCharacterCounts;
+	CompletedReports.Reset();
+	MeasuredFrames = InMeasuredFrames;
+	bExitWhenDone = bInExitWhenDone;
+	bSimulatedProxies = bInSimulatedProxies;
+	CurrentRunIndex = 0;
+	StartRun();
+}
+
+void UMonatyLocomotionBenchmark::Deinitialize()
+{
+	// The world can go away in the middle of a benchmark.
+	RestoreConsoleVariables();
+	Super::Deinitialize();
+}
+
+void UMonatyLocomotionBenchmark::Tick(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+	const double FrameMs = (Now - LastFrameTime) * 1000.0;
+	LastFrameTime = Now;
+
+	// Record the frame that just finished, then feed the next one.
+	if (FrameIndex >= WarmupFrames)
+	{
+		Report.Series[0].Samples.Add(FrameMs);
+		for (int32 ScopeIndex = 0; ScopeIndex < static_cast<int32>(EMonatyBenchmarkScope::Count); ScopeIndex++)
+		{
+			Report.Series[ScopeIndex + 1].Samples.Add(
+				FPlatformTime::ToMilliseconds64(FMonatyBenchmarkTimers::FrameCycles[ScopeIndex]));
+		}
+	}
+	FMonatyBenchmarkTimers::ResetFrame();
+	FMonatyBenchmarkTimers::bEnabled = FrameIndex + 1 >= WarmupFrames;
+
+	if (++FrameIndex >= WarmupFrames + MeasuredFrames)
+	{
+		FinishRun();
+		return;
+	}
+	if (bSimulatedProxies)
+	{
+		ApplyScriptedNetUpdates();
+	}
+	else
+	{
+		ApplyScriptedInput();
+	}
+}
+
+TStatId UMonatyLocomotionBenchmark::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMonatyLocomotionBenchmark, STATGROUP_Tickables);
+}
+
+UDataTable* UMonatyLocomotionBenchmark::GetMovementModelTable()
+{
+	if (MovementModelTable)
+	{
+		return MovementModelTable;
+	}
+	auto MakeSettings = [this](float WalkSpeed, float SprintSpeed)
+	{
+		FPlayerMovementSettings Settings;
+		Settings.WalkSpeed = WalkSpeed;
+		Settings.SprintSpeed = SprintSpeed;
+
+		// X = Acceleration, Y = Braking Deceleration, Z = Ground Friction.
+		Settings.MovementCurve = NewObject<UCurveVector>(this);
+		const FVector Keys[] = {{2000.0f, 1500.0f, 8.0f}, {2000.0f, 1500.0f, 8.0f}, {1000.0f, 800.0f, 6.0f}};
+		for (int32 KeyIndex = 0; KeyIndex < UE_ARRAY_COUNT(Keys); KeyIndex++)
+		{
+			Settings.MovementCurve->FloatCurves[0].AddKey(KeyIndex, Keys[KeyIndex].X);
+			Settings.MovementCurve->FloatCurves[1].AddKey(KeyIndex, Keys[KeyIndex].Y);
+			Settings.MovementCurve->FloatCurves[2].AddKey(KeyIndex, Keys[KeyIndex].Z);
+		}
+
+		Settings.RotationRateCurve = NewObject<UCurveFloat>(this);
+		Settings.RotationRateCurve->FloatCurve.AddKey(0.0f, 8.0f);
+		Settings.RotationRateCurve->FloatCurve.AddKey(1.0f, 8.0f);
+		Settings.RotationRateCurve->FloatCurve.AddKey(2.0f, 12.0f);
+		return Settings;
+	};
+
+	FPlayerMovementModel Model;
+	Model.Standing = MakeSettings(165.0f, 600.0f);
+	Model.Crouching = MakeSettings(150.0f, 300.0f);
+
+	MovementModelTable = NewObject<UDataTable>(this);
+	MovementModelTable->RowStruct = FPlayerMovementModel::StaticStruct();
+	MovementModelTable->AddRow(TEXT("Benchmark"), Model);
+	return MovementModelTable;
+}
+
+AMonatyCharacter* UMonatyLocomotionBenchmark::SpawnBenchmarkCharacter(const FTransform& SpawnTransform)
+{
+	UWorld* World = GetWorld();
+	TSubclassOf<AMonatyCharacter> CharacterClass = AMonatyCharacter::StaticClass();
+	if (const AGameModeBase* GameMode = World->GetAuthGameMode())
+	{
+		if (GameMode->DefaultPawnClass && GameMode->DefaultPawnClass->IsChildOf<AMonatyCharacter>())
+		{
+			CharacterClass = GameMode->DefaultPawnClass.Get();
+		}
+	}
+	AMonatyCharacter* Character = World->SpawnActorDeferred<AMonatyCharacter>(
+		CharacterClass, SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (!Character)
+	{
+		return nullptr;
+	}
+	Character->MovementModel.DataTable = GetMovementModelTable();
+	Character->MovementModel.RowName = TEXT("Benchmark");
+	Character->FinishSpawning(SpawnTransform);
+	Character->GetCharacterMovement()->bRunPhysicsWithNoController = true;
+	return Character;
+}
+
+FMonatyInputRecording UMonatyLocomotionBenchmark::MakeVerificationRecording()
+{
+	FMonatyInputRecording Recording;
+	const float DeltaTime = 1.0f / 60.0f;
+	for (int32 Index = 0; Index < 240; Index++)
+	{
+		const float Time = Index * DeltaTime;
+		FMonatyInputFrame& Frame = Recording.Frames.AddDefaulted_GetRef();
+		Frame.DeltaTime = DeltaTime;
+		Frame.ForwardBackward = Time >= 1.5f && Time < 2.0f ? 0.0f : 1.0f;
+		Frame.LeftRight = FMath::Sin(Time * 3.0f);
+		Frame.ControlRotation = FRotator3f(0.0f, 90.0f * FMath::Sin(Time * 1.3f) + 20.0f * Time * Time, 0.0f);
+		if (Index == 30) Frame.Actions |= EMonatyInputActions::SprintPressed;
+		if (Index == 150) Frame.Actions |= EMonatyInputActions::SprintReleased;
+		if (Index == 180) Frame.Actions |= EMonatyInputActions::JumpPressed;
+		if (Index == 185) Frame.Actions |= EMonatyInputActions::JumpReleased;
+	}
+	return Recording;
+}
+
+bool UMonatyLocomotionBenchmark::RecordFixedStepInputs(const FMonatyInputRecording& Recording, float StepRate,
+                                                       TArray<FLocomotionStepInput>& OutStepInputs)
+{
+	AMonatyCharacter* Character = SpawnBenchmarkCharacter(FTransform(GetSpawnOrigin()));
+	if (!Character)
+	{
+		return false;
+	}
+	// Drive the movement component by hand, one tick per step.
+	UCharacterMovementComponent* Movement = Character->GetCharacterMovement();
+	Character->SetActorTickEnabled(false);
+	Movement->SetComponentTickEnabled(false);
+
+	double RecordedTime = 0.0;
+	for (const FMonatyInputFrame& Frame : Recording.Frames)
+	{
+		RecordedTime += Frame.DeltaTime;
+	}
+
+	// Each step takes the axes of the last recorded frame that started before it ends, and every action since.
+	const float StepTime = 1.0f / StepRate;
+	const int32 StepCount = FMath::FloorToInt(RecordedTime * StepRate);
+	OutStepInputs.Reset(StepCount);
+	FMonatyInputFrame Current;
+	int32 NextRecorded = 0;
+	double NextRecordedTime = 0.0;
+	for (int32 Step = 0; Step < StepCount; Step++)
+	{
+		const double StepEnd = (Step + 1) / static_cast<double>(StepRate);
+		Current.Actions = EMonatyInputActions::None;
+		while (Recording.Frames.IsValidIndex(NextRecorded) && NextRecordedTime < StepEnd - UE_KINDA_SMALL_NUMBER)
+		{
+			const FMonatyInputFrame& Recorded = Recording.Frames[NextRecorded++];
+			const EMonatyInputActions Actions = Current.Actions | Recorded.Actions;
+			Current = Recorded;
+			Current.Actions = Actions;
+			NextRecordedTime += Recorded.DeltaTime;
+		}
+		Character->ApplyInputFrame(Current);
+		Movement->TickComponent(StepTime, LEVELTICK_All, nullptr);
+		OutStepInputs.Add(Character->GatherLocomotionStepInput());
+	}
+	Character->Destroy();
+	return true;
+}
+
+int32 UMonatyLocomotionBenchmark::RunFixedStepInputs(const TArray<FLocomotionStepInput>& StepInputs, float StepRate,
+                                                     int32 FrameRate, FQuat& OutRotation,
+                                                     FMonatyLocomotionState& OutLocomotion)
+{
+	AMonatyCharacter* Character = SpawnBenchmarkCharacter(FTransform(GetSpawnOrigin()));
+	if (!Character)
+	{
+		return INDEX_NONE;
+	}
+	// The movement component never runs, the steps only see the queued inputs. Walking keeps them grounded.
+	Character->SetActorTickEnabled(false);
+	Character->GetCharacterMovement()->SetComponentTickEnabled(false);
+	Character->GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+	Character->bUseFixedStepLocomotion = true;
+	Character->FixedStepRate = StepRate;
+	Character->ResetFixedStepLocomotion();
+	Character->QueueFixedStepInputs(StepInputs);
+
+	const float DeltaTime = 1.0f / FrameRate;
+	// Frames can end between steps, so allow a few more than the inputs last.
+	const int32 MaxFrames = FMath::CeilToInt(StepInputs.Num() / StepRate * FrameRate) + FrameRate;
+	int32 Steps = 0;
+	for (int32 Frame = 0; Frame < MaxFrames && Character->GetQueuedFixedStepInputCount() > 0; Frame++)
+	{
+		Steps += Character->AdvanceFixedStepLocomotion(DeltaTime, FLocomotionStepInput());
+	}
+	OutRotation = Character->FixedStep->CurrentRotation;
+	OutLocomotion = Character->Locomotion;
+	Character->Destroy();
+	return Steps;
+}
+
+FVector UMonatyLocomotionBenchmark::GetSpawnOrigin() const
+{
+	for (TActorIterator<APlayerStart> It(GetWorld()); It; ++It)
+	{
+		return It->GetActorLocation();
+	}
+	return FVector::ZeroVector;
+}
+
+void UMonatyLocomotionBenchmark::StartRun()
+{
+	UWorld* World = GetWorld();
+	const int32 CharacterCount = CharacterCounts[CurrentRunIndex];
+
+	const FVector Origin = GetSpawnOrigin();
+
+	// Lay the characters out on a grid around the first player start.
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(CharacterCount)));
+	const float Spacing = 250.0f;
+	for (int32 Index = 0; Index < CharacterCount; Index++)
+	{
+		const FVector Offset((Index % GridSize - GridSize / 2) * Spacing, (Index / GridSize - GridSize / 2) * Spacing,
+		                     0.0f);
+		const FTransform SpawnTransform(Origin + Offset);
+		if (AMonatyCharacter* Character = SpawnBenchmarkCharacter(SpawnTransform))
+		{
+			if (bSimulatedProxies)
+			{
+				// Nothing replicates them here, the scripted updates stand in for the server.
+				Character->SetRole(ROLE_SimulatedProxy);
+			}
+			SpawnedCharacters.Add(Character);
+			SpawnLocations.Add(SpawnTransform.GetLocation());
+		}
+	}
+
+	Report = {};
+	Report.Name = FString::Printf(TEXT("LocomotionBenchmark-%d"), CharacterCount);
+	if (bSimulatedProxies)
+	{
+		Report.Name += IConsoleManager::Get().FindConsoleVariable(TEXT("monaty.Proxy.Lightweight"))->GetBool()
+			               ? TEXT("-LightweightProxies")
+			               : TEXT("-Proxies");
+	}
+	Report.AddSeries(TEXT("FrameMs"));
+	for (int32 ScopeIndex = 0; ScopeIndex < static_cast<int32>(EMonatyBenchmarkScope::Count); ScopeIndex++)
+	{
+		Report.AddSeries(FString::Printf(
+			TEXT("%sMs"), FMonatyBenchmarkTimers::GetScopeName(static_cast<EMonatyBenchmarkScope>(ScopeIndex))));
+	}
+	FrameIndex = 0;
+	LastFrameTime = FPlatformTime::Seconds();
+	if (bSimulatedProxies)
+	{
+		ApplyScriptedNetUpdates();
+	}
+	else
+	{
+		ApplyScriptedInput();
+	}
+}
+
+void UMonatyLocomotionBenchmark::FinishRun()
+{
+	FMonatyBenchmarkTimers::bEnabled = false;
+	Report.SaveCsv();
+	CompletedReports.Add(Report);
+	for (AMonatyCharacter* Character : SpawnedCharacters)
+	{
+		if (Character)
+		{
+			Character->Destroy();
+		}
+	}
+	SpawnedCharacters.Reset();
+	SpawnLocations.Reset();
+
+	if (CharacterCounts.IsValidIndex(++CurrentRunIndex))
+	{
+		StartRun();
+		return;
+	}
+	CurrentRunIndex = INDEX_NONE;
+	RestoreConsoleVariables();
+	if (bExitWhenDone)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void UMonatyLocomotionBenchmark::OverrideConsoleVariable(const TCHAR* Name, bool bValue)
+{
+	IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(Name);
+	if (!Variable)
+	{
+		return;
+	}
+	SavedConsoleVariables.FindOrAdd(Name, Variable->GetString());
+	Variable->Set(bValue);
+}
+
+void UMonatyLocomotionBenchmark::RestoreConsoleVariables()
+{
+	for (const TPair<FString, FString>& Saved : SavedConsoleVariables)
+	{
+		if (IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(*Saved.Key))
+		{
+			Variable->Set(*Saved.Value);
+		}
+	}
+	SavedConsoleVariables.Reset();
+}
+
+void UMonatyLocomotionBenchmark::ApplyScriptedInput()
+{
+	// Deterministic input pattern: constant forward input with weaving, turning, and periodic gait, stance and
+	// jump changes, offset per character so they don't all switch on the same frame.
+	for (int32 Index = 0; Index < SpawnedCharacters.Num(); Index++)
+	{
+		AMonatyCharacter* Character = SpawnedCharacters[Index];
+		if (!Character)
+		{
+			continue;
+		}
+		const int32 Frame = FrameIndex + Index * 7;
+		FMonatyInputFrame Input;
+		Input.ForwardBackward = 1.0f;
+		Input.LeftRight = FMath::Sin(Frame * 0.05f);
+		Input.ControlRotation = FRotator3f(0.0f, FMath::Fmod(Index * 37.0f + Frame * 1.5f, 360.0f), 0.0f);
+		if (Frame % 180 == 0) Input.Actions |= EMonatyInputActions::SprintPressed;
+		if (Frame % 180 == 90) Input.Actions |= EMonatyInputActions::SprintReleased;
+		if (Frame % 480 == 240) Input.Actions |= EMonatyInputActions::StancePressed;
+		if (Frame % 480 == 360) Input.Actions |= EMonatyInputActions::StanceReleased;
+		if (Frame % 150 == 75) Input.Actions |= EMonatyInputActions::JumpPressed;
+		if (Frame % 150 == 80) Input.Actions |= EMonatyInputActions::JumpReleased;
+		Character->ApplyInputFrame(Input);
+	}
+}
+
+void UMonatyLocomotionBenchmark::ApplyScriptedNetUpdates()
+{
+	if (FrameIndex % NetUpdateFrames != 0)
+	{
+		return;
+	}
+	// Every proxy runs circles around its spawn point, aiming along the path and sprinting every other lap.
+	const double Time = GetWorld()->GetTimeSeconds();
+	const float Radius = 100.0f;
+	const float Speed = 300.0f;
+	for (int32 Index = 0; Index < SpawnedCharacters.Num(); Index++)
+	{
+		AMonatyCharacter* Character = SpawnedCharacters[Index];
+		if (!Character)
+		{
+			continue;
+		}
+		const double Angle = Index * 0.7 + Time * Speed / Radius;
+		const FVector Direction(-FMath::Sin(Angle), FMath::Cos(Angle), 0.0);
+		const bool bSprinting = FMath::FloorToInt(Angle / UE_DOUBLE_TWO_PI) % 2 == 1;
+
+		FRepMovement& Movement = Character->GetReplicatedMovement_Mutable();
+		Movement.Location = SpawnLocations[Index] + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0) * Radius;
+		Movement.Rotation = Direction.Rotation();
+		Movement.LinearVelocity = Direction * Speed;
+		Character->ReplicatedLocomotion.Pack(Movement.Rotation, 1.0f,
+		                                     bSprinting ? EPlayerGaitState::Sprinting : EPlayerGaitState::Walking,
+		                                     EPlayerStanceState::Standing, EPlayerMovementState::Grounded,
+		                                     Direction * 1000.0f);
+		Character->OnRep_ReplicatedMovement();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs LocomotionBenchmarkCommand(
+	TEXT("Monaty.Bench.Locomotion"),
+	TEXT("Benchmarks the locomotion hot path. Usage: Monaty.Bench.Locomotion [Counts...] [frames=N] [proxies] ")
+	TEXT("[lightweight] [exit]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UMonatyLocomotionBenchmark* Benchmark = World ? World->GetSubsystem<UMonatyLocomotionBenchmark>() : nullptr;
+		if (!Benchmark)
+		{
+			return;
+		}
+		TArray<int32> Counts;
+		int32 Frames = 300;
+		bool bExit = false;
+		bool bProxies = false;
+		bool bLightweight = false;
+		for (const FString& Arg : Args)
+		{
+			if (Arg.Equals(TEXT("exit"), ESearchCase::IgnoreCase))
+			{
+				bExit = true;
+			}
+			else if (Arg.Equals(TEXT("proxies"), ESearchCase::IgnoreCase))
+			{
+				bProxies = true;
+			}
+			else if (Arg.Equals(TEXT("lightweight"), ESearchCase::IgnoreCase))
+			{
+				// Compare against a proxies run without it.
+				bLightweight = true;
+			}
+			else if (Arg.StartsWith(TEXT("frames=")))
+			{
+				Frames = FCString::Atoi(*Arg.RightChop(7));
+			}
+			else if (Arg.IsNumeric())
+			{
+				Counts.Add(FCString::Atoi(*Arg));
+			}
+		}
+		if (Counts.Num() == 0)
+		{
+			Counts = {1, 64, 512};
+		}
+		Benchmark->StartBenchmark(Counts, Frames, bExit, bProxies, bLightweight);
+	}));
+
@@ -0,0 +1,220 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Profiling/MonatyLoadTest.h"
+
+#include "EngineUtils.h"
+#include "Character/MonatyCharacter.h"
+#include "Components/MonatyCharacterMovementComponent.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Misc/CommandLine.h"
+
+void UMonatyLoadTestSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	int32 CommandLineBotIndex = INDEX_NONE;
+	if (FParse::Value(FCommandLine::Get(), TEXT("MonatyBot="), CommandLineBotIndex) && GetWorld()->IsGameWorld())
+	{
+		BotIndex = CommandLineBotIndex;
+		FString PlaceableArg;
+		if (FParse::Value(FCommandLine::Get(), TEXT("BotPlaceable="), PlaceableArg))
+		{
+			FString TablePath;
+			FString RowName;
+			if (PlaceableArg.Split(TEXT(":"), &TablePath, &RowName))
+			{
+				BotPlaceable.DataTable = LoadObject<UDataTable>(nullptr, *TablePath);
+				BotPlaceable.RowName = *RowName;
+			}
+		}
+	}
+}
+
+void UMonatyLoadTestSubsystem::Tick(float DeltaTime)
+{
+	if (BotIndex != INDEX_NONE)
+	{
+		TickBot(DeltaTime);
+	}
+	if (bWaitingForBots || bMeasuring)
+	{
+		TickServer(DeltaTime);
+	}
+}
+
+TStatId UMonatyLoadTestSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMonatyLoadTestSubsystem, STATGROUP_Tickables);
+}
+
+void UMonatyLoadTestSubsystem::TickBot(float DeltaTime)
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	AMonatyCharacter* Character = PlayerController ? Cast<AMonatyCharacter>(PlayerController->GetPawn()) : nullptr;
+	if (!Character)
+	{
+		return;
+	}
+	// Same kind of pattern as the locomotion benchmark, offset per bot so they don't move in lockstep.
+	const int32 Frame = BotFrame++ + BotIndex * 131;
+	FMonatyInputFrame Input;
+	Input.DeltaTime = DeltaTime;
+	Input.ForwardBackward = FMath::Sin(Frame * 0.013f) > -0.3f ? 1.0f : 0.0f;
+	Input.LeftRight = FMath::Sin(Frame * 0.05f);
+	Input.ControlRotation = FRotator3f(0.0f, FMath::Fmod(BotIndex * 37.0f + Frame * 0.75f, 360.0f), 0.0f);
+	if (Frame % 300 == 0) Input.Actions |= EMonatyInputActions::SprintPressed;
+	if (Frame % 300 == 180) Input.Actions |= EMonatyInputActions::SprintReleased;
+	if (Frame % 600 == 420) Input.Actions |= EMonatyInputActions::StancePressed;
+	if (Frame % 600 == 540) Input.Actions |= EMonatyInputActions::StanceReleased;
+	if (Frame % 240 == 120) Input.Actions |= EMonatyInputActions::JumpPressed;
+	if (Frame % 240 == 125) Input.Actions |= EMonatyInputActions::JumpReleased;
+
+	// Every 20 seconds at 60 fps, enter place mode, look down, build and leave place mode again.
+	const int32 PlaceFrame = Frame % 1200;
+	if (PlaceFrame == 900 || PlaceFrame == 960)
+	{
+		Input.Actions |= EMonatyInputActions::PlaceMode;
+	}
+	if (PlaceFrame >= 900 && PlaceFrame < 960)
+	{
+		Input.ForwardBackward = 0.0f;
+		Input.LeftRight = 0.0f;
+		Input.ControlRotation.Pitch = -30.0f;
+	}
+	Character->ApplyInputFrame(Input);
+
+	if (UPlaceablesComponent* Placeables = Character->PlaceablesComponent)
+	{
+		if (PlaceFrame == 901 && !BotPlaceable.IsNull())
+		{
+			Placeables->StartPlacingActors(BotPlaceable);
+		}
+		else if (PlaceFrame == 950)
+		{
+			Placeables->ConstructPlaceableActor();
+		}
+	}
+}
+
+void UMonatyLoadTestSubsystem::StartServerMeasurement(int32 InExpectedBots, float InDurationSeconds,
+                                                      bool bInExitWhenDone)
+{
+	if (!GetWorld()->GetNetDriver() || GetWorld()->GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UMonatyLoadTestSubsystem::StartServerMeasurement | Needs a running server!"));
+		return;
+	}
+	ExpectedBots = InExpectedBots;
+	DurationSeconds = InDurationSeconds;
+	bExitWhenDone = bInExitWhenDone;
+	bWaitingForBots = true;
+	PhaseStartTime = FPlatformTime::Seconds();
+}
+
+void UMonatyLoadTestSubsystem::TickServer(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+	if (bWaitingForBots)
+	{
+		const int32 Connected = GetWorld()->GetNetDriver()->ClientConnections.Num();
+		if (Connected < ExpectedBots && Now - PhaseStartTime < ConnectTimeout)
+		{
+			return;
+		}
+		bWaitingForBots = false;
+		bMeasuring = true;
+		PhaseStartTime = Now;
+		LastSampleTime = Now;
+		LastCorrections = GetTotalCorrections();
+		Report = {};
+		Report.Name = FString::Printf(TEXT("LoadTest-%dbots"), Connected);
+		Report.AddSeries(TEXT("FrameMs"));
+		Report.AddSeries(TEXT("OutBytesPerSecondPerClient"));
+		Report.AddSeries(TEXT("InBytesPerSecondPerClient"));
+		Report.AddSeries(TEXT("CorrectionsPerSecond"));
+		Report.AddSeries(TEXT("Clients"));
+		UE_LOG(LogTemp, Display, TEXT("UMonatyLoadTestSubsystem::TickServer | Measuring with %d of %d bots"), Connected,
+		       ExpectedBots);
+		return;
+	}
+
+	Report.Series[0].Samples.Add(DeltaTime * 1000.0);
+	if (Now - LastSampleTime >= 1.0)
+	{
+		SampleServerSecond();
+		LastSampleTime = Now;
+	}
+	if (Now - PhaseStartTime >= DurationSeconds)
+	{
+		FinishServerMeasurement();
+	}
+}
+
+void UMonatyLoadTestSubsystem::SampleServerSecond()
+{
+	// The net driver keeps per connection byte rates, updated once a second.
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	for (const UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		Report.Series[1].Samples.Add(Connection->OutBytesPerSecond);
+		Report.Series[2].Samples.Add(Connection->InBytesPerSecond);
+	}
+	const int32 Corrections = GetTotalCorrections();
+	Report.Series[3].Samples.Add(FMath::Max(Corrections - LastCorrections, 0));
+	LastCorrections = Corrections;
+	Report.Series[4].Samples.Add(NetDriver->ClientConnections.Num());
+}
+
+int32 UMonatyLoadTestSubsystem::GetTotalCorrections() const
+{
+	int32 Total = 0;
+	for (TActorIterator<AMonatyCharacter> It(GetWorld()); It; ++It)
+	{
+		if (const UMonatyCharacterMovementComponent* Movement = It->MyCharacterMovementComponent)
+		{
+			Total += Movement->ServerCorrectionCount;
+		}
+	}
+	return Total;
+}
+
+void UMonatyLoadTestSubsystem::FinishServerMeasurement()
+{
+	bMeasuring = false;
+	Report.SaveCsv();
+	if (bExitWhenDone)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs LoadTestServerCommand(
+	TEXT("Monaty.LoadTest.Server"),
+	TEXT("Measures the server under bot load. Usage: Monaty.LoadTest.Server [bots=N] [seconds=S] [exit]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UMonatyLoadTestSubsystem* LoadTest = World ? World->GetSubsystem<UMonatyLoadTestSubsystem>() : nullptr;
+		if (!LoadTest)
+		{
+			return;
+		}
+		int32 Bots = 0;
+		float Seconds = 60.0f;
+		bool bExit = false;
+		for (const FString& Arg : Args)
+		{
+			if (Arg.Equals(TEXT("exit"), ESearchCase::IgnoreCase))
+			{
+				bExit = true;
+			}
+			else if (Arg.StartsWith(TEXT("bots=")))
+			{
+				Bots = FCString::Atoi(*Arg.RightChop(5));
+			}
+			else if (Arg.StartsWith(TEXT("seconds=")))
+			{
+				Seconds = FCString::Atof(*Arg.RightChop(8));
+			}
+		}
+		LoadTest->StartServerMeasurement(Bots, Seconds, bExit);
+	}));
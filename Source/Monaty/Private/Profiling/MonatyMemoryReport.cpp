@@ -0,0 +1,113 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Profiling/MonatyMemoryReport.h"
+
+#include "Character/MonatyCharacter.h"
+#include "EngineUtils.h"
+
+int32 FMonatyCharacterMemoryReport::Gather(UWorld* World, FMonatyBenchmarkReport& OutReport)
+{
+	if (!World)
+	{
+		return 0;
+	}
+	TMap<FString, uint64> Groups;
+	auto AddSample = [&OutReport](const FString& Group, uint64 Bytes)
+	{
+		FMonatyBenchmarkSeries* Series = OutReport.Series.FindByPredicate(
+			[&Group](const FMonatyBenchmarkSeries& Entry) { return Entry.Name == Group; });
+		(Series ? *Series : OutReport.AddSeries(Group)).Samples.Add(Bytes);
+	};
+
+	int32 CharacterCount = 0;
+	for (TActorIterator<AMonatyCharacter> It(World); It; ++It)
+	{
+		const AMonatyCharacter* Character = *It;
+		Groups.Reset();
+
+		/* Field groups of the actor itself */
+		// Fixed step, recording, landing and proxy state is only allocated where it is used.
+		const uint64 ColdStateBytes = sizeof(Character->FixedStep) + sizeof(Character->InputRecorder) +
+			sizeof(Character->LandingPrediction) + sizeof(Character->ProxySnapshots);
+		const uint64 NamedBytes = sizeof(ACharacter) + sizeof(FMonatyLocomotionState) +
+			sizeof(FReplicatedLocomotionState) + sizeof(FTimeline) + ColdStateBytes;
+		Groups.Add(TEXT("Fields|ACharacter"), sizeof(ACharacter));
+		Groups.Add(TEXT("Fields|Locomotion"), sizeof(FMonatyLocomotionState));
+		Groups.Add(TEXT("Fields|ReplicatedLocomotion"), sizeof(FReplicatedLocomotionState));
+		Groups.Add(TEXT("Fields|StanceTimeline"), sizeof(FTimeline));
+		Groups.Add(TEXT("Fields|ColdState"), ColdStateBytes);
+		// Settings, component pointers and padding.
+		Groups.Add(TEXT("Fields|Other"), sizeof(AMonatyCharacter) - FMath::Min<uint64>(NamedBytes,
+		                                                                              sizeof(AMonatyCharacter)));
+		Groups.Add(TEXT("Fields|Blueprint"), FMath::Max<int64>(0, Character->GetClass()->GetStructureSize() -
+		                                                          static_cast<int64>(sizeof(AMonatyCharacter))));
+
+		/* Cold state, only where allocated */
+		if (Character->FixedStep)
+		{
+			Groups.Add(TEXT("Heap|FixedStep"), sizeof(FMonatyFixedStepState));
+		}
+		if (Character->InputRecorder)
+		{
+			Groups.Add(TEXT("Heap|InputRecorder"), sizeof(FMonatyInputRecorderState) +
+			           Character->InputRecorder->Recording.Frames.GetAllocatedSize());
+		}
+		if (Character->LandingPrediction)
+		{
+			Groups.Add(TEXT("Heap|LandingPrediction"), sizeof(FMonatyLandingPrediction));
+		}
+		if (Character->ProxySnapshots)
+		{
+			Groups.Add(TEXT("Heap|ProxySnapshots"), sizeof(FMonatyProxySnapshots));
+		}
+
+		/* Components, the object plus what it allocates */
+		TInlineComponentArray<UActorComponent*> Components(Character);
+		for (const UActorComponent* Component : Components)
+		{
+			Groups.FindOrAdd(TEXT("Component|") + Component->GetClass()->GetName()) +=
+				Component->GetClass()->GetStructureSize() +
+				Component->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+		}
+
+		for (const TPair<FString, uint64>& Group : Groups)
+		{
+			AddSample(Group.Key, Group.Value);
+		}
+		CharacterCount++;
+	}
+	return CharacterCount;
+}
+
+void FMonatyCharacterMemoryReport::Print(const FMonatyBenchmarkReport& Report, int32 CharacterCount,
+                                         int32 ProjectedCount, FOutputDevice& Ar)
+{
+	double TotalBytes = 0.0;
+	for (const FMonatyBenchmarkSeries& Series : Report.Series)
+	{
+		// Groups missing on some characters still count per character.
+		const double MeanBytes = CharacterCount > 0 ? Series.GetMean() * Series.Samples.Num() / CharacterCount : 0.0;
+		TotalBytes += MeanBytes;
+		Ar.Logf(TEXT("%-48s %10.0f bytes per character"), *Series.Name, MeanBytes);
+	}
+	Ar.Logf(TEXT("%d characters, %.0f bytes per character, %.2f MB at %d characters"), CharacterCount, TotalBytes,
+	        TotalBytes * ProjectedCount / (1024.0 * 1024.0), ProjectedCount);
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CharacterMemoryCommand(
+	TEXT("Monaty.Memory.Characters"),
+	TEXT("Breaks down the memory per character by component and field group. ")
+	TEXT("Usage: Monaty.Memory.Characters [Projected=1000] [csv]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+		[](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			FMonatyBenchmarkReport Report;
+			Report.Name = TEXT("CharacterMemory");
+			const int32 CharacterCount = FMonatyCharacterMemoryReport::Gather(World, Report);
+			const int32 ProjectedCount = Args.Num() > 0 && Args[0].IsNumeric() ? FCString::Atoi(*Args[0]) : 1000;
+			FMonatyCharacterMemoryReport::Print(Report, CharacterCount, ProjectedCount, Ar);
+			if (Args.Contains(TEXT("csv")))
+			{
+				Report.SaveCsv();
+			}
+		}));
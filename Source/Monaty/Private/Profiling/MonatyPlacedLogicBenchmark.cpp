@@ -0,0 +1,160 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Profiling/MonatyPlacedLogicBenchmark.h"
+
+#include "Engine/World.h"
+#include "Placeables/PlacedLogicManager.h"
+
+static const TCHAR* PhaseNames[] = {TEXT("Baseline"), TEXT("Batched"), TEXT("PerActorTick")};
+
+APlacedLogicBenchmarkActor::APlacedLogicBenchmarkActor()
+{
+	bHasPlacedLogic = true;
+	bReplicates = false;
+}
+
+void APlacedLogicBenchmarkActor::TickPlacedLogic(float DeltaTime)
+{
+	Progress = FMath::Fmod(Progress + DeltaTime, 10.0f);
+}
+
+APlacedTickBenchmarkActor::APlacedTickBenchmarkActor()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	bReplicates = false;
+}
+
+void APlacedTickBenchmarkActor::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	Progress = FMath::Fmod(Progress + DeltaTime, 10.0f);
+}
+
+TStatId UMonatyPlacedLogicBenchmark::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMonatyPlacedLogicBenchmark, STATGROUP_Tickables);
+}
+
+void UMonatyPlacedLogicBenchmark::StartBenchmark(int32 InActorCount, int32 InMeasuredFrames, bool bInExitWhenDone)
+{
+	if (IsRunning())
+	{
+		return;
+	}
+	ActorCount = InActorCount;
+	MeasuredFrames = InMeasuredFrames;
+	bExitWhenDone = bInExitWhenDone;
+	Report = {};
+	Report.Name = FString::Printf(TEXT("PlacedLogicBenchmark-%d"), ActorCount);
+	PhaseIndex = 0;
+	StartPhase();
+}
+
+void UMonatyPlacedLogicBenchmark::StartPhase()
+{
+	UWorld* World = GetWorld();
+	const UClass* ActorClass = PhaseIndex == 1
+		                           ? APlacedLogicBenchmarkActor::StaticClass()
+		                           : APlacedTickBenchmarkActor::StaticClass();
+	if (PhaseIndex > 0)
+	{
+		// A grid of structures, half of them near the origin where players usually are.
+		const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(ActorCount)));
+		const float Spacing = 200.0f;
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnedActors.Reserve(ActorCount);
+		for (int32 Index = 0; Index < ActorCount; Index++)
+		{
+			const FVector Location((Index % GridSize - GridSize / 2) * Spacing,
+			                       (Index / GridSize - GridSize / 2) * Spacing, 0.0f);
+			if (APlacedActor* Actor = Cast<APlacedActor>(World->SpawnActor(ActorClass, &Location)))
+			{
+				SpawnedActors.Add(Actor);
+			}
+		}
+	}
+	Report.AddSeries(FString::Printf(TEXT("%sFrameMs"), PhaseNames[PhaseIndex]));
+	Report.AddSeries(FString::Printf(TEXT("%sManagerMs"), PhaseNames[PhaseIndex]));
+	FrameIndex = 0;
+	UE_LOG(LogTemp, Display, TEXT("UMonatyPlacedLogicBenchmark::StartPhase | %s with %d actors"),
+	       PhaseNames[PhaseIndex], SpawnedActors.Num());
+}
+
+void UMonatyPlacedLogicBenchmark::Tick(float DeltaTime)
+{
+	const int32 ManagerScope = static_cast<int32>(EMonatyBenchmarkScope::PlacedLogicTick);
+	if (FrameIndex >= WarmupFrames)
+	{
+		Report.Series[PhaseIndex * 2].Samples.Add(DeltaTime * 1000.0);
+		Report.Series[PhaseIndex * 2 + 1].Samples.Add(
+			FPlatformTime::ToMilliseconds64(FMonatyBenchmarkTimers::FrameCycles[ManagerScope]));
+	}
+	FMonatyBenchmarkTimers::FrameCycles[ManagerScope] = 0;
+	FMonatyBenchmarkTimers::bEnabled = FrameIndex + 1 >= WarmupFrames;
+
+	if (++FrameIndex >= WarmupFrames + MeasuredFrames)
+	{
+		FinishPhase();
+	}
+}
+
+void UMonatyPlacedLogicBenchmark::FinishPhase()
+{
+	FMonatyBenchmarkTimers::bEnabled = false;
+	ClearActors();
+	if (++PhaseIndex < NumPhases)
+	{
+		StartPhase();
+		return;
+	}
+	PhaseIndex = INDEX_NONE;
+	Report.SaveCsv();
+	if (bExitWhenDone)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void UMonatyPlacedLogicBenchmark::ClearActors()
+{
+	for (APlacedActor* Actor : SpawnedActors)
+	{
+		if (Actor)
+		{
+			Actor->Destroy();
+		}
+	}
+	SpawnedActors.Reset();
+}
+
+static FAutoConsoleCommandWithWorldAndArgs PlacedLogicBenchmarkCommand(
+	TEXT("Monaty.Bench.PlacedLogic"),
+	TEXT("Compares batched and per actor ticks of placed logic. Usage: Monaty.Bench.PlacedLogic [Actors] [frames=N] [exit]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UMonatyPlacedLogicBenchmark* Benchmark = World ? World->GetSubsystem<UMonatyPlacedLogicBenchmark>() : nullptr;
+		if (!Benchmark)
+		{
+			return;
+		}
+		int32 Actors = 10000;
+		int32 Frames = 600;
+		bool bExit = false;
+		for (const FString& Arg : Args)
+		{
+			if (Arg.Equals(TEXT("exit"), ESearchCase::IgnoreCase))
+			{
+				bExit = true;
+			}
+			else if (Arg.StartsWith(TEXT("frames=")))
+			{
+				Frames = FCString::Atoi(*Arg.RightChop(7));
+			}
+			else if (Arg.IsNumeric())
+			{
+				Actors = FCString::Atoi(*Arg);
+			}
+		}
+		Benchmark->StartBenchmark(Actors, Frames, bExit);
+	}));
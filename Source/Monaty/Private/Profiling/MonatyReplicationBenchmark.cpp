@@ -0,0 +1,140 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Profiling/MonatyReplicationBenchmark.h"
+
+#include "EngineUtils.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/PlayerStart.h"
+#include "Placeables/PlacedActor.h"
+
+void UMonatyReplicationBenchmark::StartBenchmark(int32 PlacementCount, int32 InMeasuredFrames, bool bInExitWhenDone)
+{
+	UWorld* World = GetWorld();
+	if (IsRunning() || !World->GetNetDriver())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UMonatyReplicationBenchmark::StartBenchmark | Needs a running server!"));
+		return;
+	}
+	MeasuredFrames = InMeasuredFrames;
+	bExitWhenDone = bInExitWhenDone;
+
+	FVector Origin = FVector::ZeroVector;
+	for (TActorIterator<APlayerStart> It(World); It; ++It)
+	{
+		Origin = It->GetActorLocation();
+		break;
+	}
+
+	// Spread the placements over a square around the first player start, like a cluster of bases.
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(PlacementCount)));
+	const float Spacing = 400.0f;
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	for (int32 Index = 0; Index < PlacementCount; Index++)
+	{
+		const FVector Offset((Index % GridSize - GridSize / 2) * Spacing, (Index / GridSize - GridSize / 2) * Spacing,
+		                     0.0f);
+		if (APlacedActor* Placement = World->SpawnActor<APlacedActor>(Origin + Offset, FRotator::ZeroRotator,
+		                                                              SpawnParameters))
+		{
+			SpawnedPlacements.Add(Placement);
+		}
+	}
+
+	const int32 ClientCount = World->GetNetDriver()->ClientConnections.Num();
+	Report = {};
+	Report.Name = FString::Printf(TEXT("ReplicationBenchmark-%d-%dc"), PlacementCount, ClientCount);
+	Report.AddSeries(TEXT("FrameMs"));
+	Report.AddSeries(TEXT("ServerReplicateActorsMs"));
+	Report.AddSeries(TEXT("Clients"));
+	FrameIndex = 0;
+	UE_LOG(LogTemp, Display, TEXT("UMonatyReplicationBenchmark::StartBenchmark | %d placements, %d clients"),
+	       SpawnedPlacements.Num(), ClientCount);
+}
+
+void UMonatyReplicationBenchmark::Tick(float DeltaTime)
+{
+	const int32 ReplicateActorsScope = static_cast<int32>(EMonatyBenchmarkScope::ServerReplicateActors);
+	if (FrameIndex >= WarmupFrames)
+	{
+		Report.Series[0].Samples.Add(DeltaTime * 1000.0);
+		Report.Series[1].Samples.Add(
+			FPlatformTime::ToMilliseconds64(FMonatyBenchmarkTimers::FrameCycles[ReplicateActorsScope]));
+		Report.Series[2].Samples.Add(GetWorld()->GetNetDriver()->ClientConnections.Num());
+	}
+	FMonatyBenchmarkTimers::FrameCycles[ReplicateActorsScope] = 0;
+	FMonatyBenchmarkTimers::bEnabled = FrameIndex + 1 >= WarmupFrames;
+
+	if (++FrameIndex >= WarmupFrames + MeasuredFrames)
+	{
+		FinishBenchmark();
+		return;
+	}
+	if (FrameIndex % ChangeInterval == 0 && SpawnedPlacements.Num() > 0)
+	{
+		const int32 ChangeCount = FMath::Max(1, FMath::RoundToInt(SpawnedPlacements.Num() * ChangeFraction));
+		for (int32 Index = 0; Index < ChangeCount; Index++)
+		{
+			const int32 PlacementIndex = (FrameIndex * 7919 + Index * 104729) % SpawnedPlacements.Num();
+			if (APlacedActor* Placement = SpawnedPlacements[PlacementIndex])
+			{
+				Placement->NotifyPlacementChanged();
+			}
+		}
+	}
+}
+
+TStatId UMonatyReplicationBenchmark::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMonatyReplicationBenchmark, STATGROUP_Tickables);
+}
+
+void UMonatyReplicationBenchmark::FinishBenchmark()
+{
+	FMonatyBenchmarkTimers::bEnabled = false;
+	FrameIndex = INDEX_NONE;
+	Report.SaveCsv();
+	for (APlacedActor* Placement : SpawnedPlacements)
+	{
+		if (Placement)
+		{
+			Placement->Destroy();
+		}
+	}
+	SpawnedPlacements.Reset();
+	if (bExitWhenDone)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ReplicationBenchmarkCommand(
+	TEXT("Monaty.Bench.Replication"),
+	TEXT("Benchmarks server replication. Usage: Monaty.Bench.Replication [Placements] [frames=N] [exit]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UMonatyReplicationBenchmark* Benchmark = World ? World->GetSubsystem<UMonatyReplicationBenchmark>() : nullptr;
+		if (!Benchmark)
+		{
+			return;
+		}
+		int32 Placements = 20000;
+		int32 Frames = 600;
+		bool bExit = false;
+		for (const FString& Arg : Args)
+		{
+			if (Arg.Equals(TEXT("exit"), ESearchCase::IgnoreCase))
+			{
+				bExit = true;
+			}
+			else if (Arg.StartsWith(TEXT("frames=")))
+			{
+				Frames = FCString::Atoi(*Arg.RightChop(7));
+			}
+			else if (Arg.IsNumeric())
+			{
+				Placements = FCString::Atoi(*Arg);
+			}
+		}
+		Benchmark->StartBenchmark(Placements, Frames, bExit);
+	}));
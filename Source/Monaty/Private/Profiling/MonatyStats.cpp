@@ -0,0 +1,121 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Profiling/MonatyStats.h"
+
+#include "Misc/CoreDelegates.h"
+#include "Misc/DateTime.h"
+#include "Misc/DelayedAutoRegister.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_STAT(STAT_MonatyCharacterTick);
+DEFINE_STAT(STAT_MonatyLightweightProxyTick);
+DEFINE_STAT(STAT_MonatySetEssentialValues);
+DEFINE_STAT(STAT_MonatyUpdateGroundedRotation);
+DEFINE_STAT(STAT_MonatyPhysWalking);
+DEFINE_STAT(STAT_MonatyPlaceablesTick);
+DEFINE_STAT(STAT_MonatyPlaceablesTrace);
+DEFINE_STAT(STAT_MonatyPlaceablesMaterials);
+DEFINE_STAT(STAT_MonatyReplicateActors);
+DEFINE_STAT(STAT_MonatyAutosave);
+DEFINE_STAT(STAT_MonatyLagCompRecord);
+DEFINE_STAT(STAT_MonatyLagCompQuery);
+DEFINE_STAT(STAT_MonatyPlacedLogicTick);
+DEFINE_STAT(STAT_MonatyPlacementQuery);
+DEFINE_STAT(STAT_MonatyDemolish);
+DEFINE_STAT(STAT_MonatyPlacementGenerate);
+DEFINE_STAT(STAT_MonatyPlacementRules);
+DEFINE_STAT(STAT_MonatyLandingPrediction);
+
+DEFINE_STAT(STAT_MonatyCurveEvaluations);
+DEFINE_STAT(STAT_MonatyTraces);
+DEFINE_STAT(STAT_MonatyMaterialChanges);
+DEFINE_STAT(STAT_MonatySpawns);
+DEFINE_STAT(STAT_MonatyCorrections);
+
+#if CPUPROFILERTRACE_ENABLED
+UE_TRACE_CHANNEL_DEFINE(MonatyChannel);
+#endif
+
+uint32 FMonatyStatsHistory::FrameCounters[static_cast<int32>(EMonatyStatCounter::Count)] = {};
+
+#if MONATY_WITH_STATS
+
+namespace MonatyStatsHistory
+{
+	struct FFrameRow
+	{
+		uint64 FrameNumber = 0;
+		float FrameMs = 0.0f;
+		uint32 Counters[static_cast<int32>(EMonatyStatCounter::Count)] = {};
+	};
+
+	// Rolling history, the oldest row is overwritten once full.
+	FFrameRow Rows[FMonatyStatsHistory::MaxFrames];
+	int32 NextRow = 0;
+	int32 NumRows = 0;
+	double LastFrameTime = 0.0;
+
+	FDelayedAutoRegisterHelper RegisterEndFrame(EDelayedRegisterRunPhase::EndOfEngineInit, []
+	{
+		FCoreDelegates::OnEndFrame.AddStatic(&FMonatyStatsHistory::EndFrame);
+	});
+}
+
+void FMonatyStatsHistory::EndFrame()
+{
+	using namespace MonatyStatsHistory;
+
+	const double Now = FPlatformTime::Seconds();
+	FFrameRow& Row = Rows[NextRow];
+	Row.FrameNumber = GFrameCounter;
+	Row.FrameMs = LastFrameTime > 0.0 ? static_cast<float>((Now - LastFrameTime) * 1000.0) : 0.0f;
+	FMemory::Memcpy(Row.Counters, FrameCounters, sizeof(FrameCounters));
+	FMemory::Memzero(FrameCounters);
+
+	LastFrameTime = Now;
+	NextRow = (NextRow + 1) % MaxFrames;
+	NumRows = FMath::Min(NumRows + 1, MaxFrames);
+}
+
+bool FMonatyStatsHistory::DumpCsv(const FString& FilePath)
+{
+	using namespace MonatyStatsHistory;
+
+	FString Csv = TEXT("Frame,FrameMs,CurveEvaluations,Traces,MaterialChanges,Spawns,Corrections\n");
+	const int32 FirstRow = (NextRow - NumRows + MaxFrames) % MaxFrames;
+	for (int32 Offset = 0; Offset < NumRows; Offset++)
+	{
+		const FFrameRow& Row = Rows[(FirstRow + Offset) % MaxFrames];
+		Csv += FString::Printf(TEXT("%llu,%.3f,%u,%u,%u,%u,%u\n"), Row.FrameNumber, Row.FrameMs, Row.Counters[0],
+		                       Row.Counters[1], Row.Counters[2], Row.Counters[3], Row.Counters[4]);
+	}
+	return FFileHelper::SaveStringToFile(Csv, *FilePath);
+}
+
+static FAutoConsoleCommand DumpStatsCsvCommand(
+	TEXT("Monaty.Stats.DumpCsv"),
+	TEXT("Dumps the last frames of Monaty counters to CSV. Usage: Monaty.Stats.DumpCsv [File]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString FilePath = Args.Num() > 0
+			                         ? Args[0]
+			                         : FPaths::ProfilingDir() / TEXT("Monaty") /
+			                         FString::Printf(TEXT("MonatyStats-%s.csv"), *FDateTime::Now().ToString());
+		const bool bSaved = FMonatyStatsHistory::DumpCsv(FilePath);
+		UE_LOG(LogTemp, Display, TEXT("Monaty.Stats.DumpCsv | %s %s"), bSaved ? TEXT("Saved") : TEXT("Could not save"),
+		       *FilePath);
+	}));
+
+#else
+
+void FMonatyStatsHistory::EndFrame()
+{
+}
+
+bool FMonatyStatsHistory::DumpCsv(const FString& FilePath)
+{
+	return false;
+}
+
+#endif
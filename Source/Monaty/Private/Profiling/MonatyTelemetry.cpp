@@ -0,0 +1,342 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Profiling/MonatyTelemetry.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Compression.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DateTime.h"
+#include "Misc/DelayedAutoRegister.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Profiling/MonatyBenchmark.h"
+#include "Serialization/MemoryReader.h"
+
+static TAutoConsoleVariable<int32> CVarTelemetryFileMB(
+	TEXT("monaty.Telemetry.FileMB"),
+	64,
+	TEXT("Compressed size a telemetry file may reach before the writer starts the next one."));
+
+static TAutoConsoleVariable<int32> CVarTelemetryMaxFiles(
+	TEXT("monaty.Telemetry.MaxFiles"),
+	16,
+	TEXT("Telemetry files kept in Saved/Telemetry, the oldest are deleted."));
+
+static TAutoConsoleVariable<bool> CVarTelemetry(
+	TEXT("monaty.Telemetry"),
+	false,
+	TEXT("Stream locomotion and placement telemetry to Saved/Telemetry. Also enabled with -MonatyTelemetry."),
+	FConsoleVariableDelegate::CreateLambda([](IConsoleVariable* Variable)
+	{
+		if (Variable->GetBool())
+		{
+			FMonatyTelemetry::Get().Start();
+		}
+		else
+		{
+			FMonatyTelemetry::Get().Shutdown();
+		}
+	}));
+
+// Uncompressed bytes collected before a block is compressed and written.
+static constexpr int32 BlockSize = 256 * 1024;
+
+std::atomic<bool> FMonatyTelemetry::bEnabled{false};
+
+namespace MonatyTelemetry
+{
+	FDelayedAutoRegisterHelper RegisterTelemetry(EDelayedRegisterRunPhase::EndOfEngineInit, []
+	{
+		if (FParse::Param(FCommandLine::Get(), TEXT("MonatyTelemetry")))
+		{
+			CVarTelemetry->Set(true, ECVF_SetByCommandline);
+		}
+		FCoreDelegates::OnPreExit.AddLambda([]
+		{
+			FMonatyTelemetry::Get().Shutdown();
+		});
+	});
+}
+
+int32 FMonatyTelemetryRing::Drain(TArray<uint8>& Out)
+{
+	const uint32 CurrentTail = Tail.load(std::memory_order_relaxed);
+	const uint32 CurrentHead = Head.load(std::memory_order_acquire);
+	const int32 Count = static_cast<int32>(CurrentHead - CurrentTail);
+	if (Count == 0)
+	{
+		return 0;
+	}
+	// The pushed records are contiguous, or wrap around the end once.
+	const uint32 First = CurrentTail % Capacity;
+	const int32 FirstCount = FMath::Min<int32>(Count, Capacity - First);
+	Out.Append(reinterpret_cast<const uint8*>(&Records[First]), FirstCount * sizeof(FMonatyTelemetryRecord));
+	Out.Append(reinterpret_cast<const uint8*>(&Records[0]), (Count - FirstCount) * sizeof(FMonatyTelemetryRecord));
+	Tail.store(CurrentHead, std::memory_order_release);
+	return Count;
+}
+
+FMonatyTelemetry& FMonatyTelemetry::Get()
+{
+	static FMonatyTelemetry Instance;
+	return Instance;
+}
+
+FMonatyTelemetryRing& FMonatyTelemetry::GetThreadRing()
+{
+	// Rings live as long as the process, a thread that exits leaves its ring drained and unused.
+	static thread_local FMonatyTelemetryRing* ThreadRing = nullptr;
+	if (!ThreadRing)
+	{
+		ThreadRing = new FMonatyTelemetryRing();
+		FMonatyTelemetry& Telemetry = Get();
+		FScopeLock Lock(&Telemetry.RingsLock);
+		Telemetry.Rings.Add(ThreadRing);
+	}
+	return *ThreadRing;
+}
+
+uint32 FMonatyTelemetry::GetDroppedCount() const
+{
+	uint32 Dropped = 0;
+	FScopeLock Lock(&const_cast<FMonatyTelemetry*>(this)->RingsLock);
+	for (const FMonatyTelemetryRing* Ring : Rings)
+	{
+		Dropped += Ring->Dropped.load(std::memory_order_relaxed);
+	}
+	return Dropped;
+}
+
+void FMonatyTelemetry::Start()
+{
+	if (Thread)
+	{
+		return;
+	}
+	Directory = FPaths::ProjectSavedDir() / TEXT("Telemetry");
+	IFileManager::Get().MakeDirectory(*Directory, true);
+	bStopping = false;
+	if (!WakeEvent)
+	{
+		WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	}
+	Thread = FRunnableThread::Create(this, TEXT("MonatyTelemetryWriter"), 0, TPri_BelowNormal);
+	bEnabled.store(Thread != nullptr, std::memory_order_release);
+}
+
+void FMonatyTelemetry::Shutdown()
+{
+	if (!Thread)
+	{
+		return;
+	}
+	bEnabled.store(false, std::memory_order_release);
+	bStopping = true;
+	WakeEvent->Trigger();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+}
+
+void FMonatyTelemetry::Stop()
+{
+	bStopping = true;
+	if (WakeEvent)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+uint32 FMonatyTelemetry::Run()
+{
+	OpenFile();
+	// Pushes wake the writer early when a ring fills up to its threshold.
+	while (!bStopping)
+	{
+		WakeEvent->Wait(100);
+		DrainRings();
+	}
+	// Whatever was pushed before telemetry was turned off.
+	DrainRings();
+	if (Pending.Num() > 0)
+	{
+		WriteBlock();
+	}
+	Writer.Reset();
+	return 0;
+}
+
+void FMonatyTelemetry::DrainRings()
+{
+	{
+		FScopeLock Lock(&RingsLock);
+		for (FMonatyTelemetryRing* Ring : Rings)
+		{
+			WrittenRecords += Ring->Drain(Pending);
+		}
+	}
+	if (Pending.Num() >= BlockSize)
+	{
+		WriteBlock();
+	}
+}
+
+void FMonatyTelemetry::WriteBlock()
+{
+	if (!Writer)
+	{
+		Pending.Reset();
+		return;
+	}
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Pending.Num());
+	Compressed.SetNumUninitialized(CompressedSize, false);
+	if (!FCompression::CompressMemory(NAME_Zlib, Compressed.GetData(), CompressedSize, Pending.GetData(),
+	                                  Pending.Num()))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FMonatyTelemetry::WriteBlock | Could not compress %d bytes!"), Pending.Num());
+		Pending.Reset();
+		return;
+	}
+	int32 UncompressedSize = Pending.Num();
+	*Writer << UncompressedSize << CompressedSize;
+	Writer->Serialize(Compressed.GetData(), CompressedSize);
+	Writer->Flush();
+	Pending.Reset();
+
+	if (Writer->Tell() >= static_cast<int64>(CVarTelemetryFileMB.GetValueOnAnyThread()) * 1024 * 1024)
+	{
+		OpenFile();
+	}
+}
+
+void FMonatyTelemetry::OpenFile()
+{
+	Writer.Reset();
+	const FString FilePath = Directory / FString::Printf(TEXT("Monaty-%s-%03d.mtl"), *FDateTime::Now().ToString(),
+	                                                     FileIndex++);
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!Writer)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FMonatyTelemetry::OpenFile | Could not open %s!"), *FilePath);
+		return;
+	}
+	uint32 Magic = FileMagic;
+	uint32 Version = FileVersion;
+	uint32 RecordSize = sizeof(FMonatyTelemetryRecord);
+	*Writer << Magic << Version << RecordSize;
+	DeleteOldFiles();
+}
+
+void FMonatyTelemetry::DeleteOldFiles() const
+{
+	TArray<FString> Files;
+	IFileManager::Get().FindFiles(Files, *(Directory / TEXT("*.mtl")), true, false);
+	const int32 MaxFiles = FMath::Max(CVarTelemetryMaxFiles.GetValueOnAnyThread(), 1);
+	if (Files.Num() <= MaxFiles)
+	{
+		return;
+	}
+	// Names start with the time they were opened at, so they sort oldest first.
+	Files.Sort();
+	for (int32 Index = 0; Index < Files.Num() - MaxFiles; Index++)
+	{
+		IFileManager::Get().Delete(*(Directory / Files[Index]));
+	}
+}
+
+bool FMonatyTelemetry::ReadFile(const FString& FilePath, TArray<FMonatyTelemetryRecord>& OutRecords)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *FilePath))
+	{
+		return false;
+	}
+	FMemoryReader Reader(Bytes);
+	uint32 Magic = 0, Version = 0, RecordSize = 0;
+	Reader << Magic << Version << RecordSize;
+	if (Magic != FileMagic || Version != FileVersion || RecordSize != sizeof(FMonatyTelemetryRecord))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FMonatyTelemetry::ReadFile | %s is not a telemetry file!"), *FilePath);
+		return false;
+	}
+	TArray<uint8> Block;
+	while (Reader.Tell() + 2 * sizeof(int32) <= Reader.TotalSize())
+	{
+		int32 UncompressedSize = 0, CompressedSize = 0;
+		Reader << UncompressedSize << CompressedSize;
+		// A file still being written, or cut short, ends with a partial block.
+		if (CompressedSize <= 0 || UncompressedSize % sizeof(FMonatyTelemetryRecord) != 0 ||
+			Reader.Tell() + CompressedSize > Reader.TotalSize())
+		{
+			break;
+		}
+		Block.SetNumUninitialized(UncompressedSize);
+		if (!FCompression::UncompressMemory(NAME_Zlib, Block.GetData(), UncompressedSize,
+		                                    Bytes.GetData() + Reader.Tell(), CompressedSize))
+		{
+			break;
+		}
+		Reader.Seek(Reader.Tell() + CompressedSize);
+		const int32 Count = UncompressedSize / sizeof(FMonatyTelemetryRecord);
+		const int32 First = OutRecords.AddUninitialized(Count);
+		FMemory::Memcpy(&OutRecords[First], Block.GetData(), UncompressedSize);
+	}
+	return true;
+}
+
+static FAutoConsoleCommand TelemetryBenchmarkCommand(
+	TEXT("Monaty.Bench.Telemetry"),
+	TEXT("Measures the game thread cost of pushing telemetry records. Usage: Monaty.Bench.Telemetry [Records] [budget=Ns]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		int32 Records = 1000000;
+		double BudgetNs = 100.0;
+		for (const FString& Arg : Args)
+		{
+			if (Arg.StartsWith(TEXT("budget=")))
+			{
+				BudgetNs = FCString::Atod(*Arg.RightChop(7));
+			}
+			else if (Arg.IsNumeric())
+			{
+				Records = FMath::Max(FCString::Atoi(*Arg), 1);
+			}
+		}
+		FMonatyTelemetry& Telemetry = FMonatyTelemetry::Get();
+		const bool bWasEnabled = FMonatyTelemetry::IsEnabled();
+		Telemetry.Start();
+		const uint32 DroppedBefore = Telemetry.GetDroppedCount();
+
+		// A frame's worth of records per batch, the writer drains between batches like it would between frames.
+		constexpr int32 RecordsPerBatch = 256;
+		FMonatyBenchmarkReport Report;
+		Report.Name = TEXT("TelemetryBenchmark");
+		FMonatyBenchmarkSeries& PushNs = Report.AddSeries(TEXT("PushNs"));
+		FMonatyTelemetryRecord Record;
+		for (int32 Pushed = 0; Pushed < Records; Pushed += RecordsPerBatch)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Index = 0; Index < RecordsPerBatch; Index++)
+			{
+				Record.Frame = Pushed + Index;
+				Record.Values[0] = static_cast<float>(Index);
+				FMonatyTelemetry::Push(Record);
+			}
+			PushNs.Samples.Add((FPlatformTime::Seconds() - StartTime) * 1.0e9 / RecordsPerBatch);
+			if (Pushed % (RecordsPerBatch * 16) == 0)
+			{
+				FPlatformProcess::Sleep(0.001f);
+			}
+		}
+		const uint32 Dropped = Telemetry.GetDroppedCount() - DroppedBefore;
+		Report.SaveCsv();
+		const double P99 = PushNs.GetPercentile(99.0);
+		UE_LOG(LogTemp, Display, TEXT("Monaty.Bench.Telemetry | %s: p99 %.1f ns per record, budget %.1f ns, %u dropped"),
+		       P99 <= BudgetNs ? TEXT("Within budget") : TEXT("Over budget"), P99, BudgetNs, Dropped);
+		if (!bWasEnabled)
+		{
+			Telemetry.Shutdown();
+		}
+	}));
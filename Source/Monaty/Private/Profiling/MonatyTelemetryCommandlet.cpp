@@ -0,0 +1,106 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Profiling/MonatyTelemetryCommandlet.h"
+
+#include "Components/PlaceablesComponent.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Profiling/MonatyTelemetry.h"
+
+int32 UMonatyTelemetryCommandlet::Main(const FString& Params)
+{
+	FString Path;
+	if (!FParse::Value(*Params, TEXT("File="), Path))
+	{
+		UE_LOG(LogTemp, Error, TEXT("UMonatyTelemetryCommandlet::Main | Usage: -run=MonatyTelemetry -File=<File or directory> [-Csv=<File>]"));
+		return 1;
+	}
+
+	TArray<FString> Files;
+	if (IFileManager::Get().DirectoryExists(*Path))
+	{
+		IFileManager::Get().FindFiles(Files, *(Path / TEXT("*.mtl")), true, false);
+		Files.Sort();
+		for (FString& File : Files)
+		{
+			File = Path / File;
+		}
+	}
+	else
+	{
+		Files.Add(Path);
+	}
+
+	TArray<FMonatyTelemetryRecord> Records;
+	for (const FString& File : Files)
+	{
+		if (!FMonatyTelemetry::ReadFile(File, Records))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UMonatyTelemetryCommandlet::Main | Could not read %s"), *File);
+		}
+	}
+
+	// Summary
+	int32 LocomotionCount = 0;
+	double SpeedSum = 0.0;
+	int32 GaitCounts[4] = {};
+	int32 CrouchingCount = 0;
+	int32 PlacementCount = 0;
+	int32 AcceptedCount = 0;
+	int32 RejectionCounts[256] = {};
+	for (const FMonatyTelemetryRecord& Record : Records)
+	{
+		if (Record.Type == EMonatyTelemetryType::Locomotion)
+		{
+			LocomotionCount++;
+			SpeedSum += Record.Values[0];
+			GaitCounts[FMath::Min<int32>(Record.State[0], 3)]++;
+			CrouchingCount += Record.State[1] != 0;
+		}
+		else if (Record.Type == EMonatyTelemetryType::Placement)
+		{
+			PlacementCount++;
+			AcceptedCount += Record.State[0] != 0;
+			RejectionCounts[Record.State[2]]++;
+		}
+	}
+	UE_LOG(LogTemp, Display, TEXT("UMonatyTelemetryCommandlet::Main | %d files, %d records"), Files.Num(),
+	       Records.Num());
+	UE_LOG(LogTemp, Display,
+	       TEXT("UMonatyTelemetryCommandlet::Main | Locomotion: %d samples, mean speed %.1f, gait none/walk/sprint %d/%d/%d, crouching %d"),
+	       LocomotionCount, LocomotionCount > 0 ? SpeedSum / LocomotionCount : 0.0, GaitCounts[0], GaitCounts[1],
+	       GaitCounts[2], CrouchingCount);
+	UE_LOG(LogTemp, Display,
+	       TEXT("UMonatyTelemetryCommandlet::Main | Placements: %d attempts, %d accepted, rejected by view origin %d, reach %d, character %d, spawn %d, unknown placeable %d, rules %d, transform %d, footprint %d"),
+	       PlacementCount, AcceptedCount, RejectionCounts[static_cast<uint8>(EPlacementRejection::ViewOrigin)],
+	       RejectionCounts[static_cast<uint8>(EPlacementRejection::OutOfReach)],
+	       RejectionCounts[static_cast<uint8>(EPlacementRejection::BlockedByCharacter)],
+	       RejectionCounts[static_cast<uint8>(EPlacementRejection::SpawnFailed)],
+	       RejectionCounts[static_cast<uint8>(EPlacementRejection::UnknownPlaceable)],
+	       RejectionCounts[static_cast<uint8>(EPlacementRejection::RuleBroken)],
+	       RejectionCounts[static_cast<uint8>(EPlacementRejection::InvalidTransform)],
+	       RejectionCounts[static_cast<uint8>(EPlacementRejection::Footprint)]);
+
+	FString CsvPath;
+	if (FParse::Value(*Params, TEXT("Csv="), CsvPath))
+	{
+		TArray<FString> Lines;
+		Lines.Reserve(Records.Num() + 1);
+		Lines.Add(TEXT("Frame,Source,Time,Type,State0,State1,State2,Value0,Value1,Value2,Value3"));
+		for (const FMonatyTelemetryRecord& Record : Records)
+		{
+			Lines.Add(FString::Printf(TEXT("%u,%u,%.4f,%d,%d,%d,%d,%.3f,%.3f,%.3f,%.3f"), Record.Frame, Record.Source,
+			                          Record.Time, static_cast<int32>(Record.Type), Record.State[0], Record.State[1],
+			                          Record.State[2], Record.Values[0], Record.Values[1], Record.Values[2],
+			                          Record.Values[3]));
+		}
+		if (!FFileHelper::SaveStringArrayToFile(Lines, *CsvPath))
+		{
+			UE_LOG(LogTemp, Error, TEXT("UMonatyTelemetryCommandlet::Main | Could not save %s"), *CsvPath);
+			return 1;
+		}
+		UE_LOG(LogTemp, Display, TEXT("UMonatyTelemetryCommandlet::Main | Saved %s"), *CsvPath);
+	}
+	return 0;
+}
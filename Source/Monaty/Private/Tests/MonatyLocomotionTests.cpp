@@ -0,0 +1,115 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#include "Character/MonatyCharacter.h"
+#include "Engine/Engine.h"
+#include "Misc/AutomationTest.h"
+#include "Profiling/MonatyBenchmark.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace MonatyTests
+{
+	// The tests spawn into the running game, start it with the map to test in.
+	UWorld* FindGameWorld()
+	{
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			if ((Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE) && Context.World())
+			{
+				return Context.World();
+			}
+		}
+		return nullptr;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMonatyFixedStepDeterminismTest, "Monaty.Locomotion.FixedStepDeterminism",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMonatyFixedStepDeterminismTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = MonatyTests::FindGameWorld();
+	UMonatyLocomotionBenchmark* Benchmark = World ? World->GetSubsystem<UMonatyLocomotionBenchmark>() : nullptr;
+	if (!TestNotNull(TEXT("Game world with the locomotion benchmark"), Benchmark))
+	{
+		return false;
+	}
+
+	// Record the input of every step once, then feed the same steps at two frame rates that split them differently.
+	const float StepRate = 60.0f;
+	TArray<FLocomotionStepInput> StepInputs;
+	if (!TestTrue(TEXT("Recorded the step inputs"),
+	              Benchmark->RecordFixedStepInputs(UMonatyLocomotionBenchmark::MakeVerificationRecording(), StepRate,
+	                                               StepInputs)))
+	{
+		return false;
+	}
+
+	const int32 FrameRates[] = {30, 144};
+	FQuat Rotations[2];
+	FMonatyLocomotionState States[2];
+	for (int32 Index = 0; Index < 2; Index++)
+	{
+		const int32 Steps = Benchmark->RunFixedStepInputs(StepInputs, StepRate, FrameRates[Index], Rotations[Index],
+		                                                  States[Index]);
+		TestEqual(FString::Printf(TEXT("Steps run at %d fps"), FrameRates[Index]), Steps, StepInputs.Num());
+	}
+
+	// Same inputs in the same order, so the results have to be identical, not just close.
+	TestTrue(TEXT("Step rotation is identical"), Rotations[0] == Rotations[1]);
+	TestTrue(TEXT("Locomotion state is identical"),
+	         FMonatyLocomotionState::StaticStruct()->CompareScriptStruct(&States[0], &States[1], PPF_None));
+	return true;
+}
+
+// Waits for the benchmark to get through all its runs, then reports the percentiles of every series.
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FMonatyReportLocomotionBenchmark, FAutomationTestBase*, Test,
+                                               TWeakObjectPtr<UMonatyLocomotionBenchmark>, Benchmark);
+
+bool FMonatyReportLocomotionBenchmark::Update()
+{
+	if (!Benchmark.IsValid())
+	{
+		Test->AddError(TEXT("The world went away during the locomotion benchmark"));
+		return true;
+	}
+	if (Benchmark->IsRunning())
+	{
+		return false;
+	}
+	for (const FMonatyBenchmarkReport& Report : Benchmark->GetCompletedReports())
+	{
+		for (const FMonatyBenchmarkSeries& Series : Report.Series)
+		{
+			Test->AddAnalyticsItem(FString::Printf(TEXT("%s.%s.P50=%.4f"), *Report.Name, *Series.Name,
+			                                       Series.GetPercentile(50.0)));
+			Test->AddAnalyticsItem(FString::Printf(TEXT("%s.%s.P99=%.4f"), *Report.Name, *Series.Name,
+			                                       Series.GetPercentile(99.0)));
+		}
+	}
+	Test->TestEqual(TEXT("Completed runs"), Benchmark->GetCompletedReports().Num(), 3);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMonatyLocomotionPerfTest, "Monaty.Perf.Locomotion",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FMonatyLocomotionPerfTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = MonatyTests::FindGameWorld();
+	UMonatyLocomotionBenchmark* Benchmark = World ? World->GetSubsystem<UMonatyLocomotionBenchmark>() : nullptr;
+	if (!TestNotNull(TEXT("Game world with the locomotion benchmark"), Benchmark))
+	{
+		return false;
+	}
+	if (!TestFalse(TEXT("No benchmark running already"), Benchmark->IsRunning()))
+	{
+		return false;
+	}
+	// The same counts as the console command, each run also lands as CSV in Saved/Profiling/Monaty.
+	Benchmark->StartBenchmark({1, 64, 512}, 300, false);
+	ADD_LATENT_AUTOMATION_COMMAND(FMonatyReportLocomotionBenchmark(this, Benchmark));
+	return true;
+}
+
+#endif
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Camera/CameraComponent.h"
+#include "Character/MonatyInputRecording.h"
+#include "Character/MonatyLandingPrediction.h"
 #include "Components/PlaceablesComponent.h"
 #include "Components/TimelineComponent.h"
 #include "Engine/DataTable.h"
@@ -40,16 +42,16 @@ struct FPlayerMovementSettings : public FTableRowBase
 	GENERATED_BODY()
 
 	UPROPERTY(BlueprintReadOnly, EditInstanceOnly, Category="Movement")
-	float WalkSpeed;
+	float WalkSpeed = 0.0f;
 
 	UPROPERTY(BlueprintReadOnly, EditInstanceOnly, Category="Movement")
-	float SprintSpeed;
+	float SprintSpeed = 0.0f;
 
 	UPROPERTY(BlueprintReadOnly, EditInstanceOnly, Category="Movement")
-	UCurveVector* MovementCurve;
+	UCurveVector* MovementCurve = nullptr;
 
 	UPROPERTY(BlueprintReadOnly, EditInstanceOnly, Category="Movement")
-	UCurveFloat* RotationRateCurve;
+	UCurveFloat* RotationRateCurve = nullptr;
 
 	float GetSpeedForGait(const EPlayerGaitState Gait) const
 	{
@@ -78,6 +80,217 @@ struct FPlayerMovementModel : public FTableRowBase
 	FPlayerMovementSettings Crouching;
 };
 
+/**
+ * Compact locomotion state replicated to simulated proxies so they don't have to derive it.
+ * Wire size: 46 bits while not accelerating, 78 bits otherwise (aim 2x16, input 8, state 5, accel flag 1,
+ * accel direction 2x8, accel magnitude 16), compared to the 224 bits the unquantized values would take.
+ */
+USTRUCT()
+struct FReplicatedLocomotionState
+{
+	GENERATED_BODY()
+
+	// Aim rotation compressed to 16 bits per axis.
+	UPROPERTY()
+	uint16 AimYaw = 0;
+
+	UPROPERTY()
+	uint16 AimPitch = 0;
+
+	// Movement input amount mapped to 0-255.
+	UPROPERTY()
+	uint8 MovementInputAmount = 0;
+
+	// Gait (2 bits), stance (1 bit) and movement state (2 bits).
+	UPROPERTY()
+	uint8 StateBits = 0;
+
+	// Acceleration direction compressed to 8 bits per axis.
+	UPROPERTY()
+	uint8 AccelerationYaw = 0;
+
+	UPROPERTY()
+	uint8 AccelerationPitch = 0;
+
+	// Acceleration magnitude in cm/s^2, clamped to 16 bits.
+	UPROPERTY()
+	uint16 AccelerationSize = 0;
+
+	static constexpr int32 StateBitCount = 5;
+
+	void Pack(const FRotator& Aim, float InputAmount, EPlayerGaitState Gait, EPlayerStanceState Stance,
+	          EPlayerMovementState MovementState, const FVector& Acceleration);
+
+	FRotator GetAimRotation() const;
+	float GetMovementInputAmount() const { return MovementInputAmount / 255.0f; }
+	EPlayerGaitState GetGait() const { return static_cast<EPlayerGaitState>(StateBits & 0x3); }
+	EPlayerStanceState GetStance() const { return static_cast<EPlayerStanceState>((StateBits >> 2) & 0x1); }
+	EPlayerMovementState GetMovementState() const { return static_cast<EPlayerMovementState>((StateBits >> 3) & 0x3); }
+	FVector GetAcceleration() const;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FReplicatedLocomotionState& Other) const
+	{
+		return AimYaw == Other.AimYaw && AimPitch == Other.AimPitch &&
+			MovementInputAmount == Other.MovementInputAmount && StateBits == Other.StateBits &&
+			AccelerationYaw == Other.AccelerationYaw && AccelerationPitch == Other.AccelerationPitch &&
+			AccelerationSize == Other.AccelerationSize;
+	}
+};
+
+template <>
+struct TStructOpsTypeTraits<FReplicatedLocomotionState> : public TStructOpsTypeTraitsBase2<FReplicatedLocomotionState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
+
+/**
+ * Everything the custom locomotion reads from the movement component and controller in one step.
+ */
+struct FLocomotionStepInput
+{
+	FVector Velocity = FVector::ZeroVector;
+	FVector CurrentAcceleration = FVector::ZeroVector;
+	float MaxAcceleration = 0.0f;
+	FRotator ControlRotation = FRotator::ZeroRotator;
+};
+
+/**
+ * The last few replicated movement updates of a simulated proxy. Sampled a little in the past, so there usually is a
+ * pair of updates around the sample time to interpolate between.
+ */
+struct FMonatyProxySnapshots
+{
+	struct FSnapshot
+	{
+		double Time = 0.0;
+		FVector Location = FVector::ZeroVector;
+		FVector Velocity = FVector::ZeroVector;
+	};
+
+	static constexpr int32 Capacity = 8;
+
+	void Add(double Time, const FVector& Location, const FVector& Velocity);
+
+	// Holds the oldest or newest snapshot outside of the buffered range. Returns false while empty.
+	bool Sample(double Time, FVector& OutLocation, FVector& OutVelocity) const;
+
+	void Reset() { Num = 0; }
+
+private:
+	const FSnapshot& GetOrdered(int32 Index) const { return Snapshots[(Head - Num + Index + Capacity) % Capacity]; }
+
+	FSnapshot Snapshots[Capacity];
+	// Where the next snapshot goes.
+	int32 Head = 0;
+	int32 Num = 0;
+};
+
+/**
+ * Fixed step locomotion state, only allocated for characters that step at a fixed rate.
+ */
+struct FMonatyFixedStepState
+{
+	double Accumulator = 0.0;
+	FQuat PreviousRotation = FQuat::Identity;
+	FQuat CurrentRotation = FQuat::Identity;
+	// Inputs for the coming steps, one per step. While any are queued the steps only run on them.
+	TArray<FLocomotionStepInput> StepInputs;
+	int32 NextStepInput = 0;
+};
+
+/**
+ * Input recording and replay state, only allocated once a character records or replays.
+ */
+struct FMonatyInputRecorderState
+{
+	EMonatyInputRecorderMode Mode = EMonatyInputRecorderMode::None;
+	FMonatyInputRecording Recording;
+	FMonatyInputFrame PendingFrame;
+	// Stands in for the controller's during headless replays.
+	FRotator ScriptedControlRotation = FRotator::ZeroRotator;
+	bool bHasScriptedControlRotation = false;
+	int32 ReplayFrameIndex = 0;
+	int32 ReplayMismatchCount = 0;
+	double ReplayStartTime = 0.0;
+	bool bExitWhenReplayDone = false;
+	// The engine time step from before the replay took it over.
+	bool bPreviousUseFixedTimeStep = false;
+	double PreviousFixedDeltaTime = 0.0;
+
+	// Hands the engine time step back, if this is a replay.
+	void RestoreTimeStep() const;
+};
+
+/**
+ * The locomotion values every step reads and writes, kept together in single precision. They are directions, rates and
+ * speeds, none of them needs double precision. The block starts on a cache line and the 130 bytes of payload are
+ * padded to whole lines, so a step touches three lines and shares none with other members. Blueprints can't use the
+ * single precision types, they read the rotations and vectors through the Essential getters of the character.
+ */
+USTRUCT(BlueprintType)
+struct alignas(PLATFORM_CACHE_LINE_SIZE) FMonatyLocomotionState
+{
+	GENERATED_BODY()
+
+	/* Rotation */
+	UPROPERTY(VisibleAnywhere, Category = "Rotation")
+	FRotator3f AimingRotation = FRotator3f::ZeroRotator;
+
+	UPROPERTY(VisibleAnywhere, Category = "Rotation")
+	FRotator3f TargetRotation = FRotator3f::ZeroRotator;
+
+	UPROPERTY(VisibleAnywhere, Category = "Rotation")
+	FRotator3f InAirRotation = FRotator3f::ZeroRotator;
+
+	UPROPERTY(VisibleAnywhere, Category = "Rotation")
+	FRotator3f LastVelocityRotation = FRotator3f::ZeroRotator;
+
+	UPROPERTY(VisibleAnywhere, Category = "Rotation")
+	FRotator3f LastMovementInputRotation = FRotator3f::ZeroRotator;
+
+	UPROPERTY(VisibleAnywhere, Category = "Rotation")
+	FRotator3f ControlRotation = FRotator3f::ZeroRotator;
+
+	/* Movement */
+	UPROPERTY(VisibleAnywhere, Category = "Movement")
+	FVector3f Acceleration = FVector3f::ZeroVector;
+
+	UPROPERTY(VisibleAnywhere, Category = "Movement")
+	FVector3f CurrentAcceleration = FVector3f::ZeroVector;
+
+	UPROPERTY(VisibleAnywhere, Category = "Movement")
+	FVector3f PreviousVelocity = FVector3f::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Movement")
+	float Speed = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Movement")
+	float MovementInputAmount = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Rotation")
+	float AimYawRate = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Movement")
+	float EasedMaxAcceleration = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Rotation")
+	float PreviousAimYaw = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Movement")
+	bool bIsMoving = false;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Movement")
+	bool bHasMovementInput = false;
+};
+
+static_assert(sizeof(FMonatyLocomotionState) == Align(3 * 64, PLATFORM_CACHE_LINE_SIZE),
+              "FMonatyLocomotionState grew past three cache lines");
 
 UCLASS()
 class MONATY_API AMonatyCharacter : public ACharacter
@@ -103,6 +316,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 	void SetGait(EPlayerGaitState NewGait);
 
+	// The owning client sends its gait and stance, the server replicates them on to the simulated proxies.
+	UFUNCTION(Reliable, Server, Category = "Movement")
+	void Server_SetGait(EPlayerGaitState NewGait);
+
+	UFUNCTION(Reliable, Server, Category = "Movement")
+	void Server_SetStance(EPlayerStanceState NewStance);
+
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 	void SetMovementState(EPlayerMovementState NewMovement);
 
@@ -110,7 +330,7 @@ public:
 	void SetLocationAndTargetRotation(FVector NewLocation, FRotator NewRotator);
 
 	UFUNCTION(BlueprintCallable, Category = "Movement")
-	bool HasMovementInput() const { return bHasMovementInput; }
+	bool HasMovementInput() const { return Locomotion.bHasMovementInput; }
 
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 	void SetHasMovementInput(bool bNewHasMovementInput);
@@ -134,13 +354,13 @@ public:
 	float CalculateGroundedRotationRate() const;
 
 	UFUNCTION(BlueprintGetter, Category = "Essential")
-	FVector GetAcceleration() const { return Acceleration; }
+	FVector GetAcceleration() const { return FVector(Locomotion.Acceleration); }
 
 	UFUNCTION(BlueprintCallable, Category = "Essential")
 	void SetAcceleration(const FVector& NewAcceleration);
 
 	UFUNCTION(BlueprintGetter, Category = "Essential")
-	bool IsMoving() const { return bIsMoving; }
+	bool IsMoving() const { return Locomotion.bIsMoving; }
 
 	UFUNCTION(BlueprintCallable, Category = "Essential")
 	void SetIsMoving(bool bNewIsMoving);
@@ -149,22 +369,43 @@ public:
 	FVector GetMovementInput() const;
 
 	UFUNCTION(BlueprintGetter, Category = "Essential")
-	float GetMovementInputAmount() const { return MovementInputAmount; }
+	float GetMovementInputAmount() const { return Locomotion.MovementInputAmount; }
 
 	UFUNCTION(BlueprintCallable, Category = "Essential")
 	void SetMovementInputAmount(float NewMovementInputAmount);
 
 	UFUNCTION(BlueprintGetter, Category = "Essential")
-	float GetSpeed() const { return Speed; }
+	float GetSpeed() const { return Locomotion.Speed; }
 
 	UFUNCTION(BlueprintCallable, Category = "Essential")
 	void SetSpeed(float NewSpeed);
 
 	UFUNCTION(BlueprintCallable, Category = "Essential")
-	FRotator GetAimingRotation() const { return AimingRotation; }
+	FRotator GetAimingRotation() const { return FRotator(Locomotion.AimingRotation); }
+
+	UFUNCTION(BlueprintCallable, Category = "Essential")
+	FRotator GetLastVelocityRotation() const { return FRotator(Locomotion.LastVelocityRotation); }
+
+	UFUNCTION(BlueprintCallable, Category = "Essential")
+	FRotator GetLastMovementInputRotation() const { return FRotator(Locomotion.LastMovementInputRotation); }
+
+	UFUNCTION(BlueprintCallable, Category = "Essential")
+	FRotator GetTargetRotation() const { return FRotator(Locomotion.TargetRotation); }
+
+	UFUNCTION(BlueprintCallable, Category = "Essential")
+	FRotator GetInAirRotation() const { return FRotator(Locomotion.InAirRotation); }
+
+	UFUNCTION(BlueprintCallable, Category = "Essential")
+	FRotator GetLocomotionControlRotation() const { return FRotator(Locomotion.ControlRotation); }
 
 	UFUNCTION(BlueprintCallable, Category = "Essential")
-	float GetAimYawRate() const { return AimYawRate; }
+	FVector GetCurrentAcceleration() const { return FVector(Locomotion.CurrentAcceleration); }
+
+	UFUNCTION(BlueprintCallable, Category = "Essential")
+	FVector GetPreviousVelocity() const { return FVector(Locomotion.PreviousVelocity); }
+
+	UFUNCTION(BlueprintCallable, Category = "Essential")
+	float GetAimYawRate() const { return Locomotion.AimYawRate; }
 
 	UFUNCTION(BlueprintCallable, Category = "Essential")
 	void SetAimYawRate(float NewAimYawRate);
@@ -173,7 +414,7 @@ public:
 	void GetControlForwardRightVector(FVector& Forward, FVector& Right) const;
 	
 	UFUNCTION(BlueprintCallable, Category = "Movement")
-	FPlayerMovementSettings GetCurrentMovementSettings() const;
+	const FPlayerMovementSettings& GetCurrentMovementSettings() const;
 
 	UFUNCTION(BlueprintCallable, Category = "Essential")
 	void UpdateCharacterMovement();
@@ -181,15 +422,77 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Essential")
 	void SetEssentialValues(float DeltaTime);
 
+	void SetEssentialValuesFromInput(const FLocomotionStepInput& Input, float DeltaTime);
+
+	UFUNCTION(BlueprintCallable, Category = "Essential")
+	void SetProxyEssentialValues(float DeltaTime);
+
+	/* Locomotion stepping */
+	FLocomotionStepInput GatherLocomotionStepInput() const;
+	void TickLocomotion(const FLocomotionStepInput& Input, float DeltaTime);
+
+	// Runs as many fixed steps as fit in the accumulator and interpolates the actor rotation. Returns the step count.
+	// Each step takes the next queued step input, or the frame input when none are queued. The steps only read their
+	// input, so a queued stream gives the same results at any frame rate.
+	int32 AdvanceFixedStepLocomotion(float DeltaTime, const FLocomotionStepInput& FrameInput);
+	void ResetFixedStepLocomotion();
+	// Steps wait for more input once the queued ones are used up.
+	void QueueFixedStepInputs(TConstArrayView<FLocomotionStepInput> Inputs);
+	int32 GetQueuedFixedStepInputCount() const;
+
+	// The simulated rotation, which in fixed step mode is ahead of the interpolated actor rotation.
+	FRotator GetLocomotionRotation() const;
+	void SetLocomotionRotation(const FRotator& NewRotation);
+
+	UFUNCTION(BlueprintCallable, Category = "Replication")
+	void UpdateReplicatedLocomotion();
+
+	/* Input recording */
+	UFUNCTION(BlueprintCallable, Category = "Input|Recording")
+	void StartInputRecording();
+
+	UFUNCTION(BlueprintCallable, Category = "Input|Recording")
+	bool StopInputRecording(const FString& FilePath);
+
+	UFUNCTION(BlueprintCallable, Category = "Input|Recording")
+	bool StartInputReplay(const FString& FilePath, bool bExitWhenDone = false);
+
+	UFUNCTION(BlueprintCallable, Category = "Input|Recording")
+	bool IsReplayingInput() const { return InputRecorderMode == EMonatyInputRecorderMode::Replaying; }
+
+	// Feeds a frame of input through the input handlers, used by replays and scripted benchmarks.
+	void ApplyInputFrame(const FMonatyInputFrame& Frame);
+
+	/* Pooling */
+	// Hides and disables the character and puts its state back to how BeginPlay left it.
+	void ParkInPool();
+
+	// Brings a parked character back at the transform, ready to be possessed.
+	void TakeFromPool(const FTransform& SpawnTransform);
+
+	bool IsParkedInPool() const { return bIsParkedInPool; }
+
+	/* Simulated proxies */
+	// Only interpolating replicated snapshots and facing the replicated aim, see monaty.Proxy.Lightweight.
+	bool IsLightweightProxy() const { return bLightweightProxy; }
+
+	virtual FRotator GetControlRotation() const override;
+
 	UFUNCTION(BlueprintCallable, Category = "Essential")
 	void UpdateGroundedRotation(float DeltaTime);
 
 	UFUNCTION(BlueprintCallable, Category = "Essential")
 	void UpdateInAirRotation(float DeltaTime);
 
+	// Where and in how many seconds the current fall ends. False while not falling or nothing walkable is in reach, and
+	// on dedicated servers and simulated proxies unless bPredictLandingEverywhere is set.
+	UFUNCTION(BlueprintCallable, Category = "Movement|Landing")
+	bool GetPredictedLanding(FVector& OutLocation, FVector& OutNormal, float& OutTimeToLand) const;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	/* Input mappings */
 	void ForwardBackwardInput(float Value);
@@ -205,6 +508,24 @@ protected:
 
 	void PlaceModeAction();
 
+	/* Input recording */
+	// The frame the input handlers fill in, only while recording.
+	FMonatyInputFrame* GetPendingInputFrame();
+	void RecordInputFrame(float DeltaTime);
+	void ReplayInputFrame();
+	void CaptureFrameResult(FMonatyInputFrame& Frame) const;
+	bool CompareFrameResult(const FMonatyInputFrame& Frame) const;
+	void FinishInputReplay();
+
+	/* Landing prediction */
+	bool ShouldPredictLanding() const;
+	void PredictLanding();
+	void UpdateLandingPrediction();
+
+	/* Simulated proxies */
+	void UpdateLightweightProxy();
+	void TickLightweightProxy(float DeltaTime);
+
 	/** State changes */
 	void OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode = 0);
 	void OnMovementStateChanged(EPlayerMovementState PreviousState);
@@ -223,6 +544,11 @@ public:
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 	virtual void PostInitializeComponents() override;
+	virtual void PossessedBy(AController* NewController) override;
+	virtual void OnRep_Controller() override;
+	virtual void PostNetReceiveLocationAndRotation() override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual bool ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
 	
 	/* Components */
 	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Components")
@@ -265,57 +591,56 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Parameters|Input")
 	float LookLeftRightRate = 1.25f;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Rotation")
-	FRotator TargetRotation = FRotator::ZeroRotator;
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Essential")
+	FMonatyLocomotionState Locomotion;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Rotation")
-	FRotator InAirRotation = FRotator::ZeroRotator;
+	// Shared movement model, loaded asynchronously. Takes precedence over the data table row.
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Parameters|Movement")
+	TSoftObjectPtr<class UMonatyMovementModelAsset> MovementModelAsset;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Rotation")
-	FRotator AimingRotation = FRotator::ZeroRotator;
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Parameters|Movement")
+	FDataTableRowHandle MovementModel;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Rotation")
-	float PreviousAimYaw = 0.0f;
+	UPROPERTY(BlueprintReadOnly, Transient, Category = "Parameters|Movement")
+	class UMonatyMovementModelAsset* LoadedMovementModel = nullptr;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Movement")
-	FVector PreviousVelocity = FVector::ZeroVector;
+	UPROPERTY(Replicated)
+	FReplicatedLocomotionState ReplicatedLocomotion;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Essential")
-	FVector Acceleration = FVector::ZeroVector;
+	/* Fixed step locomotion */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Parameters|Movement|Fixed Step")
+	bool bUseFixedStepLocomotion = false;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Essential")
-	bool bIsMoving = false;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Parameters|Movement|Fixed Step", meta = (ClampMin = "1.0"))
+	float FixedStepRate = 60.0f;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Essential")
-	bool bHasMovementInput = false;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Parameters|Movement|Fixed Step", meta = (ClampMin = "1"))
+	int32 MaxFixedStepsPerFrame = 8;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Essential")
-	FRotator LastVelocityRotation;
+	// Allocated by the first fixed step.
+	TUniquePtr<FMonatyFixedStepState> FixedStep;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Essential")
-	FRotator LastMovementInputRotation;
+	/* Landing prediction */
+	// Also predict landings on dedicated servers and for simulated proxies, for gameplay that reads them there.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Parameters|Movement|Landing")
+	bool bPredictLandingEverywhere = false;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Essential")
-	float Speed = 0.0f;
+	/* Input recording */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Parameters|Input|Recording")
+	float ReplayLocationTolerance = 0.1f;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Essential")
-	float MovementInputAmount = 0.0f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Parameters|Input|Recording")
+	float ReplayRotationTolerance = 0.1f;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Essential")
-	float AimYawRate = 0.0f;
+	// Allocated when recording or replaying starts.
+	TUniquePtr<FMonatyInputRecorderState> InputRecorder;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Essential")
-	float EasedMaxAcceleration = 0.0f;
+	bool bIsParkedInPool = false;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Essential")
-	FVector CurrentAcceleration = FVector::ZeroVector;
-
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Parameters|Essential")
-	FRotator ControlRotation = FRotator::ZeroRotator;
-
-	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Parameters|Movement")
-	FDataTableRowHandle MovementModel;
+	// Allocated by the first fall that is predicted.
+	TUniquePtr<FMonatyLandingPrediction> LandingPrediction;
 
-	UPROPERTY(BlueprintReadOnly, Category = "Parameters|Movement")
-	FPlayerMovementModel PlayerMovementModel;
+	/* Simulated proxies */
+	// Only set while this character is a lightweight proxy.
+	TUniquePtr<FMonatyProxySnapshots> ProxySnapshots;
 };
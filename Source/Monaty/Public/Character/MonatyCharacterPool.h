@@ -0,0 +1,63 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Profiling/MonatyBenchmark.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MonatyCharacterPool.generated.h"
+
+class AMonatyCharacter;
+
+USTRUCT()
+struct FMonatyCharacterPoolList
+{
+	GENERATED_BODY()
+
+	// Parked characters, reserved up front so taking and returning never reallocates.
+	UPROPERTY()
+	TArray<AMonatyCharacter*> Characters;
+};
+
+/**
+ * Keeps constructed characters parked on the server so respawns and joins only reset and move one.
+ * The game mode takes characters from here when monaty.Pool.Characters is enabled.
+ */
+UCLASS()
+class MONATY_API UMonatyCharacterPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static bool IsPoolEnabled();
+
+	// Constructs characters until Count of them are parked for the class.
+	void Prewarm(TSubclassOf<AMonatyCharacter> CharacterClass, int32 Count);
+
+	// Returns a parked character moved to the transform, or spawns one when the pool is empty.
+	AMonatyCharacter* Acquire(TSubclassOf<AMonatyCharacter> CharacterClass, const FTransform& SpawnTransform);
+
+	// Parks the character. The caller unpossesses it first.
+	void Release(AMonatyCharacter* Character);
+
+	int32 GetNumParked(TSubclassOf<AMonatyCharacter> CharacterClass) const;
+
+	// Time spent getting a character ready for possession, with and without the pool.
+	void RecordSpawnTime(bool bPooled, double Milliseconds);
+	// Time spent getting rid of a leaving player's character, parked or destroyed.
+	void RecordLeaveTime(bool bPooled, double Milliseconds);
+	void PrintSpawnStats(FOutputDevice& Ar) const;
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+protected:
+	AMonatyCharacter* SpawnCharacter(TSubclassOf<AMonatyCharacter> CharacterClass, const FTransform& SpawnTransform);
+
+	UPROPERTY()
+	TMap<TSubclassOf<AMonatyCharacter>, FMonatyCharacterPoolList> Pools;
+
+	FMonatyBenchmarkSeries PooledSpawnMs;
+	FMonatyBenchmarkSeries SpawnedSpawnMs;
+	FMonatyBenchmarkSeries PooledLeaveMs;
+	FMonatyBenchmarkSeries DestroyedLeaveMs;
+};
@@ -0,0 +1,71 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/* Action inputs captured in a recorded frame */
+enum class EMonatyInputActions : uint8
+{
+	None = 0,
+	SprintPressed = 1 << 0,
+	SprintReleased = 1 << 1,
+	JumpPressed = 1 << 2,
+	JumpReleased = 1 << 3,
+	StancePressed = 1 << 4,
+	StanceReleased = 1 << 5,
+	PlaceMode = 1 << 6
+};
+
+ENUM_CLASS_FLAGS(EMonatyInputActions);
+
+enum class EMonatyInputRecorderMode : uint8
+{
+	None,
+	Recording,
+	Replaying
+};
+
+/**
+ * A single frame of character input, plus the state the character ended up in after that frame.
+ */
+struct MONATY_API FMonatyInputFrame
+{
+	/* Input */
+	float DeltaTime = 0.0f;
+	float ForwardBackward = 0.0f;
+	float LeftRight = 0.0f;
+	float LookUpDown = 0.0f;
+	float LookLeftRight = 0.0f;
+	EMonatyInputActions Actions = EMonatyInputActions::None;
+	FRotator3f ControlRotation = FRotator3f::ZeroRotator;
+
+	/* Resulting state */
+	FVector3f Location = FVector3f::ZeroVector;
+	FRotator3f Rotation = FRotator3f::ZeroRotator;
+	uint8 MovementState = 0;
+	uint8 GaitState = 0;
+	uint8 StanceState = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FMonatyInputFrame& Frame);
+};
+
+/**
+ * Binary recording of a character input session, used for deterministic regression replays.
+ */
+struct MONATY_API FMonatyInputRecording
+{
+	static constexpr uint32 FileMagic = 0x4D4E5952; // "MNYR"
+	static constexpr uint32 FileVersion = 1;
+
+	TArray<FMonatyInputFrame> Frames;
+
+	bool SaveToFile(const FString& FilePath) const;
+	bool LoadFromFile(const FString& FilePath);
+
+	// Default location for recordings, relative paths passed to the console commands resolve here.
+	static FString GetRecordingDir();
+	static FString ResolvePath(const FString& FilePath);
+
+	friend FArchive& operator<<(FArchive& Ar, FMonatyInputRecording& Recording);
+};
@@ -0,0 +1,74 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldCollision.h"
+
+/**
+ * Where and when a falling character is going to land. The arc is analytic (constant gravity, no air control) and cut
+ * into a few segments, all swept in one batch of async traces. The prediction only changes when the velocity leaves
+ * the arc, e.g. through air control or a hit, instead of sweeping ahead every frame.
+ */
+struct MONATY_API FMonatyLandingPrediction
+{
+	static constexpr int32 NumSegments = 4;
+
+	// Sweeps the arc starting at Location with Velocity. The result is ready the frame after.
+	void Predict(const UWorld* World, const FVector& Location, const FVector& Velocity, float GravityZ,
+	             const FCollisionShape& Shape, ECollisionChannel Channel, const FCollisionQueryParams& QueryParams);
+
+	// Picks up the sweeps once they are done. Returns true when the prediction changed.
+	bool Update(const UWorld* World);
+
+	// Whether Velocity left the arc far enough, the arc was swept past its end without a hit, or the predicted landing
+	// is overdue while still falling.
+	bool NeedsRefresh(const FVector& Velocity, double Time) const;
+
+	void Reset();
+
+	bool IsPending() const { return Traces[0].IsValid(); }
+	bool HasLanding() const { return bHasLanding; }
+	float GetTimeToLand(double Time) const { return FMath::Max(static_cast<float>(LandingTime - Time), 0.0f); }
+
+	static FVector GetArcLocation(const FVector& Location, const FVector& Velocity, float GravityZ, float Time);
+
+	/* Prediction */
+	// Capsule location at the landing, the actor location once landed.
+	FVector LandingLocation = FVector::ZeroVector;
+	FVector LandingNormal = FVector::UpVector;
+	// World time of the landing.
+	double LandingTime = 0.0;
+	bool bHasLanding = false;
+	// How often this fall was predicted, the first one included.
+	int32 PredictionCount = 0;
+
+	/* Arc */
+	FVector ArcLocation = FVector::ZeroVector;
+	FVector ArcVelocity = FVector::ZeroVector;
+	float ArcGravityZ = 0.0f;
+	double ArcTime = 0.0;
+	// Seconds of the arc that are swept.
+	float ArcDuration = 2.0f;
+	// Only hits with a normal at least this flat count as landings.
+	float WalkableFloorZ = 0.71f;
+	// Seconds past the predicted landing time before a fall that is still going on is predicted again, e.g. after
+	// landing on something that moved away.
+	float OverdueTime = 0.1f;
+
+private:
+	FTraceHandle Traces[NumSegments];
+	uint64 IssueFrame = 0;
+	bool bLost = false;
+};
+
+/**
+ * How far predicted landings were off from the real ones, and what predicting them cost.
+ * Monaty.Landing.Report prints and saves it.
+ */
+struct MONATY_API FMonatyLandingAccuracy
+{
+	static void RecordPrediction(double Milliseconds);
+	static void RecordLanding(const FMonatyLandingPrediction& Prediction, const FVector& Location, double Time);
+	static void Report(bool bReset);
+};
@@ -0,0 +1,75 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Character/MonatyCharacter.h"
+#include "Engine/DataAsset.h"
+#include "Engine/StreamableManager.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "MonatyMovementModelAsset.generated.h"
+
+/**
+ * A movement model shared by every character that uses it.
+ */
+UCLASS(BlueprintType)
+class MONATY_API UMonatyMovementModelAsset : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Movement")
+	FPlayerMovementModel Model;
+
+	const FPlayerMovementSettings& GetSettingsForStance(EPlayerStanceState Stance) const
+	{
+		return Stance == EPlayerStanceState::Crouching ? Model.Crouching : Model.Standing;
+	}
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	// Broadcast when a model is (re)loaded or edited, so characters pick up the new instance.
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnMovementModelChanged, UMonatyMovementModelAsset*);
+	static FOnMovementModelChanged OnMovementModelChanged;
+};
+
+/**
+ * Loads movement models asynchronously once and hands out the shared instance.
+ */
+UCLASS()
+class MONATY_API UMonatyMovementModelSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	DECLARE_DELEGATE_OneParam(FOnMovementModelLoaded, UMonatyMovementModelAsset*);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Calls back once the model is loaded, immediately if it already is.
+	void RequestMovementModel(const TSoftObjectPtr<UMonatyMovementModelAsset>& ModelAsset,
+	                          FOnMovementModelLoaded OnLoaded);
+
+	// Wraps a data table row in a shared transient asset, for characters still using a row handle.
+	UMonatyMovementModelAsset* GetMovementModelFromDataTable(const FDataTableRowHandle& RowHandle);
+
+protected:
+	void OnMovementModelChanged(UMonatyMovementModelAsset* ModelAsset);
+
+	UPROPERTY(Transient)
+	TMap<FSoftObjectPath, UMonatyMovementModelAsset*> LoadedModels;
+
+	UPROPERTY(Transient)
+	TMap<FString, UMonatyMovementModelAsset*> DataTableModels;
+
+	TMap<FSoftObjectPath, TArray<FOnMovementModelLoaded>> PendingRequests;
+	TSharedPtr<FStreamableHandle> PreloadHandle;
+	FDelegateHandle ModelChangedHandle;
+};
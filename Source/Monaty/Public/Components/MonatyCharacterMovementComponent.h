@@ -22,6 +22,12 @@ class MONATY_API UMonatyCharacterMovementComponent : public UCharacterMovementCo
 	virtual float GetMaxAcceleration() const override;
 	virtual float GetMaxBrakingDeceleration() const override;
 
+	// Counts the corrections the server sends to the owning client.
+	virtual void SendClientAdjustment() override;
+
+	// Corrections sent to the owning client so far, server only.
+	int32 ServerCorrectionCount = 0;
+
 	// Movement Settings Variables
 	UPROPERTY()
 	uint8 bRequestMovementSettingsChange = 1;
@@ -34,9 +40,15 @@ class MONATY_API UMonatyCharacterMovementComponent : public UCharacterMovementCo
 
 	// Set Movement Curve (Called in every instance)
 	float GetMappedSpeed() const;
+	float GetMappedSpeed(float Speed) const;
+	static float MapSpeed(float Speed, float WalkSpeed, float SprintSpeed);
+
+	// Movement curve value at the current speed. Evaluated for every move, so replayed moves see the same values as
+	// the first time.
+	FVector3f SampleMovementCurve() const;
 
 	UFUNCTION(BlueprintCallable, Category = "Movement Settings")
-	void SetMovementSettings(FPlayerMovementSettings NewMovementSettings);
+	void SetMovementSettings(const FPlayerMovementSettings& NewMovementSettings);
 
 	// Set Max Walking Speed (Called from the owning client)
 	UFUNCTION(BlueprintCallable, Category = "Movement Settings")
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Placeables/PlaceableActor.h"
+#include "Placeables/PlacementRules.h"
 #include "Engine/DataTable.h"
 #include "PlaceablesComponent.generated.h"
 
@@ -18,6 +19,41 @@ struct FPlaceableData : public FTableRowBase
 
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Placeable")
 	TSubclassOf<AActor> PlacedActorClass;
+
+	// Probe the footprint and tilt onto the surface, instead of standing upright on the aim point.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Placeable|Conform")
+	bool bConformToSurface = false;
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Placeable|Conform", meta=(EditCondition="bConformToSurface"))
+	float MaxSlopeAngle = 30.0f;
+
+	// Largest distance between the fitted plane and any probed point.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Placeable|Conform", meta=(EditCondition="bConformToSurface"))
+	float MaxGap = 20.0f;
+
+	// Half size of the footprint, taken from the preview bounds when zero.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Placeable|Conform", meta=(EditCondition="bConformToSurface"))
+	FVector2D FootprintExtent = FVector2D::ZeroVector;
+
+	// Checked by the preview and again by the server.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Placeable|Rules")
+	FPlacementRules Rules;
+};
+
+// Why the server turned a placement down, recorded in the placement telemetry.
+enum class EPlacementRejection : uint8
+{
+	None,
+	ViewOrigin,
+	OutOfReach,
+	BlockedByCharacter,
+	SpawnFailed,
+	UnknownPlaceable,
+	RuleBroken,
+	// NaN, unnormalized rotation or scaled.
+	InvalidTransform,
+	// Nothing under the placement on the server, or its footprint doesn't fit the ground there.
+	Footprint
 };
 
 UCLASS(Blueprintable, BlueprintType, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
@@ -38,17 +74,43 @@ public:
 	UFUNCTION(BlueprintCallable,Category="Placeables")
 	void ConstructPlaceableActor();
 
+	// ViewOrigin and ClientTime are the camera and server time the client placed with, checked against the
+	// lag compensation history. The server spawns the placed actor class of the row and checks its rules.
+	UFUNCTION(Server, Reliable)
+	void ServerConstructPlaceableActor(const FDataTableRowHandle& Placeable, const FTransform& Transform,
+	                                   const FVector_NetQuantize& ViewOrigin, double ClientTime);
+
 	UFUNCTION(BlueprintCallable,Category="Placeables")
 	void RotatePlaceableLeft(float Value);
 
 	UFUNCTION(BlueprintCallable,Category="Placeables")
 	float RotatePlaceableRight(float Value);
 
+	// Picks up the owner's current controller, called again whenever it changes.
+	bool InitPlaceablesComponents();
+
+	// Leaves place mode and drops the preview and the controller, for characters going back to the pool.
+	void ResetForPool();
+
+	/* Footprint */
+	// Four corners and the center.
+	static constexpr int32 NumFootprintProbes = 5;
+
+	// Where the footprint probes go, in upright placeable space.
+	static void GetFootprintProbePoints(const FVector2D& Extent, FVector (&OutPoints)[NumFootprintProbes]);
+
+	// The row's footprint, or the footprint of the placeable's default components when it has none.
+	static FVector2D GetFootprintExtent(const FPlaceableData& Data);
+
+	// Plane through the ground under the footprint probes. The slope is in degrees, the gap is how far the furthest
+	// point is from the plane.
+	static void FitFootprintPlane(const FVector (&Points)[NumFootprintProbes], FVector& OutNormal,
+	                              FVector& OutCentroid, float& OutSlopeAngle, float& OutGap);
+
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
-	bool InitPlaceablesComponents();
 	void CreatePlaceableActor();
 	FHitResult GetTraceHitResult() const;
 	void UpdatePlaceablePosition();
@@ -57,6 +119,21 @@ protected:
 	FRotator GetPlaceableRotation() const;
 	void UpdatePlaceableTransform(const FTransform& Transform);
 	void UpdatePlaceableMaterials(bool bCanPlace) const;
+	bool ApplyFootprintFit(FTransform& InOutTransform);
+	// bOutSnapped tells whether the server found the placement on a free socket.
+	EPlacementRejection ValidatePlacement(const FDataTableRowHandle& Placeable, const FPlaceableData& Data,
+	                                      const FTransform& Transform, const FVector& ViewOrigin,
+	                                      double ClientTime, bool& bOutSnapped) const;
+	EPlacementRule CheckPlacementRules(const FDataTableRowHandle& Placeable, const FPlacementCandidate& Candidate,
+	                                   bool bRecordStats = false) const;
+	void QueueFootprintProbes(const FTransform& Transform);
+	// Probes the footprint right away and fits the plane, what the server checks a conforming placement against.
+	// False when a probe misses.
+	bool ProbeFootprintPlane(const FTransform& Transform, const FVector2D& Extent, FVector& OutNormal,
+	                         FVector& OutCentroid, float& OutSlopeAngle, float& OutGap) const;
+
+	FTraceHandle FootprintProbes[NumFootprintProbes];
+	FVector2D CurrentFootprintExtent = FVector2D::ZeroVector;
 
 	FTransform GetSpawnPlaceableTransform();
 
@@ -75,15 +152,18 @@ public:
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="Properties|States")
 	bool bIsPlacing = false;
 
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="Properties|Placeable")
-	bool bDebugMode = true;
-
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="Properties|Placeable")
 	bool bCanPlaceActor = false;
 
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="Properties|Placeable")
 	FPlaceableData CurrentPlaceableData = {};
 
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="Properties|Placeable")
+	FDataTableRowHandle CurrentPlaceableHandle;
+
+	// Rule the preview breaks, None when it passes them all.
+	EPlacementRule BrokenRule = EPlacementRule::None;
+
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="Properties|Placeable")
 	APlaceableActor* CurrentPlaceable = nullptr;
 
@@ -99,6 +179,27 @@ public:
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Properties|Placeable")
 	float PlaceableRotationZ = 0.0f;
 
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Properties|Placeable")
+	bool bSnapEnabled = true;
+
+	// How far a snap point may be from a free socket to snap to it.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Properties|Placeable")
+	float SnapDistance = 75.0f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="Properties|Placeable")
+	bool bIsSnapped = false;
+
+	// How far below and above the aim point the footprint probes reach.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Properties|Placeable")
+	float FootprintProbeDistance = 200.0f;
+
+	// Fit of the last probed footprint.
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="Properties|Placeable")
+	float FootprintSlopeAngle = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category="Properties|Placeable")
+	float FootprintGap = 0.0f;
+
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Properties|Placeable")
 	UMaterialInterface* AllowPlaceMaterial;
 
@@ -0,0 +1,89 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Debug drawing and the debug log are compiled out of shipping builds, calls through the macros cost nothing there.
+#define MONATY_WITH_DEBUG !UE_BUILD_SHIPPING
+
+/* Debug channels, each toggled with monaty.Debug.<Channel> */
+enum class EMonatyDebugChannel : uint8
+{
+	Placement,
+	Footprint,
+	Snap,
+	Locomotion,
+	Count
+};
+
+enum class EMonatyDebugEvent : uint8
+{
+	// Start and End are the trace, Values[0] whether it hit.
+	Trace,
+	// Start is the placement, Values[0] whether it can be placed, Values[1] whether it is snapped.
+	PlacementValidity,
+	// Start is the placement, Values[0] whether it fits, Scalar the slope angle, Scalar2 the gap.
+	FootprintFit,
+	// Start is the placement, Values[0] the server's rejection reason.
+	PlacementRejected,
+	// Start is the character, Values are the previous and the new state.
+	GaitChanged,
+	StanceChanged,
+	MovementStateChanged
+};
+
+/**
+ * One debug log entry, small and without allocations so recording stays cheap.
+ */
+struct FMonatyDebugEntry
+{
+	double Time = 0.0;
+	uint64 Frame = 0;
+	uint32 Source = 0;
+	EMonatyDebugChannel Channel = EMonatyDebugChannel::Placement;
+	EMonatyDebugEvent Event = EMonatyDebugEvent::Trace;
+	uint8 Values[2] = {};
+	FVector3f Start = FVector3f::ZeroVector;
+	FVector3f End = FVector3f::ZeroVector;
+	float Scalar = 0.0f;
+	float Scalar2 = 0.0f;
+};
+
+/**
+ * Debug channels and a ring buffer of what placement and locomotion decided recently.
+ * Monaty.Debug.DumpLog writes the ring to CSV, Monaty.Debug.DrawLog draws it back into the world.
+ */
+struct MONATY_API FMonatyDebug
+{
+	static bool ChannelEnabled[static_cast<int32>(EMonatyDebugChannel::Count)];
+	static bool bRecord;
+
+	static bool IsEnabled(EMonatyDebugChannel Channel) { return ChannelEnabled[static_cast<int32>(Channel)]; }
+
+	static void Record(const FMonatyDebugEntry& Entry);
+	static void Record(EMonatyDebugChannel Channel, EMonatyDebugEvent Event, const UObject* Source,
+	                   const FVector& Start, const FVector& End = FVector::ZeroVector, uint8 Value0 = 0,
+	                   uint8 Value1 = 0, float Scalar = 0.0f, float Scalar2 = 0.0f);
+
+	static bool DumpCsv(const FString& FilePath);
+	// Draws the entries of the last Seconds, so a decision can be looked at after it happened.
+	static void DrawRecent(const UWorld* World, double Seconds, float Duration);
+};
+
+#if MONATY_WITH_DEBUG
+#define MONATY_DEBUG_ENABLED(Channel) FMonatyDebug::IsEnabled(EMonatyDebugChannel::Channel)
+// A single statement, so it is safe in an unbraced if/else.
+#define MONATY_DEBUG_RECORD(Channel, Event, Source, ...) \
+	do \
+	{ \
+		if (FMonatyDebug::bRecord) \
+		{ \
+			FMonatyDebug::Record(EMonatyDebugChannel::Channel, EMonatyDebugEvent::Event, Source, __VA_ARGS__); \
+		} \
+	} \
+	while (0)
+#else
+#define MONATY_DEBUG_ENABLED(Channel) false
+#define MONATY_DEBUG_RECORD(Channel, Event, Source, ...) do {} while (0)
+#endif
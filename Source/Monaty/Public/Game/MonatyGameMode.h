@@ -0,0 +1,35 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameModeBase.h"
+#include "MonatyGameMode.generated.h"
+
+/**
+ * Spawns players as Monaty characters, taken from the character pool when it is enabled.
+ */
+UCLASS()
+class MONATY_API AMonatyGameMode : public AGameModeBase
+{
+	GENERATED_BODY()
+
+public:
+	AMonatyGameMode();
+
+	// Parks the controller's character in the pool and spawns the player again.
+	UFUNCTION(BlueprintCallable, Category = "Pool")
+	void RespawnPlayer(AController* Controller);
+
+	virtual void StartPlay() override;
+	virtual APawn* SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer,
+	                                                          const FTransform& SpawnTransform) override;
+
+	// Characters constructed when play starts, so the first joins are already pooled.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Pool", meta = (ClampMin = "0"))
+	int32 PrewarmedCharacters = 8;
+
+	// Parks the controller's character in the pool, false when there is nothing to park or no pool. Leaving players
+	// release theirs from AMonatyPlayerController::PawnLeavingGame, Logout runs after the pawn is gone.
+	bool ReleaseCharacter(AController* Controller);
+};
@@ -0,0 +1,21 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerController.h"
+#include "MonatyPlayerController.generated.h"
+
+/**
+ * Player controller of AMonatyGameMode. Hands its character back to the pool when the player leaves, instead of
+ * destroying it.
+ */
+UCLASS()
+class MONATY_API AMonatyPlayerController : public APlayerController
+{
+	GENERATED_BODY()
+
+public:
+	// Runs from Destroyed, before the game mode's Logout, while the pawn is still possessed.
+	virtual void PawnLeavingGame() override;
+};
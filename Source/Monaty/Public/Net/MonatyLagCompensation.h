@@ -0,0 +1,135 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MonatyLagCompensation.generated.h"
+
+class ACharacter;
+
+/**
+ * Where a character's capsule was at one point in time. 24 bytes, so a frame of 128 characters is 3 KB.
+ */
+struct FMonatyCapsuleSample
+{
+	FVector3f Location = FVector3f::ZeroVector;
+	float Yaw = 0.0f;
+	float Radius = 0.0f;
+	// Zero when the character was not recorded in that frame.
+	float HalfHeight = 0.0f;
+
+	bool IsValid() const { return HalfHeight > 0.0f; }
+
+	// Closest distance between the capsule and a segment, minus the radius. Negative when they overlap.
+	float GetSegmentDistance(const FVector& Start, const FVector& End) const;
+};
+
+/**
+ * Fixed size history of character capsules, one row per recorded frame.
+ * Rows are laid out frame after frame, so a query over every character at one time reads two contiguous rows.
+ * Memory is allocated once in Init and bounded by MaxCharacters * MaxFrames samples.
+ */
+class MONATY_API FMonatyCapsuleHistory
+{
+public:
+	void Init(int32 InMaxCharacters, int32 InMaxFrames);
+
+	// Returns the slot the character records into, INDEX_NONE when full.
+	int32 AddCharacter();
+	void RemoveCharacter(int32 Slot);
+
+	// Starts a new row at Time, overwriting the oldest one when full. Slots not written stay invalid.
+	void BeginFrame(double Time);
+	void Record(int32 Slot, const FMonatyCapsuleSample& Sample);
+
+	// Capsule of the slot interpolated at Time. Fails when Time is outside the history or the slot was not recorded.
+	bool Rewind(int32 Slot, double Time, FMonatyCapsuleSample& OutSample) const;
+
+	// Calls Visitor(Slot, Sample) for every character recorded around Time.
+	template <typename VisitorType>
+	void ForEachAt(double Time, VisitorType&& Visitor) const;
+
+	double GetOldestTime() const;
+	double GetNewestTime() const;
+	int32 GetNumFrames() const { return NumFrames; }
+	int32 GetMaxCharacters() const { return MaxCharacters; }
+	SIZE_T GetAllocatedSize() const { return Samples.GetAllocatedSize() + FrameTimes.GetAllocatedSize(); }
+
+protected:
+	// Finds the rows around Time and how far between them it is.
+	bool FindFrames(double Time, int32& OutOlder, int32& OutNewer, float& OutAlpha) const;
+	int32 GetRow(int32 Age) const { return (Head - Age + MaxFrames) % MaxFrames; }
+
+	static FMonatyCapsuleSample Lerp(const FMonatyCapsuleSample& A, const FMonatyCapsuleSample& B, float Alpha);
+
+	int32 MaxCharacters = 0;
+	int32 MaxFrames = 0;
+	int32 Head = INDEX_NONE;
+	int32 NumFrames = 0;
+	TArray<FMonatyCapsuleSample> Samples;
+	TArray<double> FrameTimes;
+	TBitArray<> UsedSlots;
+};
+
+template <typename VisitorType>
+void FMonatyCapsuleHistory::ForEachAt(double Time, VisitorType&& Visitor) const
+{
+	int32 Older, Newer;
+	float Alpha;
+	if (!FindFrames(Time, Older, Newer, Alpha))
+	{
+		return;
+	}
+	const FMonatyCapsuleSample* OlderRow = &Samples[Older * MaxCharacters];
+	const FMonatyCapsuleSample* NewerRow = &Samples[Newer * MaxCharacters];
+	for (TConstSetBitIterator<> It(UsedSlots); It; ++It)
+	{
+		const int32 Slot = It.GetIndex();
+		if (OlderRow[Slot].IsValid() && NewerRow[Slot].IsValid())
+		{
+			Visitor(Slot, Lerp(OlderRow[Slot], NewerRow[Slot], Alpha));
+		}
+	}
+}
+
+/**
+ * Records every character's capsule each server tick, so checks coming from clients can be made against the
+ * world as the client saw it.
+ */
+UCLASS()
+class MONATY_API UMonatyLagCompensationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void RegisterCharacter(ACharacter* Character);
+	void UnregisterCharacter(ACharacter* Character);
+
+	// Clamps a time sent by a client to what the history covers and MaxRewindMs allows.
+	double GetRewindTime(double ClientTime) const;
+
+	bool RewindCharacter(const ACharacter* Character, double Time, FMonatyCapsuleSample& OutSample) const;
+
+	// Characters whose rewound capsule overlaps the sphere.
+	int32 OverlapSphere(double Time, const FVector& Center, float Radius, TArray<ACharacter*>& OutCharacters,
+	                    const AActor* IgnoreActor = nullptr) const;
+
+	// The first rewound capsule along the segment.
+	ACharacter* LineTrace(double Time, const FVector& Start, const FVector& End, const AActor* IgnoreActor = nullptr) const;
+
+	const FMonatyCapsuleHistory& GetHistory() const { return History; }
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return SlotCharacters.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+
+protected:
+	FMonatyCapsuleHistory History;
+
+	// Indexed by history slot.
+	TArray<TWeakObjectPtr<ACharacter>> SlotCharacters;
+	TMap<TObjectKey<ACharacter>, int32> CharacterSlots;
+};
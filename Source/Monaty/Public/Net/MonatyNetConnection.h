@@ -0,0 +1,24 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IpConnection.h"
+#include "MonatyNetConnection.generated.h"
+
+/**
+ * Connection of UMonatyNetDriver, measures the bunches an RPC is sent in for FMonatyNetStats.
+ */
+UCLASS(Transient, Config=Engine)
+class MONATY_API UMonatyNetConnection : public UIpConnection
+{
+	GENERATED_BODY()
+
+public:
+	// Set by UMonatyNetDriver around a remote function call, the bits of every bunch sent meanwhile add up.
+	bool bCountingRPC = false;
+	int64 CountedRPCBits = 0;
+
+	using Super::SendRawBunch;
+	virtual int32 SendRawBunch(FOutBunch& Bunch, bool InAllowMerge, const FNetTraceCollector* BunchCollector) override;
+};
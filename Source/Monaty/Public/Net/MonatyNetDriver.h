@@ -0,0 +1,21 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IpNetDriver.h"
+#include "MonatyNetDriver.generated.h"
+
+/**
+ * Game net driver that accounts the outgoing size of every RPC in FMonatyNetStats, measured by its
+ * UMonatyNetConnection as the bunches the call is sent in.
+ */
+UCLASS(Transient, Config=Engine)
+class MONATY_API UMonatyNetDriver : public UIpNetDriver
+{
+	GENERATED_BODY()
+
+public:
+	virtual void ProcessRemoteFunction(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms,
+	                                   FFrame* Stack, UObject* SubObject = nullptr) override;
+};
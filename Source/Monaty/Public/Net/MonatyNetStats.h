@@ -0,0 +1,113 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/CoreNetTypes.h"
+
+class UActorChannel;
+class UNetConnection;
+struct FReplicationFlags;
+
+/* What a net stat entry counts */
+enum class EMonatyNetStatKind : uint8
+{
+	// Remote function calls, by class and function.
+	RPC,
+	// Replicated properties of an actor, by class, measured as the bunch size before subobjects.
+	Actor,
+	// One replicated property, by class and property.
+	Property
+};
+
+struct FMonatyNetStatKey
+{
+	uint32 ConnectionId = 0;
+	EMonatyNetStatKind Kind = EMonatyNetStatKind::RPC;
+	FName Name;
+
+	bool operator==(const FMonatyNetStatKey& Other) const
+	{
+		return ConnectionId == Other.ConnectionId && Kind == Other.Kind && Name == Other.Name;
+	}
+
+	friend uint32 GetTypeHash(const FMonatyNetStatKey& Key)
+	{
+		return HashCombine(HashCombine(Key.ConnectionId, static_cast<uint32>(Key.Kind)), GetTypeHash(Key.Name));
+	}
+};
+
+struct FMonatyNetStatEntry
+{
+	uint64 Calls = 0;
+	uint64 Bits = 0;
+};
+
+/**
+ * Outgoing bytes and calls per RPC and replicated property, per connection, in one second buckets.
+ * On by default outside of shipping builds, where it is compiled out. Turn it off with monaty.Net.Stats 0 while
+ * measuring the server itself. Monaty.Net.Print shows them. Game thread only.
+ */
+class MONATY_API FMonatyNetStats
+{
+public:
+	static FMonatyNetStats& Get();
+	static bool IsEnabled();
+
+	void Record(EMonatyNetStatKind Kind, FName Name, const UNetConnection* Connection, int64 Bits);
+	// Records the replicated properties of Actor that changed since they last went out on Channel, call it once they
+	// are written, from ReplicateSubobjects. Each counts at its serialized size, without the handle in front of it.
+	void RecordProperties(const AActor* Actor, UActorChannel* Channel, const FReplicationFlags& RepFlags);
+
+	// Name used for an RPC, Class::Function.
+	FName GetFunctionName(const UFunction* Function);
+
+	void Reset();
+	void Print(FOutputDevice& Ar, int32 MaxRows);
+	bool DumpCsv(const FString& FilePath);
+
+	// Seconds of per second rows kept for the CSV.
+	static constexpr int32 MaxHistorySeconds = 600;
+
+protected:
+	struct FSecondRow
+	{
+		int32 Second;
+		FMonatyNetStatKey Key;
+		FMonatyNetStatEntry Entry;
+	};
+
+	// A replicated property, or one element of a replicated static array.
+	struct FPropertyLayout
+	{
+		const FProperty* Property = nullptr;
+		int32 ArrayIndex = 0;
+		ELifetimeCondition Condition = COND_None;
+		FName Name;
+		// Serialized value of the class default, a new channel only sends what differs from it.
+		TArray<uint8> DefaultValue;
+		int64 DefaultBits = 0;
+	};
+
+	struct FPropertyValue
+	{
+		TArray<uint8> Value;
+		int64 Bits = 0;
+	};
+
+	void RollSecond(double Now);
+	const TArray<FPropertyLayout>& GetPropertyLayout(const UClass* Class);
+
+	TMap<FMonatyNetStatKey, FMonatyNetStatEntry> Totals;
+	TMap<FMonatyNetStatKey, FMonatyNetStatEntry> CurrentSecond;
+	TMap<FMonatyNetStatKey, FMonatyNetStatEntry> LastSecond;
+	TArray<FSecondRow> History;
+	TMap<uint32, FString> ConnectionNames;
+	TMap<const UFunction*, FName> FunctionNames;
+	TMap<const UClass*, TArray<FPropertyLayout>> PropertyLayouts;
+	// What each channel last sent per property, in the order of the class's layout.
+	TMap<TWeakObjectPtr<UActorChannel>, TArray<FPropertyValue>> ChannelValues;
+	double StartTime = 0.0;
+	double SecondStartTime = 0.0;
+	int32 SecondIndex = 0;
+};
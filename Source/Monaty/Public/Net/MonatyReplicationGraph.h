@@ -0,0 +1,72 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "MonatyReplicationGraph.generated.h"
+
+/* How actors of a class are routed into the graph nodes */
+enum class EMonatyReplicationRoute : uint8
+{
+	// Handled elsewhere, e.g. player controllers by their connection node.
+	NotRouted,
+	AlwaysRelevant,
+	OwnerRelevant,
+	SpatializeStatic,
+	SpatializeDynamic,
+	// Static while dormant, moved to the dynamic grid only while awake.
+	SpatializeDormancy
+};
+
+/**
+ * Replication graph for Monaty. Characters go into a 2D spatial grid, placed structures into the same grid as
+ * dormant actors that only cost anything when they change, and player owned state into always relevant nodes.
+ */
+UCLASS(Transient, Config=Engine)
+class MONATY_API UMonatyReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RemoveClientConnection(UNetConnection* NetConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo,
+	                                         FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+	EMonatyReplicationRoute GetRouteForClass(UClass* Class);
+
+	/* Properties */
+	UPROPERTY(Config)
+	float GridCellSize = 10000.0f;
+
+	// Most negative world position the grid expects, keeps the cells from being rebuilt as actors spread out.
+	UPROPERTY(Config)
+	FVector2D GridSpatialBias = FVector2D(-200000.0f, -200000.0f);
+
+	UPROPERTY(Config)
+	float PlacedActorCullDistance = 20000.0f;
+
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* GridNode = nullptr;
+
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* AlwaysRelevantNode = nullptr;
+
+	UPROPERTY()
+	TMap<UNetConnection*, UReplicationGraphNode_AlwaysRelevant_ForConnection*> OwnerRelevantNodes;
+
+	// Owner relevant actors that had no connection yet when they were added, retried every frame.
+	UPROPERTY()
+	TArray<AActor*> ActorsWithoutNetConnection;
+
+protected:
+	void SetClassInfo(UClass* Class, bool bSpatialize, float CullDistance = 0.0f);
+	void RouteActorsWithoutNetConnection();
+
+	TMap<UClass*, EMonatyReplicationRoute> ClassRoutes;
+};
@@ -22,9 +22,6 @@ protected:
 	void InitializeCollisionResponses() const;
 
 public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
 	/* Components */
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Components")
 	USceneComponent* PlaceableRootComponent;
@@ -0,0 +1,80 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "PlaceableSnapIndex.generated.h"
+
+/**
+ * A socket on a placed structure that other structures can snap to.
+ */
+USTRUCT(BlueprintType)
+struct FPlaceableSnapPoint
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Snap")
+	FName Type;
+
+	// Types this point accepts, the point's own type when empty.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Snap")
+	TArray<FName> CompatibleTypes;
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Snap")
+	FVector LocalOffset = FVector::ZeroVector;
+
+	// Facing of the socket, pointing away from the structure.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Snap")
+	float LocalYaw = 0.0f;
+
+	bool Accepts(FName OtherType) const
+	{
+		return CompatibleTypes.Num() > 0 ? CompatibleTypes.Contains(OtherType) : OtherType == Type;
+	}
+
+	bool IsCompatibleWith(const FPlaceableSnapPoint& Other) const
+	{
+		return Accepts(Other.Type) && Other.Accepts(Type);
+	}
+};
+
+/**
+ * Free snap points of every placed structure, bucketed in a uniform grid so the nearest compatible one can be found
+ * by looking at a handful of cells. Updated as structures are placed and removed.
+ */
+struct MONATY_API FPlaceableSnapIndex
+{
+	struct FEntry
+	{
+		TObjectKey<AActor> Owner;
+		FPlaceableSnapPoint Point;
+		FVector Location;
+		FQuat Rotation;
+		// Entry this point is snapped to, it is not free while set.
+		int32 OccupiedBy = INDEX_NONE;
+	};
+
+	explicit FPlaceableSnapIndex(float InCellSize = 200.0f) : CellSize(InCellSize)
+	{
+	}
+
+	void AddActor(const AActor* Actor, const TArray<FPlaceableSnapPoint>& Points);
+	void RemoveActor(const AActor* Actor);
+
+	// Nearest free point within Radius that is compatible with Point, INDEX_NONE if there is none.
+	int32 FindNearest(const FVector& Location, float Radius, const FPlaceableSnapPoint& Point) const;
+
+	const FEntry& GetEntry(int32 EntryIndex) const { return Entries[EntryIndex]; }
+	int32 GetNumFree() const;
+
+protected:
+	FIntVector GetCell(const FVector& Location) const;
+	void AddToCell(int32 EntryIndex);
+	void RemoveFromCell(int32 EntryIndex);
+
+	float CellSize;
+	TSparseArray<FEntry> Entries;
+	TMap<FIntVector, TArray<int32>> Cells;
+	TMap<TObjectKey<AActor>, TArray<int32>> ActorEntries;
+};
@@ -0,0 +1,157 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "Placeables/PlaceableSnapIndex.h"
+#include "Placeables/PlacementJournal.h"
+#include "Placeables/PlacementRules.h"
+#include "Placeables/PlacementSpatialIndex.h"
+#include "Placeables/PlacementsSaveGame.h"
+#include "Profiling/MonatyBenchmark.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PlaceablesSubsystem.generated.h"
+
+class APlayerState;
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnPlacementsRestoreProgress, int32 /* Restored */, int32 /* Total */);
+
+/**
+ * Owns the placed structures of a world: spawns them, saves them and restores them over several frames.
+ */
+UCLASS()
+class MONATY_API UPlaceablesSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Spawns a placed actor the same way the placeables component does when a placement is confirmed.
+	// Placements restored from the autosave pass their id, they are already persisted.
+	AActor* SpawnPlacedActor(TSubclassOf<AActor> PlacedActorClass, const FTransform& Transform,
+	                         uint32 OwnerId = 0, uint32 PlacementId = 0);
+
+	// Adds a placed actor to the snap and spatial indices, called from its BeginPlay on servers and clients alike.
+	void RegisterPlacedActor(class APlacedActor* PlacedActor);
+	void UnregisterPlacedActor(const class APlacedActor* PlacedActor);
+
+	// Stable id of a player across sessions, what placements record as their owner.
+	static uint32 GetOwnerId(const APlayerState* PlayerState);
+
+	/* Area operations */
+	// Placements matching the query, found through the spatial index. Returns how many.
+	int32 QueryPlacements(const FPlacementQuery& Query, TArray<AActor*>& OutActors);
+
+	// Damages every matching placed actor, the ones running out of health are removed together.
+	// Returns how many were removed.
+	int32 DamagePlacements(const FPlacementQuery& Query, float Damage);
+
+	// Removes every matching placement together. Returns how many.
+	int32 RemovePlacements(const FPlacementQuery& Query);
+
+	// Destroys the placements with navigation locked, so it rebuilds once for all of them. On a server the clients get
+	// them in batches through APlacementRemovals instead of one destruction per placement.
+	void RemovePlacedActors(TArrayView<AActor* const> Actors);
+
+	// Spawns new placements in one go with navigation locked, the counterpart of RemovePlacedActors.
+	// Returns how many spawned.
+	int32 SpawnPlacedActors(TArrayView<const FSavedPlacement> Placements);
+
+	const FPlacementSpatialIndex& GetPlacementIndex() const { return PlacementIndex; }
+
+	/* Placement rules */
+	// Rules of the placeable's row. Every row of its table is compiled the first time the table is seen.
+	// Null for rows that don't exist.
+	const FPlacementRuleProgram* GetRuleProgram(const FDataTableRowHandle& Placeable);
+
+	// Runs the program over all candidates one rule at a time, so a rule's lookups stay warm for the whole batch.
+	// OutResults gets the first rule each candidate breaks, None when it passes. Only evaluations with bRecordStats
+	// count towards the rule stats, the server's validation passes it and the client previews don't.
+	void EvaluatePlacementRules(const FPlacementRuleProgram& Program, uint32 OwnerId,
+	                            TArrayView<const FPlacementCandidate> Candidates,
+	                            TArrayView<EPlacementRule> OutResults, bool bRecordStats = false);
+
+	// Returns the id to remove the zone with. Zones only exist in this world, the server shares owned regions with
+	// its clients through APlacementOwnedRegion and no build zones through APlacementNoBuildVolume.
+	int32 AddPlacementZone(const FPlacementZone& Zone) { return ZoneIndex.Add(Zone); }
+	void RemovePlacementZone(int32 ZoneId) { ZoneIndex.Remove(ZoneId); }
+	const FPlacementZoneIndex& GetZoneIndex() const { return ZoneIndex; }
+
+	void PrintRuleStats(FOutputDevice& Ar) const;
+	void ResetRuleStats();
+
+	// Queues the placement for the next autosave.
+	void MarkPlacementDirty(const AActor* PlacedActor);
+
+	// Hands every dirty placement to the autosave writer. Only copies, the writing happens on its thread.
+	void FlushDirtyPlacements();
+	void PrintAutosaveStats(FOutputDevice& Ar) const;
+
+	// Finds where a structure of PlacedActorClass snaps to when placed near Transform. Returns false if nothing is
+	// within SnapDistance of any of its snap points.
+	bool FindSnapTransform(TSubclassOf<AActor> PlacedActorClass, const FTransform& Transform, float SnapDistance,
+	                       FTransform& OutTransform) const;
+
+	const FPlaceableSnapIndex& GetSnapIndex() const { return SnapIndex; }
+
+	bool SavePlacements(const FString& SlotName);
+	bool RestorePlacements(const FString& SlotName);
+
+	// Queues placements to be spawned within the per frame budget, closest to a player first. Called while restoring,
+	// the new placements join the ones still queued.
+	void StartRestore(const TArray<FSavedPlacement>& Placements);
+
+	bool IsRestoring() const { return PendingRestore.Num() > 0; }
+	float GetRestoreProgress() const;
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return IsRestoring() || Journal.IsValid(); }
+	virtual TStatId GetStatId() const override;
+
+	FOnPlacementsRestoreProgress OnRestoreProgress;
+
+protected:
+	void TickRestore();
+	void FinishRestore();
+	void StartAutosave();
+
+	UFUNCTION()
+	void OnPlacedActorDestroyed(AActor* DestroyedActor);
+
+	FPlaceableSnapIndex SnapIndex;
+	FPlacementSpatialIndex PlacementIndex;
+
+	/* Placement rules */
+	FPlacementZoneIndex ZoneIndex;
+	TMap<TObjectKey<UDataTable>, TMap<FName, FPlacementRuleProgram>> RulePrograms;
+	uint64 RuleRejections[static_cast<int32>(EPlacementRule::Count)] = {};
+	uint64 RuleCandidates = 0;
+	double RuleSeconds = 0.0;
+
+	// Server only.
+	UPROPERTY(Transient)
+	class APlacementRemovals* PlacementRemovals = nullptr;
+
+	/* Autosave */
+	// Every placement the subsystem spawned that still exists.
+	TMap<TObjectKey<AActor>, uint32> PlacementIds;
+	// Placements changed since the last flush, a removed one maps to a stale pointer.
+	TMap<uint32, TWeakObjectPtr<AActor>> DirtyPlacements;
+	uint32 NextPlacementId = 1;
+	TUniquePtr<FPlacementJournal> Journal;
+	float AutosaveTimer = 0.0f;
+	int32 FlushedRecordCount = 0;
+	FMonatyBenchmarkSeries AutosaveCostMs;
+
+	// Sorted furthest first, so the next placement to spawn is popped off the end.
+	TArray<FSavedPlacement> PendingRestore;
+	// Placements that spawned, failed ones leave the total.
+	int32 RestoreTotal = 0;
+	int32 RestoredCount = 0;
+	int32 RestoreFailedCount = 0;
+	int32 RestoreFrames = 0;
+	double RestoreSpawnSeconds = 0.0;
+	double RestoreStartTime = 0.0;
+};
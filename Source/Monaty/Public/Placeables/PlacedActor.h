@@ -0,0 +1,73 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Placeables/PlaceableSnapIndex.h"
+#include "PlacedActor.generated.h"
+
+/**
+ * A structure placed in the world. Replicated, but dormant until something about it changes.
+ */
+UCLASS()
+class MONATY_API APlacedActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	APlacedActor();
+
+	// Wakes the actor up so the change reaches clients, it goes back to sleep once sent.
+	UFUNCTION(BlueprintCallable, Category="Placed")
+	void NotifyPlacementChanged();
+
+	// Per frame logic of functional structures, ticked in batches by UPlacedLogicManager when bHasPlacedLogic is set.
+	virtual void TickPlacedLogic(float DeltaTime)
+	{
+	}
+
+	UFUNCTION(BlueprintImplementableEvent, Category="Placed", meta=(DisplayName="Tick Placed Logic"))
+	void ReceiveTickPlacedLogic(float DeltaTime);
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual bool ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
+
+	/* Components */
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Components")
+	USceneComponent* PlacedRootComponent;
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Components")
+	UStaticMeshComponent* PlacedMeshComponent;
+
+	/* Properties */
+	// Sockets other structures snap to, in actor space.
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category="Placed")
+	TArray<FPlaceableSnapPoint> SnapPoints;
+
+	// Bumped on every change, so clients can tell a placement was modified.
+	UPROPERTY(BlueprintReadOnly, Replicated, Category="Placed")
+	int32 PlacementRevision = 0;
+
+	// Health a placement is built with, area damage removes it at zero.
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category="Placed")
+	float MaxHealth = 100.0f;
+
+	// The only copy of the health, UPlaceablesSubsystem applies the damage to it.
+	UPROPERTY(BlueprintReadOnly, Replicated, Category="Placed")
+	float Health = 0.0f;
+
+	// Who placed it, see UPlaceablesSubsystem::GetOwnerId. Replicated so clients index it under the same owner.
+	UPROPERTY(Replicated)
+	uint32 PlacementOwnerId = 0;
+
+	// Doors, turrets, generators. Placed actors never get their own tick function.
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category="Placed")
+	bool bHasPlacedLogic = false;
+
+	// Where UPlacedLogicManager keeps this actor.
+	int32 PlacedLogicBucket = INDEX_NONE;
+	int32 PlacedLogicIndex = INDEX_NONE;
+};
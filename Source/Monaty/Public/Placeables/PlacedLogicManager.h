@@ -0,0 +1,63 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PlacedLogicManager.generated.h"
+
+class APlacedActor;
+
+/**
+ * Placed actors of one class with logic, kept in parallel arrays so a batch walks them in order.
+ */
+struct FPlacedLogicBucket
+{
+	UClass* Class = nullptr;
+	// Whether the class overrides the Blueprint event, looked up once for the class.
+	bool bScriptTick = false;
+	TArray<APlacedActor*> Actors;
+	TArray<FVector3f> Locations;
+	TArray<double> LastTickTimes;
+};
+
+/**
+ * Ticks the logic of every placed actor that has some, class by class, instead of one tick function per actor.
+ * Actors far from every player tick at a reduced rate, and with a frame budget the batch resumes where it stopped
+ * on the next frame. Each actor gets the time since its own last tick.
+ */
+UCLASS()
+class MONATY_API UPlacedLogicManager : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Placed actors don't move, their location is taken once here.
+	void RegisterActor(APlacedActor* Actor);
+	void UnregisterActor(APlacedActor* Actor);
+
+	int32 GetNumActors() const;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return Buckets.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+
+protected:
+	// Swaps the last actor of the bucket into the slot.
+	void RemoveFromBucket(int32 BucketIndex, int32 Index);
+	void GatherViewLocations();
+	float GetDistanceSquaredToViewers(const FVector3f& Location) const;
+
+	TArray<FPlacedLogicBucket> Buckets;
+	TMap<UClass*, int32> BucketIndices;
+	TArray<FVector3f> ViewLocations;
+
+	// Where a budgeted batch stopped.
+	int32 BucketCursor = 0;
+	int32 ActorCursor = 0;
+
+	// Actors unregistered by the logic of a batch leave a null slot, removed once the batch is done so the walk
+	// doesn't skip the actor swapped into it.
+	bool bTickingBatch = false;
+	TArray<FIntPoint> PendingRemovals;
+};
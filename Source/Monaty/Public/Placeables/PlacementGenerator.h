@@ -0,0 +1,118 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "Placeables/PlacementsSaveGame.h"
+#include "PlacementGenerator.generated.h"
+
+struct FPlaceableData;
+
+USTRUCT(BlueprintType)
+struct FPlacementTemplatePiece
+{
+	GENERATED_BODY()
+
+	// FPlaceableData row the piece is built from, the same rows players place.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Template", meta=(RowType="PlaceableData"))
+	FDataTableRowHandle Placeable;
+
+	// Relative to the template origin, which ends up on the ground.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Template")
+	FTransform Transform;
+};
+
+/**
+ * A group of placeables seeded as one, an outpost, a wall run or ruins. Either every piece fits or none is placed.
+ */
+USTRUCT(BlueprintType)
+struct FPlacementTemplate : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Template")
+	TArray<FPlacementTemplatePiece> Pieces;
+
+	// Other templates and existing structures stay outside of it.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Template", meta=(ClampMin="0.0"))
+	float Radius = 1000.0f;
+
+	// How often it is picked relative to the other rows.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Template", meta=(ClampMin="0.0"))
+	float Weight = 1.0f;
+};
+
+struct MONATY_API FPlacementGeneratorSettings
+{
+	int32 Seed = 0;
+	int32 SiteCount = 1000;
+	FBox2D Area = FBox2D(FVector2D(-50000.0f), FVector2D(50000.0f));
+	// Height range the ground probes cover.
+	float ProbeTop = 50000.0f;
+	float ProbeBottom = -50000.0f;
+	// Runs everything on the calling thread. The output is the same either way.
+	bool bSingleThreaded = false;
+};
+
+struct MONATY_API FPlacementGeneratorResult
+{
+	// In site order, then piece order.
+	TArray<FSavedPlacement> Placements;
+	int32 SitesAccepted = 0;
+	int32 SitesRejected = 0;
+	double ExpandSeconds = 0.0;
+	double ProbeSeconds = 0.0;
+	double ValidateSeconds = 0.0;
+
+	// Changes with any class or transform, to compare runs.
+	uint32 GetChecksum() const;
+	double GetPlacementsPerSecond() const;
+};
+
+/**
+ * Expands weighted templates into placements over an area. Sites are expanded and their pieces ground probed in
+ * parallel, each into its own slot and drawing from a random stream seeded with the seed and its index, so the output
+ * only depends on the seed. Sites are then accepted in index order on the calling thread.
+ */
+class MONATY_API FPlacementGenerator
+{
+public:
+	FPlacementGenerator(UWorld* InWorld, const UDataTable* TemplateTable);
+
+	bool HasTemplates() const { return Templates.Num() > 0; }
+
+	// Doesn't spawn anything, hand the result to UPlaceablesSubsystem::SpawnPlacedActors.
+	void Generate(const FPlacementGeneratorSettings& Settings, FPlacementGeneratorResult& OutResult) const;
+
+private:
+	struct FPiece
+	{
+		const FPlaceableData* Data = nullptr;
+		FTransform Transform;
+	};
+
+	struct FTemplate
+	{
+		TArray<FPiece> Pieces;
+		float Radius = 0.0f;
+	};
+
+	struct FCandidate
+	{
+		int32 Site = INDEX_NONE;
+		const FPlaceableData* Data = nullptr;
+		FTransform Transform;
+		bool bGrounded = false;
+	};
+
+	int32 PickTemplate(float Roll) const;
+	// Drops the candidate onto the ground and checks its footprint, safe to call from any thread.
+	void ProbeCandidate(FCandidate& Candidate, const FPlacementGeneratorSettings& Settings) const;
+
+	UWorld* World;
+	TArray<FTemplate> Templates;
+	// Running total of the template weights, for picking.
+	TArray<float> CumulativeWeights;
+	float MaxRadius = 0.0f;
+};
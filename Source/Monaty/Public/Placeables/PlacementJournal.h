@@ -0,0 +1,89 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+
+/**
+ * The persisted state of one placement, or its removal.
+ */
+struct MONATY_API FPlacementRecord
+{
+	uint32 Id = 0;
+	bool bRemoved = false;
+	FString ClassPath;
+	FTransform Transform;
+	// See UPlaceablesSubsystem::GetOwnerId, 0 when nobody owns it.
+	uint32 OwnerId = 0;
+
+	// Version is the snapshot version the record was written with.
+	void Serialize(FArchive& Ar, uint32 Version);
+	friend FArchive& operator<<(FArchive& Ar, FPlacementRecord& Record);
+};
+
+/**
+ * Background writer for placements. The game thread hands over changed records through a lock free queue, the writer
+ * thread appends them to a journal and periodically compacts everything into a snapshot.
+ * Recovery loads the snapshot and replays the journal on top, stopping at a torn last record. The writer starts from
+ * what the game thread recovered and compacts it, so every session begins with an empty journal. Files that can't be
+ * recovered are moved to a quarantine directory, and nothing is journaled while it exists.
+ */
+class MONATY_API FPlacementJournal : public FRunnable
+{
+public:
+	static constexpr uint32 SnapshotMagic = 0x4D4E5950; // "MNYP"
+	static constexpr uint32 SnapshotVersion = 2;
+
+	explicit FPlacementJournal(const FString& InDirectory);
+	virtual ~FPlacementJournal() override;
+
+	// Reads the snapshot and journal in Directory, the live placements end up in OutRecords. OutJournalValidSize gets
+	// the size of the journal up to its last intact record. False when the snapshot is unreadable or from a newer
+	// version, OutRecords is incomplete then.
+	static bool Recover(const FString& Directory, TArray<FPlacementRecord>& OutRecords,
+	                    int64* OutJournalValidSize = nullptr);
+
+	// Moves the snapshot and journal in Directory into a new directory under GetQuarantineDirectory.
+	static void Quarantine(const FString& Directory);
+	static FString GetQuarantineDirectory(const FString& Directory) { return Directory / TEXT("Quarantine"); }
+
+	// Starts the writer from the records Recover returned.
+	void Start(TArray<FPlacementRecord>&& Recovered, int64 JournalValidSize);
+	// Stops the writer after it has written everything queued so far.
+	void Shutdown();
+
+	// Game thread.
+	void Enqueue(FPlacementRecord&& Record) { Queue.Enqueue(MoveTemp(Record)); }
+	void Wake() const { WakeEvent->Trigger(); }
+
+	// Journal records written before the next compaction.
+	int32 CompactAfterRecords = 4096;
+
+	/* FRunnable */
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+protected:
+	void WriteQueuedRecords();
+	// Returns false when the snapshot couldn't be written, the journal is kept then.
+	bool Compact();
+	void OpenJournal();
+	// Cuts a torn last record off the journal, so records appended after it can be read back.
+	void TruncateJournal(int64 ValidSize);
+
+	FString SnapshotPath;
+	FString JournalPath;
+
+	TQueue<FPlacementRecord, EQueueMode::Mpsc> Queue;
+	FEvent* WakeEvent = nullptr;
+	FRunnableThread* Thread = nullptr;
+	TAtomic<bool> bStopping{false};
+
+	/* Writer thread only */
+	TMap<uint32, FPlacementRecord> LiveRecords;
+	TUniquePtr<FArchive> JournalWriter;
+	int32 JournalRecordCount = 0;
+	int64 RecoveredJournalSize = 0;
+};
@@ -0,0 +1,24 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Volume.h"
+#include "PlacementNoBuildVolume.generated.h"
+
+/**
+ * Nothing with bBlockedByNoBuildZones in its rules can be placed inside the bounds of this volume. Exists on the
+ * server and on clients alike, so the preview and the server agree.
+ */
+UCLASS()
+class MONATY_API APlacementNoBuildVolume : public AVolume
+{
+	GENERATED_BODY()
+
+public:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+protected:
+	int32 ZoneId = INDEX_NONE;
+};
@@ -0,0 +1,47 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "PlacementOwnedRegion.generated.h"
+
+/**
+ * A region owned by one player, spawned by the server and replicated to every client, so the preview checks the
+ * ownership rules against the same regions as the server.
+ */
+UCLASS()
+class MONATY_API APlacementOwnedRegion : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	APlacementOwnedRegion();
+
+	// Server only, moves the region and hands it to the owner.
+	void SetRegion(const FBox& Bounds, uint32 InOwnerId);
+
+	int32 GetZoneId() const { return ZoneId; }
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/* Properties */
+	// In world space, AInfo has no root component to place the region with.
+	UPROPERTY(EditAnywhere, ReplicatedUsing=OnRep_Region, Category="Region")
+	FBox RegionBounds = FBox(ForceInit);
+
+	// See UPlaceablesSubsystem::GetOwnerId.
+	UPROPERTY(ReplicatedUsing=OnRep_Region)
+	uint32 RegionOwnerId = 0;
+
+protected:
+	UFUNCTION()
+	void OnRep_Region();
+
+	// Replaces the zone in the placeables subsystem with the current bounds and owner.
+	void UpdateZone();
+
+	int32 ZoneId = INDEX_NONE;
+};
@@ -0,0 +1,27 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "PlacementRemovals.generated.h"
+
+/**
+ * Spawned by the server to tell every client about removed placements in batches. The clients destroy the placements
+ * themselves, so the server doesn't replicate each destruction on its own.
+ */
+UCLASS(NotPlaceable)
+class MONATY_API APlacementRemovals : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	APlacementRemovals();
+
+	// Most placements in one call, keeps a demolished base from overflowing the reliable buffer in a single bunch.
+	static constexpr int32 MaxBatchSize = 512;
+
+	// Placements a client doesn't know, or already lost, arrive as null and are skipped.
+	UFUNCTION(NetMulticast, Reliable)
+	void Multicast_RemovePlacements(const TArray<AActor*>& Placements);
+};
@@ -0,0 +1,147 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlacementRules.generated.h"
+
+UENUM(BlueprintType)
+enum class EPlacementOwnershipRule : uint8
+{
+	Anywhere,
+	// Not inside a region another player owns.
+	NotInOthersRegions,
+	// Only inside a region the placing player owns.
+	InOwnRegion
+};
+
+/**
+ * Where a placeable may go, on top of the trace and footprint. Zero turns a limit off.
+ */
+USTRUCT(BlueprintType)
+struct FPlacementRules
+{
+	GENERATED_BODY()
+
+	// Distance to the closest other placement. Snapped placements are exempt, they touch what they snap to.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Rules", meta=(ClampMin="0"))
+	float MinSpacing = 0.0f;
+
+	// Steepest surface in degrees, 90 allows any.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Rules", meta=(ClampMin="0", ClampMax="90"))
+	float MaxSurfaceAngle = 90.0f;
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Rules")
+	bool bBlockedByNoBuildZones = true;
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Rules")
+	EPlacementOwnershipRule Ownership = EPlacementOwnershipRule::NotInOthersRegions;
+
+	// How many of these one player may have placed at once.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Rules", meta=(ClampMin="0"))
+	int32 MaxPerPlayer = 0;
+};
+
+// The rules a placement can break, in the order programs check them, cheapest first.
+enum class EPlacementRule : uint8
+{
+	None,
+	PlayerCap,
+	Slope,
+	NoBuildZone,
+	OthersRegion,
+	OutsideOwnRegion,
+	Spacing,
+	Count
+};
+
+MONATY_API const TCHAR* GetPlacementRuleName(EPlacementRule Rule);
+
+/**
+ * FPlacementRules compiled into the checks that are on, with their limits in the form the checks compare against.
+ */
+struct MONATY_API FPlacementRuleProgram
+{
+	struct FOp
+	{
+		EPlacementRule Rule = EPlacementRule::None;
+		// Spacing radius, cosine of the surface angle or placement count.
+		float Limit = 0.0f;
+	};
+
+	const UClass* PlacedActorClass = nullptr;
+	TArray<FOp, TFixedAllocator<static_cast<int32>(EPlacementRule::Count)>> Ops;
+
+	static FPlacementRuleProgram Compile(const FPlacementRules& Rules, const UClass* InPlacedActorClass);
+};
+
+/**
+ * A placement to check the rules against.
+ */
+struct FPlacementCandidate
+{
+	FVector Location = FVector::ZeroVector;
+	// Up direction of the surface, or of the placement when it is tilted onto it.
+	FVector SurfaceNormal = FVector::UpVector;
+	bool bSnapped = false;
+};
+
+enum class EPlacementZoneType : uint8
+{
+	NoBuild,
+	Owned
+};
+
+struct FPlacementZone
+{
+	FBox Bounds = FBox(ForceInit);
+	EPlacementZoneType Type = EPlacementZoneType::NoBuild;
+	// Owner of an owned region, see UPlaceablesSubsystem::GetOwnerId.
+	uint32 OwnerId = 0;
+};
+
+/**
+ * No build zones and owned regions bucketed in a uniform 2D grid. A zone is listed in every cell it covers, so a
+ * lookup only tests the few zones of one cell.
+ */
+struct MONATY_API FPlacementZoneIndex
+{
+	explicit FPlacementZoneIndex(float InCellSize = 2000.0f) : CellSize(InCellSize)
+	{
+	}
+
+	// Returns the id to remove the zone with.
+	int32 Add(const FPlacementZone& Zone);
+	void Remove(int32 ZoneId);
+	int32 Num() const { return Zones.Num(); }
+
+	// Whether Predicate(Zone) holds for any zone containing Location.
+	template <typename PredicateType>
+	bool AnyAt(const FVector& Location, PredicateType&& Predicate) const;
+
+protected:
+	FIntPoint GetCell(const FVector& Location) const;
+
+	float CellSize;
+	TSparseArray<FPlacementZone> Zones;
+	TMap<FIntPoint, TArray<int32>> Cells;
+};
+
+template <typename PredicateType>
+bool FPlacementZoneIndex::AnyAt(const FVector& Location, PredicateType&& Predicate) const
+{
+	const TArray<int32>* CellZones = Cells.Find(GetCell(Location));
+	if (!CellZones)
+	{
+		return false;
+	}
+	for (const int32 ZoneId : *CellZones)
+	{
+		const FPlacementZone& Zone = Zones[ZoneId];
+		if (Zone.Bounds.IsInsideOrOn(Location) && Predicate(Zone))
+		{
+			return true;
+		}
+	}
+	return false;
+}
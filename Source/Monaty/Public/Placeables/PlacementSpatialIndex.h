@@ -0,0 +1,132 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Which placements an area operation applies to: a shape, optionally narrowed down to some owners.
+ */
+struct MONATY_API FPlacementQuery
+{
+	enum class EShape : uint8
+	{
+		Everywhere,
+		Box,
+		Sphere
+	};
+
+	EShape Shape = EShape::Everywhere;
+	FBox Box = FBox(ForceInit);
+	FVector Center = FVector::ZeroVector;
+	float Radius = 0.0f;
+	// Owner ids to match, any owner when empty.
+	TSet<uint32> Owners;
+
+	static FPlacementQuery InBox(const FBox& InBox);
+	static FPlacementQuery InSphere(const FVector& InCenter, float InRadius);
+	static FPlacementQuery OwnedBy(const TSet<uint32>& InOwners);
+
+	// Bounds the shape covers, used to pick grid cells.
+	FBox GetBounds() const;
+	bool Matches(const FVector& Location, uint32 OwnerId) const;
+};
+
+/**
+ * Every placed structure bucketed by location in a uniform 2D grid, with an index by owner, so area operations
+ * only look at the cells or owners they cover.
+ */
+struct MONATY_API FPlacementSpatialIndex
+{
+	struct FEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		FVector Location;
+		uint32 OwnerId = 0;
+		// Where the entry is listed in its cell and its owner's entries, so removing it is a swap.
+		int32 CellSlot = INDEX_NONE;
+		int32 OwnerSlot = INDEX_NONE;
+	};
+
+	explicit FPlacementSpatialIndex(float InCellSize = 1000.0f) : CellSize(InCellSize)
+	{
+	}
+
+	void Add(AActor* Actor, uint32 OwnerId);
+	void Remove(const AActor* Actor);
+
+	FEntry* Find(const AActor* Actor);
+	int32 Num() const { return Entries.Num(); }
+
+	// Whether any placement is within Radius of Location, stops at the first one.
+	bool AnyWithin(const FVector& Location, float Radius) const;
+
+	// Placements of the owner, only those of Class when given.
+	int32 CountOwned(uint32 OwnerId, const UClass* Class = nullptr) const;
+
+	// Calls Visitor(EntryIndex, Entry) for every entry matching the query.
+	template <typename VisitorType>
+	void ForEach(const FPlacementQuery& Query, VisitorType&& Visitor);
+
+protected:
+	FIntPoint GetCell(const FVector& Location) const;
+
+	float CellSize;
+	TSparseArray<FEntry> Entries;
+	TMap<FIntPoint, TArray<int32>> Cells;
+	TMap<uint32, TArray<int32>> OwnerEntries;
+	TMap<TObjectKey<AActor>, int32> ActorEntries;
+};
+
+template <typename VisitorType>
+void FPlacementSpatialIndex::ForEach(const FPlacementQuery& Query, VisitorType&& Visitor)
+{
+	const auto VisitEntries = [this, &Query, &Visitor](const TArray<int32>& EntryIndices)
+	{
+		for (const int32 EntryIndex : EntryIndices)
+		{
+			FEntry& Entry = Entries[EntryIndex];
+			if (Query.Matches(Entry.Location, Entry.OwnerId))
+			{
+				Visitor(EntryIndex, Entry);
+			}
+		}
+	};
+
+	// Owners narrow the search down the most, when given.
+	if (Query.Owners.Num() > 0)
+	{
+		for (const uint32 OwnerId : Query.Owners)
+		{
+			if (const TArray<int32>* EntryIndices = OwnerEntries.Find(OwnerId))
+			{
+				VisitEntries(*EntryIndices);
+			}
+		}
+		return;
+	}
+
+	const FBox Bounds = Query.GetBounds();
+	const FIntPoint MinCell = Bounds.IsValid ? GetCell(Bounds.Min) : FIntPoint::ZeroValue;
+	const FIntPoint MaxCell = Bounds.IsValid ? GetCell(Bounds.Max) : FIntPoint::ZeroValue;
+	const int64 CellsCovered = static_cast<int64>(MaxCell.X - MinCell.X + 1) * (MaxCell.Y - MinCell.Y + 1);
+	// Huge areas cover more cells than exist, walk the occupied ones instead.
+	if (!Bounds.IsValid || CellsCovered > Cells.Num())
+	{
+		for (const TPair<FIntPoint, TArray<int32>>& Cell : Cells)
+		{
+			VisitEntries(Cell.Value);
+		}
+		return;
+	}
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			if (const TArray<int32>* EntryIndices = Cells.Find(FIntPoint(X, Y)))
+			{
+				VisitEntries(*EntryIndices);
+			}
+		}
+	}
+}
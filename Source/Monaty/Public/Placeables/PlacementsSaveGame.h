@@ -0,0 +1,41 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/SaveGame.h"
+#include "PlacementsSaveGame.generated.h"
+
+USTRUCT(BlueprintType)
+struct FSavedPlacement
+{
+	GENERATED_BODY()
+
+	// Same class as FPlaceableData::PlacedActorClass of the placeable it was built from.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Placeable")
+	TSubclassOf<AActor> PlacedActorClass;
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="Placeable")
+	FTransform Transform;
+
+	// Id the autosave knows the placement by, 0 for a new one.
+	UPROPERTY()
+	uint32 PlacementId = 0;
+
+	// Player who built it, 0 for nobody.
+	UPROPERTY()
+	uint32 OwnerId = 0;
+};
+
+/**
+ * Every structure placed in a world.
+ */
+UCLASS()
+class MONATY_API UPlacementsSaveGame : public USaveGame
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintReadOnly, Category="Placeables")
+	TArray<FSavedPlacement> Placements;
+};
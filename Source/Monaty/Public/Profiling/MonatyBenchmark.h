@@ -0,0 +1,166 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MonatyBenchmark.generated.h"
+
+#define MONATY_WITH_BENCHMARK !UE_BUILD_SHIPPING
+
+/* Hot path scopes timed by the benchmarks */
+enum class EMonatyBenchmarkScope : uint8
+{
+	CharacterTick,
+	PhysWalking,
+	GetMaxAcceleration,
+	GetMaxBrakingDeceleration,
+	OnMovementUpdated,
+	ServerReplicateActors,
+	PlacedLogicTick,
+	Count
+};
+
+/**
+ * Per-frame cycle accumulators for the benchmark scopes. Only written while a benchmark is running.
+ */
+struct MONATY_API FMonatyBenchmarkTimers
+{
+	static bool bEnabled;
+	static uint64 FrameCycles[static_cast<int32>(EMonatyBenchmarkScope::Count)];
+
+	static const TCHAR* GetScopeName(EMonatyBenchmarkScope Scope);
+	static void ResetFrame();
+};
+
+struct FMonatyBenchmarkScopeTimer
+{
+	explicit FMonatyBenchmarkScopeTimer(EMonatyBenchmarkScope InScope)
+		: Scope(InScope), StartCycles(FMonatyBenchmarkTimers::bEnabled ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FMonatyBenchmarkScopeTimer()
+	{
+		if (StartCycles)
+		{
+			FMonatyBenchmarkTimers::FrameCycles[static_cast<int32>(Scope)] += FPlatformTime::Cycles64() - StartCycles;
+		}
+	}
+
+	EMonatyBenchmarkScope Scope;
+	uint64 StartCycles;
+};
+
+#if MONATY_WITH_BENCHMARK
+#define MONATY_BENCHMARK_SCOPE(Scope) FMonatyBenchmarkScopeTimer PREPROCESSOR_JOIN(BenchmarkScope, __LINE__)(EMonatyBenchmarkScope::Scope)
+#else
+#define MONATY_BENCHMARK_SCOPE(Scope)
+#endif
+
+/**
+ * A named series of samples, reported as percentiles.
+ */
+struct MONATY_API FMonatyBenchmarkSeries
+{
+	FString Name;
+	TArray<double> Samples;
+
+	double GetPercentile(double Percentile) const;
+	double GetMean() const;
+};
+
+/**
+ * A set of series written out as one CSV row per series.
+ */
+struct MONATY_API FMonatyBenchmarkReport
+{
+	FString Name;
+	TArray<FMonatyBenchmarkSeries> Series;
+
+	FMonatyBenchmarkSeries& AddSeries(const FString& SeriesName);
+
+	// Writes the report to Saved/Profiling/Monaty and logs a summary.
+	bool SaveCsv() const;
+};
+
+/**
+ * Spawns batches of characters with scripted input and measures the locomotion hot path per frame.
+ * Runs as the Monaty.Perf.Locomotion automation test, headless with:
+ * -server -nullrhi -benchmark -ExecCmds="Automation RunTests Monaty.Perf.Locomotion; Quit"
+ * Monaty.Bench.Locomotion 1 64 512 runs the same from the console.
+ * With proxies the characters are simulated proxies fed scripted movement updates instead, run it on a client to
+ * measure the client frame time: Monaty.Bench.Locomotion 200 proxies [lightweight]
+ */
+UCLASS()
+class MONATY_API UMonatyLocomotionBenchmark : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// The lightweight setting only applies until the benchmark is done, its console variable is restored.
+	void StartBenchmark(const TArray<int32>& InCharacterCounts, int32 InMeasuredFrames, bool bInExitWhenDone,
+	                    bool bInSimulatedProxies = false, bool bLightweightProxies = false);
+
+	bool IsRunning() const { return CharacterCounts.IsValidIndex(CurrentRunIndex); }
+	// One report per character count run since the last StartBenchmark, each is saved as CSV too.
+	const TArray<FMonatyBenchmarkReport>& GetCompletedReports() const { return CompletedReports; }
+
+	/* Fixed step determinism, see MonatyLocomotionTests.cpp */
+	// Four seconds of input at 60Hz with stops, turns, gait changes and a jump.
+	static struct FMonatyInputRecording MakeVerificationRecording();
+
+	// Replays Recording through the movement component at the fixed step rate and records the locomotion input of
+	// every step.
+	bool RecordFixedStepInputs(const FMonatyInputRecording& Recording, float StepRate,
+	                           TArray<struct FLocomotionStepInput>& OutStepInputs);
+
+	// Runs fixed step locomotion on StepInputs at FrameRate until they are used up, without the movement component.
+	// Returns the number of steps run, INDEX_NONE when no character could be spawned.
+	int32 RunFixedStepInputs(const TArray<FLocomotionStepInput>& StepInputs, float StepRate, int32 FrameRate,
+	                         FQuat& OutRotation, struct FMonatyLocomotionState& OutLocomotion);
+
+	// Fixed movement model, so runs stay comparable across commits regardless of content changes.
+	class UDataTable* GetMovementModelTable();
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return IsRunning(); }
+	virtual TStatId GetStatId() const override;
+
+	/* Properties */
+	UPROPERTY(Transient)
+	TArray<class AMonatyCharacter*> SpawnedCharacters;
+
+	// Where each spawned character started, the simulated proxies circle around it.
+	TArray<FVector> SpawnLocations;
+
+	UPROPERTY(Transient)
+	class UDataTable* MovementModelTable = nullptr;
+
+	int32 WarmupFrames = 60;
+	int32 MeasuredFrames = 300;
+
+protected:
+	class AMonatyCharacter* SpawnBenchmarkCharacter(const FTransform& SpawnTransform);
+	FVector GetSpawnOrigin() const;
+	void StartRun();
+	void FinishRun();
+	void ApplyScriptedInput();
+	void ApplyScriptedNetUpdates();
+	void OverrideConsoleVariable(const TCHAR* Name, bool bValue);
+	void RestoreConsoleVariables();
+
+	TArray<int32> CharacterCounts;
+	int32 CurrentRunIndex = INDEX_NONE;
+	int32 FrameIndex = 0;
+	double LastFrameTime = 0.0;
+	bool bExitWhenDone = false;
+	bool bSimulatedProxies = false;
+	// Frames between scripted movement updates of the simulated proxies, about 20Hz at 60 fps.
+	int32 NetUpdateFrames = 3;
+	FMonatyBenchmarkReport Report;
+	TArray<FMonatyBenchmarkReport> CompletedReports;
+	// Values of the console variables the benchmark changed, from before it did.
+	TMap<FString, FString> SavedConsoleVariables;
+};
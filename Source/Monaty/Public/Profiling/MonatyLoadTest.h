@@ -0,0 +1,58 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "Profiling/MonatyBenchmark.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MonatyLoadTest.generated.h"
+
+/**
+ * Networked load test. On a client started with -MonatyBot=<Index> it drives the local character through the input
+ * handlers. On the server, Monaty.LoadTest.Server waits for the bots and records frame time, bandwidth per client and
+ * movement corrections. Scripts/RunLoadTest.sh starts a null RHI server and the bots on one machine.
+ */
+UCLASS()
+class MONATY_API UMonatyLoadTestSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	void StartServerMeasurement(int32 InExpectedBots, float InDurationSeconds, bool bInExitWhenDone);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return BotIndex != INDEX_NONE || bMeasuring || bWaitingForBots; }
+	virtual TStatId GetStatId() const override;
+
+	/* Properties */
+	// Placeable the bots build, read from -BotPlaceable=<DataTablePath>:<Row>.
+	FDataTableRowHandle BotPlaceable;
+
+	// Seconds to wait for the expected bots before measuring with whoever is connected.
+	float ConnectTimeout = 120.0f;
+
+protected:
+	void TickBot(float DeltaTime);
+	void TickServer(float DeltaTime);
+	void SampleServerSecond();
+	void FinishServerMeasurement();
+	int32 GetTotalCorrections() const;
+
+	/* Bot */
+	int32 BotIndex = INDEX_NONE;
+	int32 BotFrame = 0;
+
+	/* Server */
+	bool bWaitingForBots = false;
+	bool bMeasuring = false;
+	bool bExitWhenDone = false;
+	int32 ExpectedBots = 0;
+	float DurationSeconds = 60.0f;
+	double PhaseStartTime = 0.0;
+	double LastSampleTime = 0.0;
+	int32 LastCorrections = 0;
+	FMonatyBenchmarkReport Report;
+};
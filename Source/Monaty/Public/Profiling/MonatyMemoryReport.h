@@ -0,0 +1,20 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Profiling/MonatyBenchmark.h"
+
+/**
+ * Memory each character takes, by component and by field group of AMonatyCharacter. Every group is a series with
+ * one sample per character, in bytes.
+ */
+struct MONATY_API FMonatyCharacterMemoryReport
+{
+	// Adds every character in World to the report. Returns how many there were.
+	static int32 Gather(UWorld* World, FMonatyBenchmarkReport& OutReport);
+
+	// Logs the mean bytes per character of every group, and what that comes to for ProjectedCount characters.
+	static void Print(const FMonatyBenchmarkReport& Report, int32 CharacterCount, int32 ProjectedCount,
+	                  FOutputDevice& Ar);
+};
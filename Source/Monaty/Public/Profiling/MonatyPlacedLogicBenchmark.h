@@ -0,0 +1,80 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Placeables/PlacedActor.h"
+#include "Profiling/MonatyBenchmark.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MonatyPlacedLogicBenchmark.generated.h"
+
+/**
+ * Placed actor with a little logic, ticked in batches by the placed logic manager.
+ */
+UCLASS(NotBlueprintable, Transient)
+class MONATY_API APlacedLogicBenchmarkActor : public APlacedActor
+{
+	GENERATED_BODY()
+
+public:
+	APlacedLogicBenchmarkActor();
+
+	virtual void TickPlacedLogic(float DeltaTime) override;
+
+	// Stand in for a door opening or a generator filling up.
+	float Progress = 0.0f;
+};
+
+/**
+ * The same logic with its own tick function, the way placed actors would tick without the manager.
+ */
+UCLASS(NotBlueprintable, Transient)
+class MONATY_API APlacedTickBenchmarkActor : public APlacedActor
+{
+	GENERATED_BODY()
+
+public:
+	APlacedTickBenchmarkActor();
+
+	virtual void Tick(float DeltaTime) override;
+
+	float Progress = 0.0f;
+};
+
+/**
+ * Measures frame time with no placed logic, with it batched by the manager and with a tick per actor.
+ * Run with: -server -nullrhi -benchmark -ExecCmds="Monaty.Bench.PlacedLogic 10000"
+ */
+UCLASS()
+class MONATY_API UMonatyPlacedLogicBenchmark : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void StartBenchmark(int32 InActorCount, int32 InMeasuredFrames, bool bInExitWhenDone);
+
+	bool IsRunning() const { return PhaseIndex != INDEX_NONE; }
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return IsRunning(); }
+	virtual TStatId GetStatId() const override;
+
+	UPROPERTY(Transient)
+	TArray<APlacedActor*> SpawnedActors;
+
+	int32 WarmupFrames = 60;
+	int32 MeasuredFrames = 600;
+
+protected:
+	void StartPhase();
+	void FinishPhase();
+	void ClearActors();
+
+	// Baseline, batched, per actor tick.
+	static constexpr int32 NumPhases = 3;
+	int32 PhaseIndex = INDEX_NONE;
+	int32 FrameIndex = 0;
+	int32 ActorCount = 0;
+	bool bExitWhenDone = false;
+	FMonatyBenchmarkReport Report;
+};
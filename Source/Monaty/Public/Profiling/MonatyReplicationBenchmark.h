@@ -0,0 +1,46 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Profiling/MonatyBenchmark.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MonatyReplicationBenchmark.generated.h"
+
+/**
+ * Fills a listen or dedicated server with placed structures and measures the per frame replication cost with
+ * whatever clients are connected.
+ * Run with: -server -nullrhi -ExecCmds="monaty.Net.Stats 0, Monaty.Bench.Replication 20000", then connect the clients.
+ * The net stats are on by default in development builds and would add their own cost to the measurement.
+ */
+UCLASS()
+class MONATY_API UMonatyReplicationBenchmark : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void StartBenchmark(int32 PlacementCount, int32 InMeasuredFrames, bool bInExitWhenDone);
+
+	bool IsRunning() const { return FrameIndex != INDEX_NONE; }
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return IsRunning(); }
+	virtual TStatId GetStatId() const override;
+
+	/* Properties */
+	UPROPERTY(Transient)
+	TArray<class APlacedActor*> SpawnedPlacements;
+
+	int32 WarmupFrames = 120;
+	int32 MeasuredFrames = 600;
+	// Every this many frames a small share of the placements is changed, to include dormancy wake ups.
+	int32 ChangeInterval = 30;
+	float ChangeFraction = 0.01f;
+
+protected:
+	void FinishBenchmark();
+
+	int32 FrameIndex = INDEX_NONE;
+	bool bExitWhenDone = false;
+	FMonatyBenchmarkReport Report;
+};
@@ -0,0 +1,88 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+// Compiled out together with the engine stats, so shipping builds pay nothing for the Monaty scopes and counters.
+#define MONATY_WITH_STATS (STATS || CPUPROFILERTRACE_ENABLED)
+
+DECLARE_STATS_GROUP(TEXT("Monaty"), STATGROUP_Monaty, STATCAT_Advanced);
+
+/* Scopes */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Character Tick"), STAT_MonatyCharacterTick, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Lightweight Proxy Tick"), STAT_MonatyLightweightProxyTick, STATGROUP_Monaty,
+                          MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Set Essential Values"), STAT_MonatySetEssentialValues, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Grounded Rotation"), STAT_MonatyUpdateGroundedRotation, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Phys Walking"), STAT_MonatyPhysWalking, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Placeables Tick"), STAT_MonatyPlaceablesTick, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Placeables Trace"), STAT_MonatyPlaceablesTrace, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Placeables Materials"), STAT_MonatyPlaceablesMaterials, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Replicate Actors"), STAT_MonatyReplicateActors, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Placements Autosave"), STAT_MonatyAutosave, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Lag Compensation Record"), STAT_MonatyLagCompRecord, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Lag Compensation Query"), STAT_MonatyLagCompQuery, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Placed Logic Tick"), STAT_MonatyPlacedLogicTick, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Placements Area Query"), STAT_MonatyPlacementQuery, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Placements Demolish"), STAT_MonatyDemolish, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Placements Generate"), STAT_MonatyPlacementGenerate, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Placement Rules"), STAT_MonatyPlacementRules, STATGROUP_Monaty, MONATY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Landing Prediction"), STAT_MonatyLandingPrediction, STATGROUP_Monaty,
+                          MONATY_API);
+
+/* Counters */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Curve Evaluations"), STAT_MonatyCurveEvaluations, STATGROUP_Monaty, MONATY_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Traces"), STAT_MonatyTraces, STATGROUP_Monaty, MONATY_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Material Changes"), STAT_MonatyMaterialChanges, STATGROUP_Monaty, MONATY_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Spawns"), STAT_MonatySpawns, STATGROUP_Monaty, MONATY_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Client Corrections"), STAT_MonatyCorrections, STATGROUP_Monaty, MONATY_API);
+
+#if CPUPROFILERTRACE_ENABLED
+UE_TRACE_CHANNEL_EXTERN(MonatyChannel, MONATY_API);
+#endif
+
+/* Counters mirrored into the rolling CSV */
+enum class EMonatyStatCounter : uint8
+{
+	CurveEvaluations,
+	Traces,
+	MaterialChanges,
+	Spawns,
+	Corrections,
+	Count
+};
+
+/**
+ * Keeps the last frames of Monaty counters so they can be dumped to CSV with Monaty.Stats.DumpCsv.
+ */
+struct MONATY_API FMonatyStatsHistory
+{
+	static constexpr int32 MaxFrames = 600;
+
+	static uint32 FrameCounters[static_cast<int32>(EMonatyStatCounter::Count)];
+
+	static void Increment(EMonatyStatCounter Counter, uint32 Amount = 1)
+	{
+		FrameCounters[static_cast<int32>(Counter)] += Amount;
+	}
+
+	// Moves the current frame counters into the history, called once per frame.
+	static void EndFrame();
+	static bool DumpCsv(const FString& FilePath);
+};
+
+#if MONATY_WITH_STATS
+#define MONATY_SCOPED_STAT(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, MonatyChannel)
+#define MONATY_INC_COUNTER(Stat, Counter, Amount) \
+	INC_DWORD_STAT_BY(Stat, Amount); \
+	FMonatyStatsHistory::Increment(EMonatyStatCounter::Counter, Amount)
+#else
+#define MONATY_SCOPED_STAT(Stat)
+#define MONATY_INC_COUNTER(Stat, Counter, Amount)
+#endif
@@ -0,0 +1,136 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+
+enum class EMonatyTelemetryType : uint8
+{
+	// State: gait, stance, movement state. Values: speed, movement input amount, yaw.
+	Locomotion,
+	// State: accepted, snapped, rejection reason. Values: location and yaw.
+	Placement
+};
+
+/**
+ * One telemetry record, written to disk as is. 32 bytes, so a ring of them stays in a few cache lines per push.
+ */
+struct FMonatyTelemetryRecord
+{
+	uint32 Frame = 0;
+	// Which object the record is about, the unique id of the actor.
+	uint32 Source = 0;
+	float Time = 0.0f;
+	EMonatyTelemetryType Type = EMonatyTelemetryType::Locomotion;
+	uint8 State[3] = {};
+	float Values[4] = {};
+};
+static_assert(sizeof(FMonatyTelemetryRecord) == 32, "Telemetry records are written to disk as is.");
+
+/**
+ * Records pushed by one thread. Single producer, and the writer thread is the single consumer.
+ */
+struct alignas(PLATFORM_CACHE_LINE_SIZE) FMonatyTelemetryRing
+{
+	static constexpr uint32 Capacity = 8192;
+	// Records waiting when a push wakes the writer, instead of leaving them for its next periodic drain.
+	static constexpr uint32 WakeThreshold = Capacity / 2;
+
+	bool Push(const FMonatyTelemetryRecord& Record)
+	{
+		const uint32 CurrentHead = Head.load(std::memory_order_relaxed);
+		if (CurrentHead - Tail.load(std::memory_order_acquire) >= Capacity)
+		{
+			Dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		Records[CurrentHead % Capacity] = Record;
+		Head.store(CurrentHead + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Producer. Records pushed and not drained yet.
+	uint32 Num() const { return Head.load(std::memory_order_relaxed) - Tail.load(std::memory_order_acquire); }
+
+	// Writer thread. Appends everything pushed so far to Out.
+	int32 Drain(TArray<uint8>& Out);
+
+	// Producer and consumer indices on their own cache lines.
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Head{0};
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Tail{0};
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> Dropped{0};
+	FMonatyTelemetryRecord Records[Capacity];
+};
+
+/**
+ * Streams telemetry records to rotating compressed files under Saved/Telemetry.
+ * Each thread pushes into its own ring, so pushing is a few stores and never takes a lock after the first push.
+ * Files are a header followed by blocks of [uncompressed size][compressed size][zlib compressed records].
+ */
+class MONATY_API FMonatyTelemetry : public FRunnable
+{
+public:
+	static constexpr uint32 FileMagic = 0x4D4E5954; // "MNYT"
+	static constexpr uint32 FileVersion = 1;
+
+	static FMonatyTelemetry& Get();
+
+	static bool IsEnabled() { return bEnabled.load(std::memory_order_relaxed); }
+
+	// Any thread. Does nothing while telemetry is off.
+	static void Push(const FMonatyTelemetryRecord& Record)
+	{
+		if (!bEnabled.load(std::memory_order_acquire))
+		{
+			return;
+		}
+		FMonatyTelemetryRing& Ring = GetThreadRing();
+		// Only the push that reaches the threshold wakes the writer, once per fill of the ring.
+		if (Ring.Push(Record) && Ring.Num() == FMonatyTelemetryRing::WakeThreshold)
+		{
+			Get().WakeEvent->Trigger();
+		}
+	}
+
+	void Start();
+	// Writes out everything pushed so far and closes the file.
+	void Shutdown();
+
+	uint32 GetDroppedCount() const;
+	uint64 GetWrittenRecordCount() const { return WrittenRecords; }
+
+	// Reads every record of a telemetry file. Stops at the first damaged block.
+	static bool ReadFile(const FString& FilePath, TArray<FMonatyTelemetryRecord>& OutRecords);
+
+	/* FRunnable */
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+protected:
+	static FMonatyTelemetryRing& GetThreadRing();
+
+	void DrainRings();
+	void WriteBlock();
+	void OpenFile();
+	void DeleteOldFiles() const;
+
+	// Set after the writer and its wake event exist, read by every push.
+	static std::atomic<bool> bEnabled;
+
+	FCriticalSection RingsLock;
+	TArray<FMonatyTelemetryRing*> Rings;
+
+	/* Writer thread only */
+	FString Directory;
+	TUniquePtr<FArchive> Writer;
+	int32 FileIndex = 0;
+	TArray<uint8> Pending;
+	TArray<uint8> Compressed;
+	TAtomic<uint64> WrittenRecords{0};
+
+	// Taken once and kept, a push may still trigger it while telemetry is shut down.
+	FEvent* WakeEvent = nullptr;
+	FRunnableThread* Thread = nullptr;
+	TAtomic<bool> bStopping{false};
+};
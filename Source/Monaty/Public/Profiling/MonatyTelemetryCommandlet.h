@@ -0,0 +1,20 @@
+// Copyright Conkis Studios, all rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MonatyTelemetryCommandlet.generated.h"
+
+/**
+ * Reads telemetry files offline and summarizes them, optionally converting them to CSV.
+ * Usage: UnrealEditor-Cmd Monaty -run=MonatyTelemetry -File=<Saved/Telemetry/...mtl | directory> [-Csv=<File>]
+ */
+UCLASS()
+class MONATY_API UMonatyTelemetryCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	virtual int32 Main(const FString& Params) override;
+};